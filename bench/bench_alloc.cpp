@@ -0,0 +1,87 @@
+#include <benchmark/benchmark.h>
+#include "alloc_tracker.h"
+#include <pmt_converter/pmt_converter.h>
+#include <pmt_converter/pmt_legacy_codec.h>
+#include <pmt_converter/pmt_legacy_framed.h>
+#include <complex>
+#include <vector>
+
+// Time and heap activity per call of the codec entry points, by message type.
+// Reports allocs/call and bytes/call counters next to the timings; budgets
+// are enforced by tests/qa_alloc_budget.
+
+namespace {
+
+    enum message_kind { scalar, symbol, tag_dict, c32_burst };
+
+    pmtv::pmt make_message(int64_t kind) {
+        switch (kind) {
+            case scalar:
+                return static_cast<int64_t>(1) << 40;
+            case symbol:
+                return "a_symbol_too_long_for_small_string_storage";
+            case tag_dict:
+                return pmtv::map_t({{"rx_time", static_cast<int64_t>(249387429783478)},
+                                    {"rx_rate", static_cast<int64_t>(2400000)},
+                                    {"label", "burst_start"}});
+            default:
+                return pmtv::Tensor<std::complex<float>>(4096, {0.5f, -0.5f});
+        }
+    }
+
+    template <typename Fn>
+    void run_counted(benchmark::State& state, Fn&& fn) {
+        fn();
+        alloc_tracker::scope s;
+        for (auto _ : state)
+            fn();
+        auto c = s.heap();
+        double n = static_cast<double>(state.iterations());
+        state.counters["allocs/call"] = static_cast<double>(c.allocations) / n;
+        state.counters["bytes/call"] = static_cast<double>(c.bytes) / n;
+    }
+
+    void BM_SerializeVector(benchmark::State& state) {
+        pmtv::pmt obj = make_message(state.range(0));
+        run_counted(state, [&] { benchmark::DoNotOptimize(legacy_pmt::serialize_to_legacy(obj)); });
+    }
+
+    void BM_SerializeInto(benchmark::State& state) {
+        pmtv::pmt obj = make_message(state.range(0));
+        std::vector<uint8_t> buf(legacy_pmt::legacy_serialized_size(obj));
+        run_counted(state, [&] { benchmark::DoNotOptimize(legacy_pmt::serialize_to_legacy(obj, buf.data(), buf.size())); });
+    }
+
+    void BM_SerializeFramedInto(benchmark::State& state) {
+        pmtv::pmt obj = make_message(state.range(0));
+        std::vector<uint8_t> buf(legacy_pmt::framed_size(obj));
+        run_counted(state, [&] { benchmark::DoNotOptimize(legacy_pmt::serialize_framed(obj, buf.data(), buf.size())); });
+    }
+
+    void BM_Deserialize(benchmark::State& state) {
+        auto bytes = legacy_pmt::serialize_to_legacy(make_message(state.range(0)));
+        run_counted(state,
+                    [&] { benchmark::DoNotOptimize(legacy_pmt::deserialize_from_legacy(bytes.data(), bytes.size())); });
+    }
+
+    // The gr_compat converters have no uniform vector support, so bursts are left out
+    void BM_ToLegacyPmt(benchmark::State& state) {
+        pmtv::pmt obj = make_message(state.range(0));
+        run_counted(state, [&] { benchmark::DoNotOptimize(gr_compat::to_legacy_pmt(obj)); });
+    }
+
+    void BM_ToNewPmt(benchmark::State& state) {
+        auto legacy = gr_compat::to_legacy_pmt(make_message(state.range(0)));
+        run_counted(state, [&] { benchmark::DoNotOptimize(gr_compat::to_new_pmt(legacy)); });
+    }
+
+}
+
+BENCHMARK(BM_SerializeVector)->DenseRange(scalar, c32_burst);
+BENCHMARK(BM_SerializeInto)->DenseRange(scalar, c32_burst);
+BENCHMARK(BM_SerializeFramedInto)->DenseRange(scalar, c32_burst);
+BENCHMARK(BM_Deserialize)->DenseRange(scalar, c32_burst);
+BENCHMARK(BM_ToLegacyPmt)->DenseRange(scalar, tag_dict);
+BENCHMARK(BM_ToNewPmt)->DenseRange(scalar, tag_dict);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,94 @@
+#include <benchmark/benchmark.h>
+#include <pmt_converter/pmt_legacy_codec.h>
+#include <pmt_converter/pmt_legacy_framed.h>
+#include <complex>
+#include <cstdint>
+#include <vector>
+
+// Single-threaded codec throughput, the set of numbers the perf_check target
+// compares against bench/baseline/bench_codec.json. Keep names stable: a
+// renamed benchmark shows up as missing from the baseline.
+
+namespace {
+
+    struct single_threaded {
+        single_threaded() { legacy_pmt::set_parallel_options({.max_threads = 1}); }
+    };
+    const single_threaded force_single_threaded;
+
+    pmtv::pmt make_tag_dict() {
+        return pmtv::map_t({{"rx_time", static_cast<int64_t>(249387429783478)},
+                            {"rx_rate", 2.4e6},
+                            {"rx_freq", 915e6},
+                            {"label", "burst_start"}});
+    }
+
+    template <typename T>
+    pmtv::pmt make_burst(size_t bytes) {
+        std::vector<T> v(bytes / sizeof(T));
+        for (size_t i = 0; i < v.size(); ++i) {
+            if constexpr (std::is_same_v<T, std::complex<float>>)
+                v[i] = {static_cast<float>(i % 1021), -static_cast<float>(i % 509)};
+            else
+                v[i] = static_cast<T>(i * 2654435761u);
+        }
+        return pmtv::Tensor<T>(std::move(v));
+    }
+
+    void encode(benchmark::State& state, const pmtv::pmt& obj) {
+        std::vector<uint8_t> out(legacy_pmt::legacy_serialized_size(obj));
+        for (auto _ : state)
+            benchmark::DoNotOptimize(legacy_pmt::serialize_to_legacy(obj, out.data(), out.size()));
+        state.SetBytesProcessed(state.iterations() * out.size());
+    }
+
+    void decode(benchmark::State& state, const pmtv::pmt& obj) {
+        auto bytes = legacy_pmt::serialize_to_legacy(obj);
+        for (auto _ : state)
+            benchmark::DoNotOptimize(legacy_pmt::deserialize_from_legacy(bytes.data(), bytes.size()));
+        state.SetBytesProcessed(state.iterations() * bytes.size());
+    }
+
+    void BM_EncodeTagDict(benchmark::State& state) { encode(state, make_tag_dict()); }
+    void BM_DecodeTagDict(benchmark::State& state) { decode(state, make_tag_dict()); }
+
+    template <typename T>
+    void BM_EncodeBurst(benchmark::State& state) { encode(state, make_burst<T>(state.range(0))); }
+
+    template <typename T>
+    void BM_DecodeBurst(benchmark::State& state) { decode(state, make_burst<T>(state.range(0))); }
+
+    void BM_SplitCapture(benchmark::State& state) {
+        std::vector<uint8_t> capture;
+        for (int i = 0; i < 256; ++i) {
+            auto msg = legacy_pmt::serialize_to_legacy(i % 4 ? make_tag_dict() : make_burst<float>(4096));
+            capture.insert(capture.end(), msg.begin(), msg.end());
+        }
+        for (auto _ : state) {
+            for (size_t pos = 0; pos < capture.size();)
+                pos += legacy_pmt::legacy_encoded_size(capture.data() + pos, capture.size() - pos);
+        }
+        state.SetBytesProcessed(state.iterations() * capture.size());
+    }
+
+    void BM_DecodeFramedBurst(benchmark::State& state) {
+        auto frame = legacy_pmt::serialize_framed(make_burst<std::complex<float>>(state.range(0)));
+        for (auto _ : state)
+            benchmark::DoNotOptimize(legacy_pmt::deserialize_framed(frame.data(), frame.size()));
+        state.SetBytesProcessed(state.iterations() * frame.size());
+    }
+
+}
+
+BENCHMARK(BM_EncodeTagDict);
+BENCHMARK(BM_DecodeTagDict);
+BENCHMARK(BM_EncodeBurst<std::complex<float>>)->Arg(64 << 10)->Arg(4 << 20);
+BENCHMARK(BM_DecodeBurst<std::complex<float>>)->Arg(64 << 10)->Arg(4 << 20);
+BENCHMARK(BM_EncodeBurst<float>)->Arg(64 << 10);
+BENCHMARK(BM_DecodeBurst<float>)->Arg(64 << 10);
+BENCHMARK(BM_EncodeBurst<int16_t>)->Arg(64 << 10);
+BENCHMARK(BM_DecodeBurst<int16_t>)->Arg(64 << 10);
+BENCHMARK(BM_SplitCapture);
+BENCHMARK(BM_DecodeFramedBurst)->Arg(64 << 10);
+
+BENCHMARK_MAIN();
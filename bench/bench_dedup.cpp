@@ -0,0 +1,72 @@
+#include <benchmark/benchmark.h>
+#include <pmt_converter/pmt_legacy_codec.h>
+#include <pmt_converter/pmt_legacy_dedup.h>
+#include <string>
+#include <vector>
+
+// Deduplicated encoding against plain legacy for a per-channel dict that
+// repeats one calibration subtree. Argument: number of channels.
+
+namespace {
+
+    pmtv::pmt make_channels(size_t n) {
+        pmtv::map_t calibration({{"gain_db", 31.5},
+                                 {"dc_offset", pmtv::Tensor<float>(256, 0.125f)},
+                                 {"label", "factory_calibration"}});
+        pmtv::map_t m;
+        for (size_t i = 0; i < n; ++i)
+            m.insert_or_assign("ch" + std::to_string(i),
+                               pmtv::map_t({{"index", static_cast<int32_t>(i)}, {"calibration", calibration}}));
+        return m;
+    }
+
+    void BM_EncodePlain(benchmark::State& state) {
+        pmtv::pmt obj = make_channels(state.range(0));
+        size_t size = 0;
+        for (auto _ : state) {
+            auto bytes = legacy_pmt::serialize_to_legacy(obj);
+            size = bytes.size();
+            benchmark::DoNotOptimize(bytes.data());
+        }
+        state.counters["wire_bytes"] = static_cast<double>(size);
+    }
+
+    void BM_EncodeDedup(benchmark::State& state) {
+        pmtv::pmt obj = make_channels(state.range(0));
+        size_t size = 0;
+        for (auto _ : state) {
+            auto bytes = legacy_pmt::serialize_deduplicated(obj);
+            size = bytes.size();
+            benchmark::DoNotOptimize(bytes.data());
+        }
+        state.counters["wire_bytes"] = static_cast<double>(size);
+    }
+
+    void BM_DecodePlain(benchmark::State& state) {
+        auto bytes = legacy_pmt::serialize_to_legacy(make_channels(state.range(0)));
+        for (auto _ : state)
+            benchmark::DoNotOptimize(legacy_pmt::deserialize_from_legacy(bytes.data(), bytes.size()));
+    }
+
+    void BM_DecodeDedup(benchmark::State& state) {
+        auto bytes = legacy_pmt::serialize_deduplicated(make_channels(state.range(0)));
+        for (auto _ : state)
+            benchmark::DoNotOptimize(legacy_pmt::deserialize_deduplicated(bytes.data(), bytes.size()));
+    }
+
+    // Forwarding to a GR3 peer
+    void BM_Expand(benchmark::State& state) {
+        auto bytes = legacy_pmt::serialize_deduplicated(make_channels(state.range(0)));
+        for (auto _ : state)
+            benchmark::DoNotOptimize(legacy_pmt::expand_deduplicated(bytes.data(), bytes.size()));
+    }
+
+}
+
+BENCHMARK(BM_EncodePlain)->RangeMultiplier(4)->Range(4, 256);
+BENCHMARK(BM_EncodeDedup)->RangeMultiplier(4)->Range(4, 256);
+BENCHMARK(BM_DecodePlain)->RangeMultiplier(4)->Range(4, 256);
+BENCHMARK(BM_DecodeDedup)->RangeMultiplier(4)->Range(4, 256);
+BENCHMARK(BM_Expand)->RangeMultiplier(4)->Range(4, 256);
+
+BENCHMARK_MAIN();
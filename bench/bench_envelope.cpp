@@ -0,0 +1,86 @@
+#include <benchmark/benchmark.h>
+#include <pmt_converter/pmt_legacy_codec.h>
+#include <pmt_converter/pmt_legacy_envelope.h>
+#include <cmath>
+#include <complex>
+#include <random>
+#include <vector>
+
+// Compression ratio and throughput of the legacy PMT envelope.
+// Arguments: codec, shuffle (0/1), zstd level. Payloads are 1 MiB noisy tones.
+
+namespace {
+
+    constexpr size_t payload_bytes = 1024 * 1024;
+
+    template <typename T>
+    pmtv::pmt make_signal() {
+        std::mt19937 rng(1234);
+        std::normal_distribution<float> noise(0.0f, 0.05f);
+        std::vector<T> samples(payload_bytes / sizeof(T));
+        for (size_t i = 0; i < samples.size(); ++i) {
+            float phase = 0.01f * static_cast<float>(i);
+            if constexpr (std::is_same_v<T, float>)
+                samples[i] = std::cos(phase) + noise(rng);
+            else
+                samples[i] = {std::cos(phase) + noise(rng), std::sin(phase) + noise(rng)};
+        }
+        return pmtv::Tensor<T>(samples);
+    }
+
+    legacy_pmt::envelope_options options(benchmark::State& state) {
+        return {.codec = static_cast<legacy_pmt::envelope_codec>(state.range(0)),
+                .level = static_cast<int>(state.range(2)),
+                .shuffle = state.range(1) != 0};
+    }
+
+    template <typename T>
+    void BM_Wrap(benchmark::State& state) {
+        auto opts = options(state);
+        if (!legacy_pmt::envelope_codec_available(opts.codec)) {
+            state.SkipWithError("codec not available");
+            return;
+        }
+        auto legacy = legacy_pmt::serialize_to_legacy(make_signal<T>());
+        size_t wrapped = 0;
+        for (auto _ : state) {
+            auto env = legacy_pmt::wrap_envelope(legacy.data(), legacy.size(), opts);
+            wrapped = env.size();
+            benchmark::DoNotOptimize(env.data());
+        }
+        state.SetBytesProcessed(state.iterations() * legacy.size());
+        state.counters["ratio"] = static_cast<double>(legacy.size()) / static_cast<double>(wrapped);
+    }
+
+    template <typename T>
+    void BM_Unwrap(benchmark::State& state) {
+        auto opts = options(state);
+        if (!legacy_pmt::envelope_codec_available(opts.codec)) {
+            state.SkipWithError("codec not available");
+            return;
+        }
+        auto legacy = legacy_pmt::serialize_to_legacy(make_signal<T>());
+        auto env = legacy_pmt::wrap_envelope(legacy.data(), legacy.size(), opts);
+        for (auto _ : state) {
+            benchmark::DoNotOptimize(legacy_pmt::deserialize_from_envelope(env.data(), env.size()));
+        }
+        state.SetBytesProcessed(state.iterations() * legacy.size());
+        state.counters["ratio"] = static_cast<double>(legacy.size()) / static_cast<double>(env.size());
+    }
+
+    void envelope_args(benchmark::internal::Benchmark* b) {
+        b->ArgNames({"codec", "shuffle", "level"});
+        b->Args({0, 1, 0});
+        for (int64_t shuffle : {0, 1})
+            for (int64_t level : {1, 3})
+                b->Args({1, shuffle, level});
+    }
+
+}
+
+BENCHMARK(BM_Wrap<float>)->Apply(envelope_args);
+BENCHMARK(BM_Wrap<std::complex<float>>)->Apply(envelope_args);
+BENCHMARK(BM_Unwrap<float>)->Apply(envelope_args);
+BENCHMARK(BM_Unwrap<std::complex<float>>)->Apply(envelope_args);
+
+BENCHMARK_MAIN();
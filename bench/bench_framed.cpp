@@ -0,0 +1,67 @@
+#include <benchmark/benchmark.h>
+#include <pmt_converter/pmt_legacy_codec.h>
+#include <pmt_converter/pmt_legacy_framed.h>
+#include <complex>
+#include <vector>
+
+// Cost of the CRC32C framed mode relative to the plain codec, per dtype and
+// payload size. Argument: payload size in bytes.
+
+namespace {
+
+    template <typename T>
+    pmtv::pmt make_vector(size_t bytes) {
+        std::vector<T> samples(bytes / sizeof(T));
+        for (size_t i = 0; i < samples.size(); ++i)
+            samples[i] = static_cast<T>(static_cast<typename std::conditional_t<std::is_arithmetic_v<T>, T, float>>(i % 251));
+        return pmtv::Tensor<T>(samples);
+    }
+
+    template <typename T>
+    void BM_Encode(benchmark::State& state) {
+        pmtv::pmt obj = make_vector<T>(state.range(0));
+        std::vector<uint8_t> out(legacy_pmt::framed_size(obj));
+        for (auto _ : state)
+            benchmark::DoNotOptimize(legacy_pmt::serialize_to_legacy(obj, out.data(), out.size()));
+        state.SetBytesProcessed(state.iterations() * state.range(0));
+    }
+
+    template <typename T>
+    void BM_EncodeFramed(benchmark::State& state) {
+        pmtv::pmt obj = make_vector<T>(state.range(0));
+        std::vector<uint8_t> out(legacy_pmt::framed_size(obj));
+        for (auto _ : state)
+            benchmark::DoNotOptimize(legacy_pmt::serialize_framed(obj, out.data(), out.size()));
+        state.SetBytesProcessed(state.iterations() * state.range(0));
+    }
+
+    template <typename T>
+    void BM_Decode(benchmark::State& state) {
+        auto bytes = legacy_pmt::serialize_to_legacy(make_vector<T>(state.range(0)));
+        for (auto _ : state)
+            benchmark::DoNotOptimize(legacy_pmt::deserialize_from_legacy(bytes.data(), bytes.size()));
+        state.SetBytesProcessed(state.iterations() * state.range(0));
+    }
+
+    template <typename T>
+    void BM_DecodeFramed(benchmark::State& state) {
+        auto bytes = legacy_pmt::serialize_framed(make_vector<T>(state.range(0)));
+        for (auto _ : state)
+            benchmark::DoNotOptimize(legacy_pmt::deserialize_framed(bytes.data(), bytes.size()));
+        state.SetBytesProcessed(state.iterations() * state.range(0));
+    }
+
+}
+
+#define FRAMED_BENCHMARKS(T)                                         \
+    BENCHMARK(BM_Encode<T>)->RangeMultiplier(64)->Range(1024, 4 << 20);       \
+    BENCHMARK(BM_EncodeFramed<T>)->RangeMultiplier(64)->Range(1024, 4 << 20); \
+    BENCHMARK(BM_Decode<T>)->RangeMultiplier(64)->Range(1024, 4 << 20);       \
+    BENCHMARK(BM_DecodeFramed<T>)->RangeMultiplier(64)->Range(1024, 4 << 20);
+
+FRAMED_BENCHMARKS(uint8_t)
+FRAMED_BENCHMARKS(float)
+FRAMED_BENCHMARKS(std::complex<float>)
+FRAMED_BENCHMARKS(std::complex<double>)
+
+BENCHMARK_MAIN();
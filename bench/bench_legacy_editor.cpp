@@ -0,0 +1,61 @@
+#include <benchmark/benchmark.h>
+#include <pmt_converter/pmt_legacy_codec.h>
+#include <pmt_converter/pmt_legacy_editor.h>
+#include <vector>
+
+// Bumping a counter in a forwarded tag dict: full decode/encode round trip
+// against editing the encoded bytes. Argument: float samples in the burst
+// carried alongside the tags.
+
+namespace {
+
+    std::vector<uint8_t> make_message(size_t samples) {
+        return legacy_pmt::serialize_to_legacy(pmtv::map_t({{"rx_time", static_cast<int64_t>(249387429783478)},
+                                                            {"rx_rate", 2.4e6},
+                                                            {"seq", static_cast<int32_t>(0)},
+                                                            {"block", static_cast<int32_t>(0)},
+                                                            {"label", "burst_start"},
+                                                            {"burst", pmtv::Tensor<float>(samples, 0.5f)}}));
+    }
+
+    void BM_RoundTrip(benchmark::State& state) {
+        auto bytes = make_message(state.range(0));
+        int32_t seq = 0;
+        for (auto _ : state) {
+            pmtv::pmt obj = legacy_pmt::deserialize_from_legacy(bytes.data(), bytes.size());
+            std::get<pmtv::map_t>(obj).insert_or_assign("seq", ++seq);
+            bytes = legacy_pmt::serialize_to_legacy(obj);
+            benchmark::DoNotOptimize(bytes.data());
+        }
+    }
+
+    void BM_EditInPlace(benchmark::State& state) {
+        auto bytes = make_message(state.range(0));
+        legacy_pmt::legacy_editor editor{std::span<uint8_t>(bytes)};
+        int32_t seq = 0;
+        for (auto _ : state) {
+            editor.set({"seq"}, ++seq);
+            benchmark::DoNotOptimize(bytes.data());
+        }
+    }
+
+    // INT32 to INT64 and back; "block" sorts before the burst, so every
+    // edit moves the samples
+    void BM_EditSplice(benchmark::State& state) {
+        auto bytes = make_message(state.range(0));
+        legacy_pmt::legacy_editor editor(bytes);
+        int64_t seq = 0;
+        for (auto _ : state) {
+            editor.set({"block"}, ++seq);
+            editor.set({"block"}, static_cast<int32_t>(seq));
+            benchmark::DoNotOptimize(bytes.data());
+        }
+    }
+
+}
+
+BENCHMARK(BM_RoundTrip)->RangeMultiplier(16)->Range(16, 64 << 10);
+BENCHMARK(BM_EditInPlace)->RangeMultiplier(16)->Range(16, 64 << 10);
+BENCHMARK(BM_EditSplice)->RangeMultiplier(16)->Range(16, 64 << 10);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,70 @@
+#include <benchmark/benchmark.h>
+#include <pmt_converter/legacy/pmt_legacy_hash.h>
+#include <pmt_converter/legacy/pmt_legacy_serialize.h>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+// Dedup building blocks for repeated metadata messages: structural hash,
+// encoded-bytes hash and deep equality. Argument: number of dict entries.
+
+namespace {
+
+    using legacy::pmt_t;
+
+    std::shared_ptr<pmt_t> make_dict(size_t entries) {
+        legacy::pmt_dict d;
+        for (size_t i = 0; i < entries; ++i) {
+            auto key = pmt_t::make_symbol("key_" + std::to_string(i));
+            if (i % 2 == 0)
+                d[key] = pmt_t::make_int(static_cast<int64_t>(i) << 36);
+            else
+                d[key] = pmt_t::make_symbol("value_" + std::to_string(i));
+        }
+        return pmt_t::make_dict(d);
+    }
+
+    void BM_HashValue(benchmark::State& state) {
+        auto obj = make_dict(state.range(0));
+        for (auto _ : state)
+            benchmark::DoNotOptimize(legacy_pmt::legacy_pmt_hash(obj));
+    }
+
+    void BM_HashEncoded(benchmark::State& state) {
+        auto bytes = legacy_pmt::serialize_legacy_pmt(make_dict(state.range(0)));
+        for (auto _ : state)
+            benchmark::DoNotOptimize(legacy_pmt::legacy_bytes_hash(bytes.data(), bytes.size()));
+        state.SetBytesProcessed(state.iterations() * bytes.size());
+    }
+
+    void BM_DeepEqual(benchmark::State& state) {
+        auto a = make_dict(state.range(0));
+        auto b = make_dict(state.range(0));
+        for (auto _ : state)
+            benchmark::DoNotOptimize(*a == *b);
+    }
+
+    void BM_DedupEncoded(benchmark::State& state) {
+        // Ten distinct messages repeating, as periodic tags do
+        std::vector<std::vector<uint8_t>> msgs;
+        for (int i = 0; i < 10; ++i) {
+            auto obj = make_dict(state.range(0));
+            legacy::pmt_dict d = obj->to_dict();
+            d[pmt_t::make_symbol("seq")] = pmt_t::make_int(i);
+            msgs.push_back(legacy_pmt::serialize_legacy_pmt(pmt_t::make_dict(d)));
+        }
+        std::unordered_set<std::vector<uint8_t>, legacy_pmt::encoded_hash, legacy_pmt::encoded_equal> seen(msgs.begin(), msgs.end());
+        size_t i = 0;
+        for (auto _ : state)
+            benchmark::DoNotOptimize(seen.contains(std::span<const uint8_t>(msgs[i++ % msgs.size()])));
+        state.SetItemsProcessed(state.iterations());
+    }
+
+}
+
+BENCHMARK(BM_HashValue)->RangeMultiplier(8)->Range(1, 512);
+BENCHMARK(BM_HashEncoded)->RangeMultiplier(8)->Range(1, 512);
+BENCHMARK(BM_DeepEqual)->RangeMultiplier(8)->Range(1, 512);
+BENCHMARK(BM_DedupEncoded)->RangeMultiplier(8)->Range(1, 512);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,69 @@
+#include <benchmark/benchmark.h>
+#include <pmt_converter/legacy/pmt_legacy_serialize.h>
+#include <pmt_converter/pmt_converter.h>
+#include <pmt_converter/pmt_legacy_codec.h>
+#include <string>
+#include <vector>
+
+// Native legacy::pmt_t codec against the two-hop path through pmtv::pmt
+// (legacy bytes <-> pmtv::pmt <-> legacy::pmt_t). Argument: number of dict entries.
+
+namespace {
+
+    using legacy::pmt_t;
+
+    std::shared_ptr<pmt_t> make_dict(size_t entries) {
+        legacy::pmt_dict d;
+        for (size_t i = 0; i < entries; ++i) {
+            auto key = pmt_t::make_symbol("key_" + std::to_string(i));
+            if (i % 3 == 0)
+                d[key] = pmt_t::make_int(static_cast<int64_t>(i) << 36);
+            else if (i % 3 == 1)
+                d[key] = pmt_t::make_symbol("value_" + std::to_string(i));
+            else
+                d[key] = pmt_t::make_bool(i % 2 == 0);
+        }
+        return pmt_t::make_dict(d);
+    }
+
+    void BM_EncodeNative(benchmark::State& state) {
+        auto obj = make_dict(state.range(0));
+        std::vector<uint8_t> out(legacy_pmt::legacy_pmt_serialized_size(obj));
+        for (auto _ : state)
+            benchmark::DoNotOptimize(legacy_pmt::serialize_legacy_pmt(obj, out.data(), out.size()));
+        state.SetBytesProcessed(state.iterations() * out.size());
+    }
+
+    void BM_EncodeTwoHop(benchmark::State& state) {
+        auto obj = make_dict(state.range(0));
+        size_t bytes = 0;
+        for (auto _ : state) {
+            auto out = legacy_pmt::serialize_to_legacy(gr_compat::to_new_pmt(obj));
+            bytes = out.size();
+            benchmark::DoNotOptimize(out.data());
+        }
+        state.SetBytesProcessed(state.iterations() * bytes);
+    }
+
+    void BM_DecodeNative(benchmark::State& state) {
+        auto bytes = legacy_pmt::serialize_legacy_pmt(make_dict(state.range(0)));
+        for (auto _ : state)
+            benchmark::DoNotOptimize(legacy_pmt::deserialize_legacy_pmt(bytes.data(), bytes.size()));
+        state.SetBytesProcessed(state.iterations() * bytes.size());
+    }
+
+    void BM_DecodeTwoHop(benchmark::State& state) {
+        auto bytes = legacy_pmt::serialize_legacy_pmt(make_dict(state.range(0)));
+        for (auto _ : state)
+            benchmark::DoNotOptimize(gr_compat::to_legacy_pmt(legacy_pmt::deserialize_from_legacy(bytes.data(), bytes.size())));
+        state.SetBytesProcessed(state.iterations() * bytes.size());
+    }
+
+}
+
+BENCHMARK(BM_EncodeNative)->RangeMultiplier(8)->Range(1, 512);
+BENCHMARK(BM_EncodeTwoHop)->RangeMultiplier(8)->Range(1, 512);
+BENCHMARK(BM_DecodeNative)->RangeMultiplier(8)->Range(1, 512);
+BENCHMARK(BM_DecodeTwoHop)->RangeMultiplier(8)->Range(1, 512);
+
+BENCHMARK_MAIN();
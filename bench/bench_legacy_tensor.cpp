@@ -0,0 +1,69 @@
+#include <benchmark/benchmark.h>
+#include <pmt_converter/pmt_legacy_codec.h>
+#include <pmt_converter/pmt_legacy_tensor.h>
+#include <complex>
+#include <vector>
+
+// Encoding a channel-major [channel][sample] tensor out of an interleaved
+// multi-channel capture: transpose into a contiguous pmtv::Tensor first, or
+// gather straight from a strided view. Argument: samples per channel.
+
+namespace {
+
+    constexpr size_t channels = 8;
+
+    std::vector<std::complex<float>> make_capture(size_t samples) {
+        std::vector<std::complex<float>> v(samples * channels);
+        for (size_t i = 0; i < v.size(); ++i)
+            v[i] = {static_cast<float>(i % 1000), -static_cast<float>(i % 777)};
+        return v;
+    }
+
+    void BM_TransposeThenEncode(benchmark::State& state) {
+        size_t samples = state.range(0);
+        auto capture = make_capture(samples);
+        std::vector<uint8_t> out(legacy_pmt::uniform_vector_header_size_for(2) + capture.size() * 8);
+        for (auto _ : state) {
+            std::vector<std::complex<float>> contiguous(capture.size());
+            for (size_t ch = 0; ch < channels; ++ch)
+                for (size_t s = 0; s < samples; ++s)
+                    contiguous[ch * samples + s] = capture[s * channels + ch];
+            pmtv::Tensor<std::complex<float>> t(std::move(contiguous));
+            t.reshape(std::vector<size_t>{channels, samples});
+            benchmark::DoNotOptimize(legacy_pmt::serialize_to_legacy(t, out.data(), out.size()));
+        }
+        state.SetBytesProcessed(state.iterations() * capture.size() * sizeof(std::complex<float>));
+    }
+
+    void BM_StridedView(benchmark::State& state) {
+        size_t samples = state.range(0);
+        auto capture = make_capture(samples);
+        std::vector<size_t> extents{channels, samples};
+        std::vector<ptrdiff_t> strides{1, static_cast<ptrdiff_t>(channels)};
+        legacy_pmt::tensor_view<std::complex<float>> view{capture.data(), extents, strides};
+        std::vector<uint8_t> out(legacy_pmt::legacy_tensor_size(view));
+        for (auto _ : state)
+            benchmark::DoNotOptimize(legacy_pmt::serialize_tensor_to_legacy(view, out.data(), out.size()));
+        state.SetBytesProcessed(state.iterations() * capture.size() * sizeof(std::complex<float>));
+    }
+
+    // Row-major views collapse into one block, the same as a contiguous tensor
+    void BM_ContiguousView(benchmark::State& state) {
+        size_t samples = state.range(0);
+        auto capture = make_capture(samples);
+        std::vector<size_t> extents{samples, channels};
+        std::vector<ptrdiff_t> strides{static_cast<ptrdiff_t>(channels), 1};
+        legacy_pmt::tensor_view<std::complex<float>> view{capture.data(), extents, strides};
+        std::vector<uint8_t> out(legacy_pmt::legacy_tensor_size(view));
+        for (auto _ : state)
+            benchmark::DoNotOptimize(legacy_pmt::serialize_tensor_to_legacy(view, out.data(), out.size()));
+        state.SetBytesProcessed(state.iterations() * capture.size() * sizeof(std::complex<float>));
+    }
+
+}
+
+BENCHMARK(BM_TransposeThenEncode)->RangeMultiplier(16)->Range(256, 64 << 10);
+BENCHMARK(BM_StridedView)->RangeMultiplier(16)->Range(256, 64 << 10);
+BENCHMARK(BM_ContiguousView)->RangeMultiplier(16)->Range(256, 64 << 10);
+
+BENCHMARK_MAIN();
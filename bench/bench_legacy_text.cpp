@@ -0,0 +1,80 @@
+#include <benchmark/benchmark.h>
+#include <pmt_converter/legacy/pmt_legacy_serialize.h>
+#include <pmt_converter/pmt_legacy_codec.h>
+#include <pmt_converter/pmt_legacy_text.h>
+#include <sstream>
+#include <string>
+
+// Debug-dump cost: operator<< into a stream against format_to() into a reused
+// buffer, from a tree and straight from the encoded bytes.
+// Argument: number of dict entries.
+
+namespace {
+
+    using legacy::pmt_t;
+
+    std::shared_ptr<pmt_t> make_dict(size_t entries) {
+        legacy::pmt_dict d;
+        for (size_t i = 0; i < entries; ++i) {
+            auto key = pmt_t::make_symbol("key_" + std::to_string(i));
+            if (i % 2 == 0)
+                d[key] = pmt_t::make_int(static_cast<int64_t>(i) * 1000003);
+            else
+                d[key] = pmt_t::make_vector({pmt_t::make_symbol("value"), pmt_t::make_bool(true)});
+        }
+        return pmt_t::make_dict(d);
+    }
+
+    void BM_Ostream(benchmark::State& state) {
+        auto obj = make_dict(state.range(0));
+        for (auto _ : state) {
+            std::ostringstream os;
+            os << obj;
+            benchmark::DoNotOptimize(os.str().data());
+        }
+    }
+
+    void BM_FormatTree(benchmark::State& state) {
+        auto obj = make_dict(state.range(0));
+        legacy_pmt::format_options opts;
+        opts.max_elements = 1 << 20;
+        std::string out;
+        for (auto _ : state) {
+            out.clear();
+            legacy_pmt::format_to(out, obj, opts);
+            benchmark::DoNotOptimize(out.data());
+        }
+    }
+
+    void BM_FormatBytes(benchmark::State& state) {
+        auto bytes = legacy_pmt::serialize_legacy_pmt(make_dict(state.range(0)));
+        legacy_pmt::format_options opts;
+        opts.max_elements = 1 << 20;
+        std::string out;
+        for (auto _ : state) {
+            out.clear();
+            legacy_pmt::format_legacy_to(out, bytes.data(), bytes.size(), opts);
+            benchmark::DoNotOptimize(out.data());
+        }
+        state.SetBytesProcessed(state.iterations() * bytes.size());
+    }
+
+    // A large sample burst dumped with the default element limit
+    void BM_FormatBurstTruncated(benchmark::State& state) {
+        auto bytes = legacy_pmt::serialize_to_legacy(pmtv::Tensor<float>(state.range(0), 0.25f));
+        std::string out;
+        for (auto _ : state) {
+            out.clear();
+            legacy_pmt::format_legacy_to(out, bytes.data(), bytes.size());
+            benchmark::DoNotOptimize(out.data());
+        }
+    }
+
+}
+
+BENCHMARK(BM_Ostream)->RangeMultiplier(8)->Range(1, 512);
+BENCHMARK(BM_FormatTree)->RangeMultiplier(8)->Range(1, 512);
+BENCHMARK(BM_FormatBytes)->RangeMultiplier(8)->Range(1, 512);
+BENCHMARK(BM_FormatBurstTruncated)->Arg(1 << 20);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,58 @@
+#include <benchmark/benchmark.h>
+#include <pmt_converter/pmt_legacy_codec.h>
+#include <complex>
+#include <thread>
+#include <vector>
+
+// Scaling of uniform vector encode/decode with the number of threads.
+// Arguments: payload size in MiB, thread count.
+
+namespace {
+
+    pmtv::pmt make_burst(size_t mib) {
+        std::vector<std::complex<float>> samples(mib * 1024 * 1024 / sizeof(std::complex<float>));
+        for (size_t i = 0; i < samples.size(); ++i)
+            samples[i] = {static_cast<float>(i & 0xFFFF), -static_cast<float>(i & 0xFF)};
+        return pmtv::Tensor<std::complex<float>>(samples);
+    }
+
+    void set_threads(benchmark::State& state) {
+        legacy_pmt::set_parallel_options({.threshold_bytes = 1024 * 1024,
+                                          .chunk_bytes = 1024 * 1024,
+                                          .max_threads = static_cast<unsigned>(state.range(1))});
+    }
+
+    void BM_EncodeC32(benchmark::State& state) {
+        pmtv::pmt obj = make_burst(state.range(0));
+        std::vector<uint8_t> out(legacy_pmt::legacy_serialized_size(obj));
+        set_threads(state);
+        for (auto _ : state) {
+            benchmark::DoNotOptimize(legacy_pmt::serialize_to_legacy(obj, out.data(), out.size()));
+        }
+        state.SetBytesProcessed(state.iterations() * out.size());
+    }
+
+    void BM_DecodeC32(benchmark::State& state) {
+        auto bytes = legacy_pmt::serialize_to_legacy(make_burst(state.range(0)));
+        set_threads(state);
+        for (auto _ : state) {
+            benchmark::DoNotOptimize(legacy_pmt::deserialize_from_legacy(bytes.data(), bytes.size()));
+        }
+        state.SetBytesProcessed(state.iterations() * bytes.size());
+    }
+
+    void thread_counts(benchmark::internal::Benchmark* b) {
+        unsigned max_threads = std::max(1u, std::thread::hardware_concurrency());
+        for (int64_t mib : {16, 256}) {
+            for (unsigned t = 1; t < max_threads; t *= 2)
+                b->Args({mib, t});
+            b->Args({mib, max_threads});
+        }
+    }
+
+}
+
+BENCHMARK(BM_EncodeC32)->Apply(thread_counts)->Unit(benchmark::kMillisecond)->UseRealTime();
+BENCHMARK(BM_DecodeC32)->Apply(thread_counts)->Unit(benchmark::kMillisecond)->UseRealTime();
+
+BENCHMARK_MAIN();
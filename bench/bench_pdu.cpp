@@ -0,0 +1,111 @@
+#include <benchmark/benchmark.h>
+#include <pmt_converter/pmt_legacy_codec.h>
+#include <pmt_converter/pmt_legacy_pdu.h>
+#include <complex>
+#include <vector>
+
+// GR3 PDUs, pair(metadata dict, uniform vector). The generic codec has no
+// pairs, so the baseline encodes both halves through it and concatenates, and
+// decodes by splitting the pair by hand. Argument: payload bytes, a 1500-byte
+// packet and a 64 KiB block.
+
+namespace {
+
+    pmtv::map_t make_meta() {
+        return pmtv::map_t({{"packet_len", static_cast<int32_t>(1500)},
+                            {"rx_time", static_cast<int64_t>(249387429783478)},
+                            {"snr", 17.5},
+                            {"crc_ok", true},
+                            {"label", "header_ok"}});
+    }
+
+    template <typename T>
+    pmtv::Tensor<T> make_payload(size_t bytes) {
+        if constexpr (std::is_same_v<T, uint8_t>)
+            return pmtv::Tensor<T>(bytes, 0x55);
+        else
+            return pmtv::Tensor<T>(bytes / sizeof(T), T{0.5f, -0.5f});
+    }
+
+    template <typename T>
+    void BM_GenericEncode(benchmark::State& state) {
+        auto meta = make_meta();
+        pmtv::pmt meta_obj = meta;
+        pmtv::pmt data = make_payload<T>(state.range(0));
+        std::vector<uint8_t> out;
+        for (auto _ : state) {
+            size_t car = legacy_pmt::legacy_serialized_size(meta_obj);
+            size_t cdr = legacy_pmt::legacy_serialized_size(data);
+            out.resize(1 + car + cdr);
+            out[0] = static_cast<uint8_t>(legacy_pmt::legacy_tag::LEGACY_PMT_PAIR);
+            legacy_pmt::serialize_to_legacy(meta_obj, out.data() + 1, car);
+            legacy_pmt::serialize_to_legacy(data, out.data() + 1 + car, cdr);
+            benchmark::DoNotOptimize(out.data());
+        }
+        state.SetBytesProcessed(state.iterations() * static_cast<int64_t>(out.size()));
+    }
+
+    template <typename T>
+    void BM_PduEncode(benchmark::State& state) {
+        auto meta = make_meta();
+        auto data = make_payload<T>(state.range(0));
+        std::vector<uint8_t> out(legacy_pmt::legacy_pdu_size(meta, data));
+        for (auto _ : state) {
+            legacy_pmt::serialize_pdu(meta, data, out.data(), out.size());
+            benchmark::DoNotOptimize(out.data());
+        }
+        state.SetBytesProcessed(state.iterations() * static_cast<int64_t>(out.size()));
+    }
+
+    template <typename T>
+    void BM_PduEncoder(benchmark::State& state) {
+        auto meta = make_meta();
+        auto data = make_payload<T>(state.range(0));
+        legacy_pmt::pdu_encoder encoder;
+        size_t size = 0;
+        for (auto _ : state) {
+            auto bytes = encoder.encode(meta, data);
+            size = bytes.size();
+            benchmark::DoNotOptimize(bytes.data());
+        }
+        state.SetBytesProcessed(state.iterations() * static_cast<int64_t>(size));
+    }
+
+    template <typename T>
+    void BM_GenericDecode(benchmark::State& state) {
+        auto bytes = legacy_pmt::serialize_pdu(make_meta(), make_payload<T>(state.range(0)));
+        for (auto _ : state) {
+            size_t car = legacy_pmt::legacy_encoded_size(bytes.data() + 1, bytes.size() - 1);
+            pmtv::pmt meta = legacy_pmt::deserialize_from_legacy(bytes.data() + 1, car);
+            pmtv::pmt data = legacy_pmt::deserialize_from_legacy(bytes.data() + 1 + car, bytes.size() - 1 - car);
+            benchmark::DoNotOptimize(meta);
+            benchmark::DoNotOptimize(data);
+        }
+        state.SetBytesProcessed(state.iterations() * static_cast<int64_t>(bytes.size()));
+    }
+
+    template <typename T>
+    void BM_PduDecode(benchmark::State& state) {
+        auto bytes = legacy_pmt::serialize_pdu(make_meta(), make_payload<T>(state.range(0)));
+        for (auto _ : state) {
+            auto pdu = legacy_pmt::deserialize_pdu<T>(bytes.data(), bytes.size());
+            benchmark::DoNotOptimize(pdu);
+        }
+        state.SetBytesProcessed(state.iterations() * static_cast<int64_t>(bytes.size()));
+    }
+
+} // namespace
+
+BENCHMARK(BM_GenericEncode<uint8_t>)->Arg(1500)->Arg(64 << 10);
+BENCHMARK(BM_PduEncode<uint8_t>)->Arg(1500)->Arg(64 << 10);
+BENCHMARK(BM_PduEncoder<uint8_t>)->Arg(1500)->Arg(64 << 10);
+BENCHMARK(BM_GenericDecode<uint8_t>)->Arg(1500)->Arg(64 << 10);
+BENCHMARK(BM_PduDecode<uint8_t>)->Arg(1500)->Arg(64 << 10);
+
+BENCHMARK(BM_GenericEncode<std::complex<float>>)->Arg(1500)->Arg(64 << 10);
+BENCHMARK(BM_PduEncode<std::complex<float>>)->Arg(1500)->Arg(64 << 10);
+BENCHMARK(BM_PduEncoder<std::complex<float>>)->Arg(1500)->Arg(64 << 10);
+BENCHMARK(BM_GenericDecode<std::complex<float>>)->Arg(1500)->Arg(64 << 10);
+BENCHMARK(BM_PduDecode<std::complex<float>>)->Arg(1500)->Arg(64 << 10);
+
+BENCHMARK_MAIN();
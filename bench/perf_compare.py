@@ -0,0 +1,104 @@
+#!/usr/bin/env python3
+"""Codec throughput regression gate.
+
+Runs a google-benchmark executable and compares the median throughput of
+every benchmark against a stored baseline:
+
+    perf_compare.py [--threshold PCT] [--repetitions N] BENCH_EXE BASELINE_JSON
+    perf_compare.py --update BENCH_EXE BASELINE_JSON
+
+Exits with status 1 if any benchmark is more than PCT percent slower than its
+baseline. Baselines are machine specific; refresh them with --update (the
+perf_baseline target) on the machine that runs the gate.
+"""
+
+import argparse
+import json
+import os
+import platform
+import subprocess
+import sys
+import tempfile
+
+
+def throughput(bench):
+    """Higher is better: bytes/s or items/s if reported, else runs per second."""
+    for key in ('bytes_per_second', 'items_per_second'):
+        if key in bench:
+            return key, float(bench[key])
+    scale = {'ns': 1e-9, 'us': 1e-6, 'ms': 1e-3, 's': 1.0}[bench.get('time_unit', 'ns')]
+    return 'runs_per_second', 1.0 / (float(bench['real_time']) * scale)
+
+
+def run_benchmarks(exe, repetitions):
+    with tempfile.TemporaryDirectory() as tmp:
+        out = os.path.join(tmp, 'result.json')
+        subprocess.run([exe,
+                        '--benchmark_repetitions=%d' % repetitions,
+                        '--benchmark_report_aggregates_only=true',
+                        '--benchmark_out_format=json',
+                        '--benchmark_out=' + out],
+                       check=True, stdout=subprocess.DEVNULL)
+        with open(out) as f:
+            report = json.load(f)
+
+    results = {}
+    for bench in report['benchmarks']:
+        if bench.get('run_type') == 'aggregate' and bench.get('aggregate_name') != 'median':
+            continue
+        name = bench.get('run_name', bench['name'])
+        metric, value = throughput(bench)
+        results[name] = {'metric': metric, 'value': value}
+    return results
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument('--threshold', type=float, default=10.0,
+                        help='allowed slowdown in percent (default: %(default)s)')
+    parser.add_argument('--repetitions', type=int, default=5)
+    parser.add_argument('--update', action='store_true', help='overwrite the baseline with this run')
+    parser.add_argument('bench_exe')
+    parser.add_argument('baseline')
+    args = parser.parse_args()
+
+    current = run_benchmarks(args.bench_exe, args.repetitions)
+
+    if args.update:
+        with open(args.baseline, 'w') as f:
+            json.dump({'machine': platform.machine(), 'benchmarks': current},
+                      f, indent=2, sort_keys=True)
+            f.write('\n')
+        print('wrote %d baseline entries to %s' % (len(current), args.baseline))
+        return 0
+
+    with open(args.baseline) as f:
+        baseline = json.load(f)['benchmarks']
+
+    failed = []
+    print('%-52s %14s %14s %8s' % ('benchmark', 'baseline', 'current', 'change'))
+    for name in sorted(set(baseline) | set(current)):
+        if name not in current:
+            print('%-52s %14s %14s %8s' % (name, '', 'missing', ''))
+            failed.append(name)
+            continue
+        if name not in baseline:
+            print('%-52s %14s %14.4g %8s' % (name, 'new', current[name]['value'], ''))
+            continue
+        base = baseline[name]['value']
+        cur = current[name]['value']
+        change = (cur - base) / base * 100.0
+        flag = ''
+        if change < -args.threshold:
+            flag = '  REGRESSION'
+            failed.append(name)
+        print('%-52s %14.4g %14.4g %+7.1f%%%s' % (name, base, cur, change, flag))
+
+    if failed:
+        print('\n%d benchmark(s) regressed more than %.1f%% or went missing' % (len(failed), args.threshold))
+        return 1
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
@@ -1,12 +1,14 @@
 // legacy/pmt_legacy.h
 #pragma once
 
+#include <algorithm>
 #include <variant>
 #include <string>
 #include <vector>
 #include <map>
 #include <memory>
 #include <stdexcept>
+#include <utility>
 #include <cstdint>
 #include <iostream>
 
@@ -14,6 +16,10 @@ namespace legacy {
 
 struct pmt_t;  // forward declaration
 
+// Value comparison; nested values are compared by content, not by pointer
+bool deep_equal(const pmt_t& a, const pmt_t& b);
+bool deep_equal(const std::shared_ptr<pmt_t>& a, const std::shared_ptr<pmt_t>& b);
+
 using pmt_pair = std::pair<std::shared_ptr<pmt_t>, std::shared_ptr<pmt_t>>;
 using pmt_vector = std::vector<std::shared_ptr<pmt_t>>;
 using pmt_dict = std::map<std::shared_ptr<pmt_t>, std::shared_ptr<pmt_t>>;
@@ -31,30 +37,33 @@ public:
     pmt_t() = default;
     explicit pmt_t(const variant_t& val) : _val(val) {}
     explicit pmt_t(variant_t&& val) : _val(std::move(val)) {}
+    // Constructs the alternative T in place, without a temporary variant
+    template <typename T, typename... Args>
+    explicit pmt_t(std::in_place_type_t<T> type, Args&&... args) : _val(type, std::forward<Args>(args)...) {}
 
     // Factory functions
     static std::shared_ptr<pmt_t> make_bool(bool b) {
-        return std::make_shared<pmt_t>(b);
+        return std::make_shared<pmt_t>(std::in_place_type<bool>, b);
     }
 
     static std::shared_ptr<pmt_t> make_int(int64_t i) {
-        return std::make_shared<pmt_t>(i);
+        return std::make_shared<pmt_t>(std::in_place_type<int64_t>, i);
     }
 
     static std::shared_ptr<pmt_t> make_symbol(const std::string& s) {
-        return std::make_shared<pmt_t>(s);
+        return std::make_shared<pmt_t>(std::in_place_type<std::string>, s);
     }
 
     static std::shared_ptr<pmt_t> make_pair(std::shared_ptr<pmt_t> car, std::shared_ptr<pmt_t> cdr) {
-        return std::make_shared<pmt_t>(pmt_pair{car, cdr});
+        return std::make_shared<pmt_t>(std::in_place_type<pmt_pair>, std::move(car), std::move(cdr));
     }
 
     static std::shared_ptr<pmt_t> make_vector(const pmt_vector& vec) {
-        return std::make_shared<pmt_t>(vec);
+        return std::make_shared<pmt_t>(std::in_place_type<pmt_vector>, vec);
     }
 
     static std::shared_ptr<pmt_t> make_dict(const pmt_dict& d) {
-        return std::make_shared<pmt_t>(d);
+        return std::make_shared<pmt_t>(std::in_place_type<pmt_dict>, d);
     }
 
     // Type checkers
@@ -68,23 +77,62 @@ public:
     // Accessors
     bool to_bool() const    { return std::get<bool>(_val); }
     int64_t to_int() const  { return std::get<int64_t>(_val); }
-    std::string to_symbol() const { return std::get<std::string>(_val); }
+    const std::string& to_symbol() const { return std::get<std::string>(_val); }
 
-    std::shared_ptr<pmt_t> car() const { return std::get<pmt_pair>(_val).first; }
-    std::shared_ptr<pmt_t> cdr() const { return std::get<pmt_pair>(_val).second; }
+    const std::shared_ptr<pmt_t>& car() const { return std::get<pmt_pair>(_val).first; }
+    const std::shared_ptr<pmt_t>& cdr() const { return std::get<pmt_pair>(_val).second; }
 
     const pmt_vector& to_vector() const { return std::get<pmt_vector>(_val); }
     const pmt_dict& to_dict() const     { return std::get<pmt_dict>(_val); }
 
-    // Optional: equality check
+    // Structural equality, see deep_equal()
     bool operator==(const pmt_t& other) const {
-        return _val == other._val;
+        return deep_equal(*this, other);
     }
 
+    size_t index() const { return _val.index(); }
+
 private:
     variant_t _val;
 };
 
+inline bool deep_equal(const std::shared_ptr<pmt_t>& a, const std::shared_ptr<pmt_t>& b) {
+    if (a == b)
+        return true;
+    if (!a || !b)
+        return false;
+    return deep_equal(*a, *b);
+}
+
+namespace detail {
+
+// Dicts are ordered by key pointer, so equal dicts may iterate in different
+// orders. Defined with the legacy encoder, which walks both in its canonical
+// entry order; symbol-keyed dicts of up to 16 entries compare without allocating.
+bool dict_equal(const pmt_dict& a, const pmt_dict& b);
+
+} // namespace detail
+
+inline bool deep_equal(const pmt_t& a, const pmt_t& b) {
+    if (&a == &b)
+        return true;
+    if (a.index() != b.index())
+        return false;
+
+    if (a.is_bool())   return a.to_bool() == b.to_bool();
+    if (a.is_int())    return a.to_int() == b.to_int();
+    if (a.is_symbol()) return a.to_symbol() == b.to_symbol();
+    if (a.is_pair())   return deep_equal(a.car(), b.car()) && deep_equal(a.cdr(), b.cdr());
+    if (a.is_vector()) {
+        const auto& va = a.to_vector();
+        const auto& vb = b.to_vector();
+        return va.size() == vb.size() &&
+               std::equal(va.begin(), va.end(), vb.begin(),
+                          [](const auto& x, const auto& y) { return deep_equal(x, y); });
+    }
+    return detail::dict_equal(a.to_dict(), b.to_dict());
+}
+
 inline std::ostream& operator<<(std::ostream& os, const std::shared_ptr<pmt_t>& pmt) {
     if (!pmt) return os << "<null>";
     if (pmt->is_bool())    return os << (pmt->to_bool() ? "true" : "false");
@@ -0,0 +1,58 @@
+// legacy/pmt_legacy_hash.h
+#pragma once
+
+#include <pmt_converter/legacy/pmt_legacy.h>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <span>
+
+namespace legacy_pmt {
+
+/**
+ * Structural hash of a legacy::pmt_t tree: values that compare equal with
+ * legacy::deep_equal() hash equal, regardless of which shared_ptrs they are
+ * built from. It is the hash of the canonical encoding, i.e.
+ *
+ *     legacy_pmt_hash(obj) == legacy_bytes_hash(serialize_legacy_pmt(obj))
+ *
+ * without materializing the bytes.
+ */
+uint64_t legacy_pmt_hash(const std::shared_ptr<legacy::pmt_t>& obj);
+
+/**
+ * Hash of an encoded legacy message. Matches legacy_pmt_hash() for buffers
+ * produced by serialize_legacy_pmt(); other encoders may order dict entries
+ * differently, which hashes as a different message.
+ */
+uint64_t legacy_bytes_hash(const uint8_t* data, size_t size);
+
+/** Hash and equality functors for deduplicating legacy::pmt_t values in unordered containers. */
+struct pmt_value_hash {
+    size_t operator()(const std::shared_ptr<legacy::pmt_t>& obj) const { return legacy_pmt_hash(obj); }
+};
+
+struct pmt_value_equal {
+    bool operator()(const std::shared_ptr<legacy::pmt_t>& a, const std::shared_ptr<legacy::pmt_t>& b) const {
+        return legacy::deep_equal(a, b);
+    }
+};
+
+/**
+ * Hash and equality functors for encoded messages. Both are transparent, so a
+ * set of std::vector<uint8_t> can be probed with a span into a receive buffer
+ * or ring without copying it first.
+ */
+struct encoded_hash {
+    using is_transparent = void;
+    size_t operator()(std::span<const uint8_t> bytes) const { return legacy_bytes_hash(bytes.data(), bytes.size()); }
+};
+
+struct encoded_equal {
+    using is_transparent = void;
+    bool operator()(std::span<const uint8_t> a, std::span<const uint8_t> b) const {
+        return a.size() == b.size() && (a.empty() || std::memcmp(a.data(), b.data(), a.size()) == 0);
+    }
+};
+
+} // namespace legacy_pmt
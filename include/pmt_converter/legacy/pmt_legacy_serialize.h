@@ -0,0 +1,37 @@
+// legacy/pmt_legacy_serialize.h
+#pragma once
+
+#include <pmt_converter/legacy/pmt_legacy.h>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace legacy_pmt {
+
+/**
+ * Binary codec between the legacy GNU Radio PMT wire format and the in-tree
+ * legacy::pmt_t object model, without going through pmtv::pmt.
+ *
+ * A null pointer is PMT_NIL. Integers are written as INT32 when they fit and
+ * INT64 otherwise, as GR3 does; dict entries with symbol keys are written in
+ * key order so equal dicts encode to equal bytes. The legacy model has no
+ * doubles, complex numbers or uniform vectors, so those tags are rejected.
+ */
+
+/** Number of bytes serialize_legacy_pmt() produces for obj. */
+size_t legacy_pmt_serialized_size(const std::shared_ptr<legacy::pmt_t>& obj);
+
+std::vector<uint8_t> serialize_legacy_pmt(const std::shared_ptr<legacy::pmt_t>& obj);
+
+/** Throws std::length_error if capacity is smaller than legacy_pmt_serialized_size(obj). */
+size_t serialize_legacy_pmt(const std::shared_ptr<legacy::pmt_t>& obj, uint8_t* out, size_t capacity);
+
+/**
+ * Decode a legacy blob into a legacy::pmt_t tree. Tuples decode as vectors and
+ * UINT64 as int. Throws std::runtime_error if the data is malformed, uses a
+ * type the legacy model cannot hold, or nests deeper than legacy_max_depth
+ * (pmt_legacy_format.h). Every element of a pair list counts as a level.
+ */
+std::shared_ptr<legacy::pmt_t> deserialize_legacy_pmt(const uint8_t* data, size_t size);
+
+} // namespace legacy_pmt
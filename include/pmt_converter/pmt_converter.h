@@ -1,32 +1,42 @@
 #pragma once
 
-#include <legacy/pmt.h>
-#include "pmt_converter.h"
+#include <pmt_converter/legacy/pmt_legacy.h>
 #include <pmtv/pmt.hpp>
 
+#include <cstdint>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
 namespace gr_compat {
 
-pmtv::pmt to_new_pmt(const legacy::pmt_t& old) {
-    if (old.is_bool()) {
-        return pmtv::pmt(old.to_bool());
-    } else if (old.is_int()) {
-        return pmtv::pmt(old.to_int());
-    } else if (old.is_symbol()) {
-        return pmtv::pmt(symbol(old.to_symbol()));
-    } else if (old.is_pair()) {
-        return pmtv::pmt(pair(
-            to_new_pmt(old.car()),
-            to_new_pmt(old.cdr())));
-    } else if (old.is_vector()) {
+// The legacy model has no pair type counterpart in pmtv; pairs map to a
+// two-element pmt vector and do not round trip back into a pair.
+inline pmtv::pmt to_new_pmt(const std::shared_ptr<legacy::pmt_t>& old) {
+    if (!old) {
+        return pmtv::pmt();
+    } else if (old->is_bool()) {
+        return pmtv::pmt(old->to_bool());
+    } else if (old->is_int()) {
+        return pmtv::pmt(old->to_int());
+    } else if (old->is_symbol()) {
+        return pmtv::pmt(old->to_symbol());
+    } else if (old->is_pair()) {
+        return pmtv::pmt(std::vector<pmtv::pmt>{to_new_pmt(old->car()), to_new_pmt(old->cdr())});
+    } else if (old->is_vector()) {
         std::vector<pmtv::pmt> vec;
-        for (const auto& item : old.to_vector()) {
+        vec.reserve(old->to_vector().size());
+        for (const auto& item : old->to_vector()) {
             vec.push_back(to_new_pmt(item));
         }
-        return pmtv::pmt(vector(vec));
-    } else if (old.is_dict()) {
-        map m;
-        for (const auto& [k, v] : old.to_dict()) {
-            m.set(to_new_pmt(k), to_new_pmt(v));
+        return pmtv::pmt(vec);
+    } else if (old->is_dict()) {
+        pmtv::map_t m;
+        for (const auto& [k, v] : old->to_dict()) {
+            if (!k || !k->is_symbol())
+                throw std::runtime_error("Only symbol keys convert to a pmtv map");
+            m.insert_or_assign(k->to_symbol(), to_new_pmt(v));
         }
         return pmtv::pmt(m);
     } else {
@@ -34,33 +44,35 @@ pmtv::pmt to_new_pmt(const legacy::pmt_t& old) {
     }
 }
 
-legacy::pmt_t to_legacy_pmt(const pmtv::pmt& obj) {
-    if (obj.is<bool>()) {
-        return legacy::make_bool(obj.get<bool>());
-    } else if (obj.is<int64_t>()) {
-        return legacy::make_int(obj.get<int64_t>());
-    } else if (obj.is<symbol>()) {
-        return legacy::make_symbol(obj.get<symbol>().str());
-    } else if (obj.is<pair>()) {
-        auto p = obj.get<pair>();
-        return legacy::make_pair(
-            to_legacy_pmt(p.first),
-            to_legacy_pmt(p.second));
-    } else if (obj.is<vector>()) {
-        std::vector<legacy::pmt_t> vec;
-        for (const auto& item : obj.get<vector>().items) {
-            vec.push_back(to_legacy_pmt(item));
-        }
-        return legacy::make_vector(vec);
-    } else if (obj.is<map>()) {
-        legacy::dict_type dict;
-        for (const auto& [k, v] : obj.get<map>().items) {
-            dict[to_legacy_pmt(k)] = to_legacy_pmt(v);
+inline std::shared_ptr<legacy::pmt_t> to_legacy_pmt(const pmtv::pmt& obj) {
+    return std::visit([](const auto& val) -> std::shared_ptr<legacy::pmt_t> {
+        using T = std::decay_t<decltype(val)>;
+
+        if constexpr (std::same_as<T, std::monostate>) {
+            return nullptr;
+        } else if constexpr (std::same_as<T, bool>) {
+            return legacy::pmt_t::make_bool(val);
+        } else if constexpr (std::integral<T>) {
+            return legacy::pmt_t::make_int(static_cast<int64_t>(val));
+        } else if constexpr (std::same_as<T, std::string>) {
+            return legacy::pmt_t::make_symbol(val);
+        } else if constexpr (std::same_as<T, std::vector<pmtv::pmt>>) {
+            legacy::pmt_vector vec;
+            vec.reserve(val.size());
+            for (const auto& item : val) {
+                vec.push_back(to_legacy_pmt(item));
+            }
+            return legacy::pmt_t::make_vector(vec);
+        } else if constexpr (std::same_as<T, pmtv::map_t>) {
+            legacy::pmt_dict dict;
+            for (const auto& [k, v] : val) {
+                dict[legacy::pmt_t::make_symbol(k)] = to_legacy_pmt(v);
+            }
+            return legacy::pmt_t::make_dict(dict);
+        } else {
+            throw std::runtime_error("Unsupported PMT4 type");
         }
-        return legacy::make_dict(dict);
-    } else {
-        throw std::runtime_error("Unsupported PMT4 type");
-    }
+    }, obj);
 }
 
-}
+} // namespace gr_compat
@@ -6,16 +6,51 @@
 
 namespace legacy_pmt {
 
+/**
+ * Tuning for large uniform vector payloads. Payloads of at least threshold_bytes
+ * are split into chunk_bytes pieces that are byte-swapped in parallel on a
+ * shared thread pool, both when encoding and decoding.
+ */
+struct parallel_options {
+    size_t threshold_bytes = 16 * 1024 * 1024;
+    size_t chunk_bytes = 1024 * 1024;
+    unsigned max_threads = 0; // 0 uses every hardware thread, 1 disables parallelism
+};
+
+/** Process-wide; safe to call concurrently with encoding/decoding. */
+void set_parallel_options(const parallel_options& opts);
+parallel_options get_parallel_options();
+
 /**
  * Serialize a pmtv::pmt into the legacy GNU Radio PMT binary format.
  * Returns a vector of bytes that can be passed to a ZMQ socket or saved to a file.
  */
 std::vector<uint8_t> serialize_to_legacy(const pmtv::pmt& obj);
 
+/**
+ * Number of bytes serialize_to_legacy() produces for obj.
+ * Throws std::runtime_error if obj has no legacy representation.
+ */
+size_t legacy_serialized_size(const pmtv::pmt& obj);
+
+/**
+ * Serialize obj in place into a caller-provided buffer and return the number of bytes written.
+ * Throws std::length_error if capacity is smaller than legacy_serialized_size(obj).
+ */
+size_t serialize_to_legacy(const pmtv::pmt& obj, uint8_t* out, size_t capacity);
+
 /**
  * Deserialize a binary blob (legacy GNU Radio PMT format) into a pmtv::pmt.
  * Throws std::runtime_error if the data is malformed or unrecognized.
  */
 pmtv::pmt deserialize_from_legacy(const uint8_t* data, size_t size);
 
+/**
+ * Length in bytes of the legacy message at the start of data, found by
+ * walking its tags without decoding any values. Used to split captures of
+ * back-to-back messages. Throws std::runtime_error if the message is
+ * malformed or runs past size.
+ */
+size_t legacy_encoded_size(const uint8_t* data, size_t size);
+
 } // namespace legacy_pmt
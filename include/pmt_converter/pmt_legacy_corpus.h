@@ -0,0 +1,63 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace legacy_pmt {
+
+/**
+ * Deterministic generator of legacy message mixes for performance work and
+ * fuzz-style round-trip tests. Messages are encoded directly on the wire
+ * format, so shapes the generic codec cannot produce (PDU pairs, see
+ * pmt_legacy_pdu.h) are included. The same options give byte-identical
+ * corpora on every platform: the generator uses its own integer-only random
+ * source, no <random> or libm.
+ */
+enum class corpus_kind : uint8_t {
+    tag_dict,    // flat stream-tag dict of scalars and symbols
+    pdu_u8,      // PAIR(metadata dict, u8 vector), a GR3 byte PDU
+    pdu_c32,     // PAIR(metadata dict, c32 vector), a GR3 sample PDU
+    c32_burst,   // bare c32 uniform vector
+    nested_dict, // dicts nested inside dicts
+};
+
+inline constexpr size_t corpus_kind_count = 5;
+
+const char* corpus_kind_name(corpus_kind kind);
+
+/** Inclusive range, sampled log-uniformly so small values dominate as in real traffic. */
+struct size_range {
+    size_t min;
+    size_t max;
+};
+
+// Tag dicts draw distinct keys from a fixed set of GR3 tag names
+inline constexpr size_t corpus_max_tag_entries = 12;
+
+struct corpus_options {
+    uint64_t seed = 1;
+    size_t messages = 10000;
+    // Relative frequency of each kind, indexed by corpus_kind
+    std::array<uint32_t, corpus_kind_count> weights = {60, 15, 10, 10, 5};
+    // At most corpus_max_tag_entries
+    size_range tag_entries = {2, 8};
+    size_range pdu_bytes = {64, 1500};
+    size_range pdu_samples = {64, 2048};
+    size_range burst_samples = {256, 16384};
+    size_range nesting_depth = {2, 8};
+};
+
+struct corpus_message {
+    corpus_kind kind;
+    std::vector<uint8_t> bytes;
+};
+
+/**
+ * Throws std::invalid_argument if all weights are zero, a range has min > max
+ * or tag_entries.max exceeds corpus_max_tag_entries.
+ */
+std::vector<corpus_message> generate_legacy_corpus(const corpus_options& opts = {});
+
+} // namespace legacy_pmt
@@ -0,0 +1,72 @@
+#pragma once
+
+#include <pmtv/pmt.hpp>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+namespace legacy_pmt {
+
+/**
+ * Opt-in deduplicated encoding for messages that repeat identical subtrees,
+ * e.g. the same calibration dict under many keys. Layout:
+ *
+ *   'L' 'P' 'R' version | legacy body with DEF/REF extension tags
+ *
+ * The body is the plain legacy encoding, except that the first copy of a
+ * repeated subtree is prefixed with a DEF tag and every later copy is replaced
+ * by a 5-byte REF to it. GR3 cannot read this; use strict mode or
+ * expand_deduplicated() for legacy peers.
+ */
+inline constexpr size_t dedup_header_size = 4;
+
+/**
+ * Default bound on the decoded size of a deduplicated message, as a multiple
+ * of its encoded size. Nested references can double the decoded size at every
+ * level, so decoders track the expanded size against this bound instead of
+ * trusting the message.
+ */
+inline constexpr size_t dedup_max_expansion = 256;
+
+namespace detail {
+
+    inline size_t dedup_expansion_limit(size_t size, size_t max_expansion) {
+        if (max_expansion != 0 && size > std::numeric_limits<size_t>::max() / max_expansion)
+            return std::numeric_limits<size_t>::max();
+        return size * max_expansion;
+    }
+
+} // namespace detail
+
+struct dedup_options {
+    // Subtrees whose plain encoding is shorter than this are always written
+    // out; a reference costs 5 bytes plus 1 for the DEF marker
+    size_t min_subtree_bytes = 16;
+    // Emit plain legacy bytes (no header, no references) for GR3 peers
+    bool strict = false;
+};
+
+/** True if data starts with a deduplicated-encoding header. */
+bool is_deduplicated(const uint8_t* data, size_t size);
+
+std::vector<uint8_t> serialize_deduplicated(const pmtv::pmt& obj, const dedup_options& opts = {});
+
+/**
+ * Decode a deduplicated message, or a plain legacy one. Referenced subtrees
+ * are decoded once and copied, since pmtv::pmt has value semantics. Throws
+ * std::runtime_error on malformed input, including references to nodes that
+ * are not complete yet, and if the message would expand to more than
+ * max_expansion times its size.
+ */
+pmtv::pmt deserialize_deduplicated(const uint8_t* data, size_t size, size_t max_expansion = dedup_max_expansion);
+
+/**
+ * Rewrite a deduplicated message as plain legacy bytes, byte-identical to
+ * serialize_to_legacy() of the same value, without decoding it. Plain
+ * legacy input is returned unchanged. Throws std::runtime_error under the
+ * same conditions as deserialize_deduplicated().
+ */
+std::vector<uint8_t> expand_deduplicated(const uint8_t* data, size_t size,
+                                         size_t max_expansion = dedup_max_expansion);
+
+} // namespace legacy_pmt
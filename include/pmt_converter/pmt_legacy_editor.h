@@ -0,0 +1,113 @@
+#pragma once
+
+#include <pmt_converter/pmt_legacy_format.h>
+#include <pmtv/pmt.hpp>
+
+#include <concepts>
+#include <cstdint>
+#include <initializer_list>
+#include <optional>
+#include <span>
+#include <string_view>
+#include <vector>
+
+namespace legacy_pmt {
+
+/** Location of one encoded value inside a legacy message. */
+struct legacy_value_ref {
+    size_t offset;
+    size_t size;
+    legacy_tag tag;
+};
+
+template <typename T>
+concept legacy_scalar = std::same_as<T, bool> || std::same_as<T, int32_t> || std::same_as<T, int64_t> ||
+                        std::same_as<T, double>;
+
+/**
+ * Edits an encoded legacy message without decoding it, e.g. to bump a
+ * sequence number or rx_time in a tag dict before forwarding.
+ *
+ * Values are addressed by a path of dict keys, outermost first; an empty path
+ * is the whole message. A new value with the same encoded size as the old one
+ * (same-type INT32/INT64/DOUBLE/bool) is overwritten in place. Otherwise the
+ * rest of the message is moved with a single memmove; that needs an editor
+ * over a std::vector, a fixed span throws std::length_error instead.
+ *
+ * Offsets returned by find() are invalidated by size-changing edits. Only
+ * plain legacy encodings are supported, not framed, enveloped or
+ * deduplicated ones. Malformed messages throw std::runtime_error.
+ */
+class legacy_editor {
+public:
+    using key_path = std::span<const std::string_view>;
+
+    /** Edit a message of fixed size, e.g. in place in a receive buffer. */
+    explicit legacy_editor(std::span<uint8_t> message) : _data(message.data()), _size(message.size()) {}
+
+    /** Edit a message that may grow or shrink. */
+    explicit legacy_editor(std::vector<uint8_t>& message)
+        : _data(message.data()), _size(message.size()), _growable(&message) {}
+
+    std::span<const uint8_t> bytes() const { return {_data, _size}; }
+
+    /** The value under path, or nullopt if a key is missing or not inside a dict. */
+    std::optional<legacy_value_ref> find(key_path path) const;
+    std::optional<legacy_value_ref> find(std::initializer_list<std::string_view> path) const {
+        return find(key_path(path.begin(), path.size()));
+    }
+
+    /** Decode only the value under path. */
+    std::optional<pmtv::pmt> get(key_path path) const;
+    std::optional<pmtv::pmt> get(std::initializer_list<std::string_view> path) const {
+        return get(key_path(path.begin(), path.size()));
+    }
+
+    /**
+     * Replace the value under path. Returns false, leaving the message
+     * untouched, if there is no such value.
+     */
+    template <legacy_scalar T>
+    bool set(key_path path, T value) {
+        uint8_t encoded[9];
+        return replace(path, encoded, encode_scalar(value, encoded));
+    }
+    template <legacy_scalar T>
+    bool set(std::initializer_list<std::string_view> path, T value) {
+        return set(key_path(path.begin(), path.size()), value);
+    }
+
+    /** Replace the value under path with any value the legacy codec can encode. */
+    bool set(key_path path, const pmtv::pmt& value);
+    bool set(std::initializer_list<std::string_view> path, const pmtv::pmt& value) {
+        return set(key_path(path.begin(), path.size()), value);
+    }
+
+    /** Replace the value under path with already encoded legacy bytes. */
+    bool replace(key_path path, const uint8_t* encoded, size_t size);
+
+private:
+    template <legacy_scalar T>
+    static size_t encode_scalar(T value, uint8_t* out) {
+        uint8_t* ptr = out;
+        if constexpr (std::same_as<T, bool>) {
+            write_u8(ptr, static_cast<uint8_t>(value ? legacy_tag::LEGACY_PMT_TRUE : legacy_tag::LEGACY_PMT_FALSE));
+        } else if constexpr (std::same_as<T, int32_t>) {
+            write_u8(ptr, static_cast<uint8_t>(legacy_tag::LEGACY_PMT_INT32));
+            write_u32(ptr, static_cast<uint32_t>(value));
+        } else if constexpr (std::same_as<T, int64_t>) {
+            write_u8(ptr, static_cast<uint8_t>(legacy_tag::LEGACY_PMT_INT64));
+            write_u64(ptr, static_cast<uint64_t>(value));
+        } else {
+            write_u8(ptr, static_cast<uint8_t>(legacy_tag::LEGACY_PMT_DOUBLE));
+            write_double(ptr, value);
+        }
+        return static_cast<size_t>(ptr - out);
+    }
+
+    uint8_t* _data;
+    size_t _size;
+    std::vector<uint8_t>* _growable = nullptr;
+};
+
+} // namespace legacy_pmt
@@ -0,0 +1,123 @@
+#pragma once
+
+#include <pmtv/pmt.hpp>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+namespace legacy_pmt {
+
+/**
+ * Optional compressed envelope around a legacy-encoded PMT, for links where
+ * bandwidth matters more than CPU. Layout (all integers big endian):
+ *
+ *   'L' 'P' 'Z' version | codec u8 | filter u8 | reserved u16 | legacy size u64 | body
+ *
+ * The body is the legacy encoding, optionally preconditioned by the filter and
+ * compressed by the codec. Plain GR3 peers cannot read envelopes; unwrap them
+ * with unwrap_envelope() before forwarding.
+ */
+enum class envelope_codec : uint8_t {
+    none = 0x00, // stored, only the filter is applied
+    zstd = 0x01,
+};
+
+enum class envelope_filter : uint8_t {
+    none = 0x00,
+    // Uniform vector payload regrouped into byte planes of its scalar width
+    // (4 for F32/C32, 8 for F64/C64, ...), which compresses far better for
+    // sampled data whose exponent and sign bytes change slowly
+    byte_shuffle = 0x01,
+};
+
+inline constexpr size_t envelope_header_size = 16;
+
+/**
+ * Largest legacy size a decoder accepts by default. The size in the header is
+ * not authenticated, so it is checked against this before any memory is
+ * committed to the message.
+ */
+inline constexpr size_t default_envelope_max_raw_size = size_t{256} << 20;
+
+struct envelope_options {
+    envelope_codec codec = envelope_codec::zstd;
+    int level = 1;
+    // Shuffle uniform vectors with multi-byte elements; ignored for other messages
+    bool shuffle = true;
+};
+
+/** True if this build was compiled with support for codec. */
+bool envelope_codec_available(envelope_codec codec);
+
+/** True if data starts with an envelope header. */
+bool is_envelope(const uint8_t* data, size_t size);
+
+/**
+ * Wrap an existing legacy encoding. Throws std::runtime_error if the
+ * requested codec is not available in this build.
+ */
+std::vector<uint8_t> wrap_envelope(const uint8_t* legacy, size_t size, const envelope_options& opts = {});
+
+std::vector<uint8_t> serialize_to_envelope(const pmtv::pmt& obj, const envelope_options& opts = {});
+
+/**
+ * Recover the plain legacy encoding, e.g. for forwarding to GR3 peers. Throws
+ * std::runtime_error if the envelope declares more than max_raw_size bytes.
+ */
+std::vector<uint8_t> unwrap_envelope(const uint8_t* data, size_t size,
+                                     size_t max_raw_size = default_envelope_max_raw_size);
+
+pmtv::pmt deserialize_from_envelope(const uint8_t* data, size_t size,
+                                    size_t max_raw_size = default_envelope_max_raw_size);
+
+/**
+ * Incremental decoder for envelopes arriving in pieces (socket reads, file
+ * chunks). Each piece is decompressed as it is fed, straight into the buffer
+ * that is decoded at the end, so the compressed message never has to be
+ * reassembled first. The buffer grows as the body decodes, up to the declared
+ * size, and an envelope declaring more than max_raw_size bytes is rejected
+ * with std::runtime_error as soon as its header arrives.
+ */
+class envelope_decoder {
+public:
+    explicit envelope_decoder(size_t max_raw_size = default_envelope_max_raw_size);
+    ~envelope_decoder();
+    envelope_decoder(const envelope_decoder&) = delete;
+    envelope_decoder& operator=(const envelope_decoder&) = delete;
+
+    /**
+     * Consume up to size bytes of the current envelope. Returns the number of
+     * bytes consumed; anything left over belongs to the next envelope.
+     */
+    size_t feed(const uint8_t* data, size_t size);
+
+    /** True once a whole envelope has been fed. */
+    bool complete() const { return _state == state::complete; }
+
+    /** Plain legacy bytes of the completed message. */
+    std::span<const uint8_t> legacy_bytes() const;
+
+    /** Decode the completed message and get ready for the next one. */
+    pmtv::pmt take();
+
+    void reset();
+
+private:
+    enum class state { header, body, complete };
+
+    void finish_body();
+
+    state _state = state::header;
+    uint8_t _header[envelope_header_size];
+    size_t _header_fill = 0;
+    envelope_codec _codec = envelope_codec::none;
+    envelope_filter _filter = envelope_filter::none;
+    size_t _max_raw_size;
+    std::vector<uint8_t> _raw;
+    size_t _raw_size = 0; // declared in the header
+    size_t _raw_fill = 0;
+    bool _frame_checked = false;
+    void* _zstd = nullptr;
+};
+
+} // namespace legacy_pmt
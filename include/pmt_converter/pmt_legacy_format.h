@@ -0,0 +1,377 @@
+#pragma once
+
+#include <algorithm>
+#include <bit>
+#include <complex>
+#include <cstdint>
+#include <cstring>
+#include <span>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+// Wire-level building blocks of the legacy GNU Radio PMT binary format, shared
+// by the generic codec and the specialized encoders built on top of it.
+
+namespace legacy_pmt {
+
+enum class legacy_tag : uint8_t {
+    LEGACY_PMT_TRUE = 0x00,
+    LEGACY_PMT_FALSE = 0x01,
+    LEGACY_PMT_SYMBOL = 0x02,
+    LEGACY_PMT_INT32 = 0x03,
+    LEGACY_PMT_DOUBLE = 0x04,
+    LEGACY_PMT_COMPLEX = 0x05,
+    LEGACY_PMT_NULL = 0x06,
+    LEGACY_PMT_PAIR = 0x07,
+    LEGACY_PMT_VECTOR = 0x08,
+    LEGACY_PMT_DICT = 0x09,    
+    LEGACY_PMT_UNIFORM_VECTOR = 0x0A,
+    LEGACY_PMT_UINT64 = 0x0B,
+    LEGACY_PMT_TUPLE = 0x0C,
+    LEGACY_PMT_INT64 = 0x0D,
+
+    // Extensions of the deduplicated encoding (pmt_legacy_dedup.h); GR3 does
+    // not know these and must only ever see expanded messages
+    LEGACY_PMT_DEF = 0x40, // the next node may be referenced later
+    LEGACY_PMT_REF = 0x41, // u32 index of an earlier DEF node, in order of appearance
+};
+
+enum class legacy_uniform_type : uint8_t {
+    U8 = 0x00,
+    S8 = 0x01,
+    U16 = 0x02,
+    S16 = 0x03,
+    U32 = 0x04,
+    S32 = 0x05,
+    U64 = 0x06,
+    S64 = 0x07,
+    F32 = 0x08,
+    F64 = 0x09,    
+    C32 = 0x0A,
+    C64 = 0x0B,
+    UNKNOWN = 0xFF
+};
+
+inline void write_u8(uint8_t*& out, uint8_t v) {
+    *out++ = v;
+}
+
+inline void write_u16(uint8_t*& out, uint32_t v) {
+    for (int i = 1; i >= 0; --i)
+        *out++ = (v >> (i * 8)) & 0xFF;
+}
+
+inline void write_u32(uint8_t*& out, uint32_t v) {
+    for (int i = 3; i >= 0; --i)
+        *out++ = (v >> (i * 8)) & 0xFF;
+}
+
+inline void write_u64(uint8_t*& out, uint64_t v) {
+    for (int i = 7; i >= 0; --i)
+        *out++ = (v >> (i * 8)) & 0xFF;
+}
+
+inline void write_double(uint8_t*& out, double d) {
+    uint64_t bits;
+    std::memcpy(&bits, &d, sizeof(double));
+    write_u64(out, bits);
+}
+
+inline void write_symbol(uint8_t*& out, std::string_view sym) {
+    write_u8(out, static_cast<uint8_t>(legacy_tag::LEGACY_PMT_SYMBOL));
+    write_u16(out, static_cast<uint32_t>(sym.size()));
+    std::memcpy(out, sym.data(), sym.size());
+    out += sym.size();
+}
+
+inline uint64_t read_u32(const uint8_t*& data) {
+    uint64_t result = 0;
+    for (int i = 0; i < 4; ++i) {
+        result = (result << 8) | data[i];
+    }
+    data += 4;
+    return result;
+}
+
+inline uint64_t read_u64(const uint8_t*& data) {
+    uint64_t result = 0;
+    for (int i = 0; i < 8; ++i) {
+        result = (result << 8) | data[i];
+    }
+    data += 8;
+    return result;
+}
+
+inline double read_double(const uint8_t*& data) {
+    uint64_t bits = read_u64(data);
+    double d;
+    std::memcpy(&d, &bits, sizeof(double));
+    return d;
+}
+
+// Deepest nesting of containers a decoder accepts. Decoding recurses once per
+// level, so untrusted input must not choose the depth; GR3 messages nest a
+// handful of levels
+inline constexpr size_t legacy_max_depth = 1024;
+
+// Tag byte + u16 length + characters
+inline constexpr size_t symbol_header_size = 1 + 2;
+// Tag byte + dtype byte + u32 length + npad byte + 1 pad byte
+inline constexpr size_t uniform_vector_header_size = 1 + 1 + 4 + 1 + 1;
+
+// Shape extension: the padding of a uniform vector, which GR3 skips, may
+// carry the extents of a multi-dimensional tensor. The u32 length still holds
+// the total element count, so GR3 sees the flat row-major data. Pad bytes:
+//   'S' | rank u8 | reserved u16 | rank x u32 extent, outermost first
+inline constexpr uint8_t uniform_shape_marker = 'S';
+inline constexpr size_t uniform_shape_max_rank = (255 - 4) / 4;
+
+constexpr size_t uniform_shape_pad_size(size_t rank) {
+    return 4 + 4 * rank;
+}
+
+// Header size of a uniform vector of the given rank; only rank > 1 carries a shape
+constexpr size_t uniform_vector_header_size_for(size_t rank) {
+    return rank > 1 ? uniform_vector_header_size - 1 + uniform_shape_pad_size(rank) : uniform_vector_header_size;
+}
+
+// count and the extents must fit the u32 fields; encoders check this when sizing
+inline void write_uniform_vector_header(uint8_t*& out, legacy_uniform_type dtype, size_t count,
+                                        std::span<const size_t> extents = {}) {
+    write_u8(out, static_cast<uint8_t>(legacy_tag::LEGACY_PMT_UNIFORM_VECTOR));
+    write_u8(out, static_cast<uint8_t>(dtype));
+    write_u32(out, static_cast<uint32_t>(count));
+    if (extents.size() > 1) {
+        write_u8(out, static_cast<uint8_t>(uniform_shape_pad_size(extents.size())));
+        write_u8(out, uniform_shape_marker);
+        write_u8(out, static_cast<uint8_t>(extents.size()));
+        write_u16(out, 0);
+        for (size_t e : extents)
+            write_u32(out, static_cast<uint32_t>(e));
+    } else {
+        // Padding
+        write_u8(out, 1);
+        write_u8(out, 0);
+    }
+}
+
+// Bytes per element of a uniform vector, 0 for an unknown dtype
+constexpr size_t legacy_uniform_element_size(legacy_uniform_type dtype) {
+    switch (dtype) {
+        case legacy_uniform_type::U8: case legacy_uniform_type::S8: return 1;
+        case legacy_uniform_type::U16: case legacy_uniform_type::S16: return 2;
+        case legacy_uniform_type::U32: case legacy_uniform_type::S32: case legacy_uniform_type::F32: return 4;
+        case legacy_uniform_type::U64: case legacy_uniform_type::S64: case legacy_uniform_type::F64:
+        case legacy_uniform_type::C32: return 8;
+        case legacy_uniform_type::C64: return 16;
+        default: return 0;
+    }
+}
+
+template <typename T>
+constexpr legacy_uniform_type legacy_uniform_type_for() {
+    if constexpr (std::is_same_v<T, uint8_t>) return legacy_uniform_type::U8;
+    else if constexpr (std::is_same_v<T, int8_t>) return legacy_uniform_type::S8;
+    else if constexpr (std::is_same_v<T, uint16_t>) return legacy_uniform_type::U16;
+    else if constexpr (std::is_same_v<T, int16_t>) return legacy_uniform_type::S16;
+    else if constexpr (std::is_same_v<T, uint32_t>) return legacy_uniform_type::U32;
+    else if constexpr (std::is_same_v<T, int32_t>) return legacy_uniform_type::S32;
+    else if constexpr (std::is_same_v<T, uint64_t>) return legacy_uniform_type::U64;
+    else if constexpr (std::is_same_v<T, int64_t>) return legacy_uniform_type::S64;
+    else if constexpr (std::is_same_v<T, float>) return legacy_uniform_type::F32;
+    else if constexpr (std::is_same_v<T, double>) return legacy_uniform_type::F64;
+    else if constexpr (std::is_same_v<T, std::complex<float>>) return legacy_uniform_type::C32;
+    else if constexpr (std::is_same_v<T, std::complex<double>>) return legacy_uniform_type::C64;
+    else return legacy_uniform_type::UNKNOWN;
+}
+
+
+
+// Helper function to swap bytes if necessary
+template <typename T>
+requires std::is_integral_v<T> && (!std::is_same_v<T, bool>) // Ensure it's an integral type, but not bool
+T to_big_endian_integral(T value) {
+    if constexpr (std::endian::native == std::endian::little) {
+        if constexpr (sizeof(T) == 1) {
+            return value; // Single byte, no swap needed
+        } else if constexpr (sizeof(T) == 2) {
+            return static_cast<T>(
+                ((static_cast<uint16_t>(value) & 0xFF00) >> 8) |
+                ((static_cast<uint16_t>(value) & 0x00FF) << 8)
+            );
+        } else if constexpr (sizeof(T) == 4) {
+            return static_cast<T>(
+                ((static_cast<uint32_t>(value) & 0xFF000000) >> 24) |
+                ((static_cast<uint32_t>(value) & 0x00FF0000) >> 8) |
+                ((static_cast<uint32_t>(value) & 0x0000FF00) << 8) |
+                ((static_cast<uint32_t>(value) & 0x000000FF) << 24)
+            );
+        } else if constexpr (sizeof(T) == 8) {
+            uint64_t u64_val = static_cast<uint64_t>(value);
+            return static_cast<T>(
+                ((u64_val & 0xFF00000000000000ULL) >> 56) |
+                ((u64_val & 0x00FF000000000000ULL) >> 40) |
+                ((u64_val & 0x0000FF0000000000ULL) >> 24) |
+                ((u64_val & 0x000000FF00000000ULL) >> 8)  |
+                ((u64_val & 0x00000000FF000000ULL) << 8)  |
+                ((u64_val & 0x0000000000FF0000ULL) << 24) |
+                ((u64_val & 0x000000000000FF00ULL) << 40) |
+                ((u64_val & 0x00000000000000FFULL) << 56)
+            );
+        } else {
+            // Generic byte swap for other integral sizes (less efficient but works)
+            std::vector<uint8_t> bytes(sizeof(T));
+            std::memcpy(bytes.data(), &value, sizeof(T));
+            std::reverse(bytes.begin(), bytes.end());
+            T result;
+            std::memcpy(&result, bytes.data(), sizeof(T));
+            return result;
+        }
+    }
+    return value; // No swap needed if native is big-endian
+}
+
+
+
+// Function to serialize any trivially copyable type to big-endian bytes
+template <typename T>
+requires std::is_trivially_copyable_v<T>
+void serialize_to_big_endian(const T& value, uint8_t*& out) {
+    if constexpr (std::is_integral_v<T> && !std::is_same_v<T, bool>) {
+        // Handle integral types directly
+        T big_endian_val = to_big_endian_integral(value);
+        std::memcpy(out, &big_endian_val, sizeof(T));
+        out += sizeof(T);
+    } else if constexpr (std::is_floating_point_v<T>) {
+        // Handle floating-point types (float, double, long double)
+        // Use std::bit_cast to treat float as an integer of the same size
+        if constexpr (sizeof(T) == sizeof(uint32_t)) { // For float
+            uint32_t big_endian_int = to_big_endian_integral(std::bit_cast<uint32_t>(value));
+            std::memcpy(out, &big_endian_int, sizeof(uint32_t));
+            out += sizeof(uint32_t);
+        } else if constexpr (sizeof(T) == sizeof(uint64_t)) { // For double
+            uint64_t big_endian_int = to_big_endian_integral(std::bit_cast<uint64_t>(value));
+            std::memcpy(out, &big_endian_int, sizeof(uint64_t));
+            out += sizeof(uint64_t);
+        } else {
+            // The legacy format has no wire form for other sizes (e.g. long double)
+            static_assert(sizeof(T) == 0, "Unsupported floating point size for legacy serialization");
+        }
+    } else if constexpr (std::is_same_v<T, std::complex<float>>) {
+        serialize_to_big_endian(value.real(), out);
+        serialize_to_big_endian(value.imag(), out);
+    } else if constexpr (std::is_same_v<T, std::complex<double>>) {
+        serialize_to_big_endian(value.real(), out);
+        serialize_to_big_endian(value.imag(), out);
+    }
+    else {
+        // For other trivially copyable types where byte order isn't a concern
+        // or you don't need to swap them (e.g., char, uint8_t, or just raw memory dump)
+        std::memcpy(out, &value, sizeof(T));
+        out += sizeof(T);
+    }
+}
+
+
+
+template <typename T>
+requires std::is_integral_v<T> && (!std::is_same_v<T, bool>)
+T from_big_endian_integral_to_native(T value) {
+    if constexpr (std::endian::native == std::endian::little) {
+        if constexpr (sizeof(T) == 1) {
+            return value; // Single byte, no swap needed
+        } else if constexpr (sizeof(T) == 2) {
+            return static_cast<T>(
+                ((static_cast<uint16_t>(value) & 0xFF00) >> 8) |
+                ((static_cast<uint16_t>(value) & 0x00FF) << 8)
+            );
+        } else if constexpr (sizeof(T) == 4) {
+            return static_cast<T>(
+                ((static_cast<uint32_t>(value) & 0xFF000000) >> 24) |
+                ((static_cast<uint32_t>(value) & 0x00FF0000) >> 8) |
+                ((static_cast<uint32_t>(value) & 0x0000FF00) << 8) |
+                ((static_cast<uint32_t>(value) & 0x000000FF) << 24)
+            );
+        } else if constexpr (sizeof(T) == 8) {
+            uint64_t u64_val = static_cast<uint64_t>(value);
+            return static_cast<T>(
+                ((u64_val & 0xFF00000000000000ULL) >> 56) |
+                ((u64_val & 0x00FF000000000000ULL) >> 40) |
+                ((u64_val & 0x0000FF0000000000ULL) >> 24) |
+                ((u64_val & 0x000000FF00000000ULL) >> 8)  |
+                ((u64_val & 0x00000000FF000000ULL) << 8)  |
+                ((u64_val & 0x0000000000FF0000ULL) << 24) |
+                ((u64_val & 0x000000000000FF00ULL) << 40) |
+                ((u64_val & 0x00000000000000FFULL) << 56)
+            );
+        } else {
+            // Generic byte swap for other integral sizes
+            std::vector<uint8_t> bytes(sizeof(T));
+            std::memcpy(bytes.data(), &value, sizeof(T));
+            std::reverse(bytes.begin(), bytes.end()); // Reverse to convert big-endian to native
+            T result;
+            std::memcpy(&result, bytes.data(), sizeof(T));
+            return result;
+        }
+    }
+    return value; // No swap needed if native is big-endian
+}
+
+
+// Function to deserialize from a big-endian byte stream into a single object of type T
+template <typename T>
+requires std::is_trivially_copyable_v<T>
+T deserialize_from_big_endian(const uint8_t*& ptr) { // ptr is passed by reference to advance it
+    T result;
+
+    if constexpr (std::is_integral_v<T> && !std::is_same_v<T, bool>) {
+        // Read bytes directly into an integral variable
+        T temp_val;
+        std::memcpy(&temp_val, ptr, sizeof(T));
+        result = from_big_endian_integral_to_native(temp_val);
+    } else if constexpr (std::is_floating_point_v<T>) {
+        // Use std::bit_cast for floating-point types
+        if constexpr (sizeof(T) == sizeof(uint32_t)) { // For float
+            uint32_t int_repr;
+            std::memcpy(&int_repr, ptr, sizeof(uint32_t));
+            uint32_t native_endian_int = from_big_endian_integral_to_native(int_repr);
+            result = std::bit_cast<T>(native_endian_int);
+        } else if constexpr (sizeof(T) == sizeof(uint64_t)) { // For double
+            uint64_t int_repr;
+            std::memcpy(&int_repr, ptr, sizeof(uint64_t));
+            uint64_t native_endian_int = from_big_endian_integral_to_native(int_repr);
+            result = std::bit_cast<T>(native_endian_int);
+        } else {
+            static_assert(sizeof(T) == 0, "Unsupported floating point size for legacy deserialization");
+        }
+    } else if constexpr (std::is_same_v<T, std::complex<float>>) {
+        // Deserialize real and imaginary parts separately
+        float real_part = deserialize_from_big_endian<float>(ptr);
+        float imag_part = deserialize_from_big_endian<float>(ptr);
+        result = std::complex<float>(real_part, imag_part);
+        // Important: ptr was advanced by inner calls, so we don't advance it again here.
+        return result; // Return early because ptr is already advanced
+    } else if constexpr (std::is_same_v<T, std::complex<double>>) {
+        // Deserialize real and imaginary parts separately
+        double real_part = deserialize_from_big_endian<double>(ptr);
+        double imag_part = deserialize_from_big_endian<double>(ptr);
+        result = std::complex<double>(real_part, imag_part);
+        // Important: ptr was advanced by inner calls, so we don't advance it again here.
+        return result; // Return early
+    }
+    // For other trivially copyable types (e.g., structs that are themselves flat byte representations
+    // and don't need internal member endian conversion), just copy directly.
+    // If a struct has internal members that require endian conversion, you'd need to
+    // deserialize each member individually.
+    else {
+        // Default: just copy the bytes directly
+        std::memcpy(&result, ptr, sizeof(T));
+    }
+
+    // Advance the pointer for the next read, unless it's handled by recursive calls
+    ptr += sizeof(T);
+    return result;
+}
+
+} // namespace legacy_pmt
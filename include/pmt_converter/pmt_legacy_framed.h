@@ -0,0 +1,50 @@
+#pragma once
+
+#include <pmtv/pmt.hpp>
+#include <cstdint>
+#include <stdexcept>
+#include <vector>
+
+namespace legacy_pmt {
+
+/**
+ * Optional framed mode: a legacy-encoded PMT with a length prefix and a
+ * CRC32C trailer (all integers big endian):
+ *
+ *   'L' 'P' 'F' version | payload size u32 | legacy payload | crc32c(payload) u32
+ *
+ * The checksum is accumulated while the payload is written and checked in the
+ * same pass that decodes it; large uniform vectors are checksummed block by
+ * block right next to their byte swap, so integrity costs no extra pass over
+ * memory.
+ */
+inline constexpr size_t frame_header_size = 8;
+inline constexpr size_t frame_trailer_size = 4;
+
+/** Thrown when a frame fails its length or checksum verification. */
+class legacy_integrity_error : public std::runtime_error {
+public:
+    using std::runtime_error::runtime_error;
+};
+
+/** CRC32C (Castagnoli), continuing from crc; hardware accelerated where available. */
+uint32_t crc32c(const uint8_t* data, size_t size, uint32_t crc = 0);
+
+/** CRC32C of A||B given crc32c(A), crc32c(B) and the length of B. */
+uint32_t crc32c_combine(uint32_t crc_a, uint32_t crc_b, size_t size_b);
+
+size_t framed_size(const pmtv::pmt& obj);
+
+std::vector<uint8_t> serialize_framed(const pmtv::pmt& obj);
+
+/** Throws std::length_error if capacity is smaller than framed_size(obj). */
+size_t serialize_framed(const pmtv::pmt& obj, uint8_t* out, size_t capacity);
+
+/**
+ * Decode a frame produced by serialize_framed(). Throws legacy_integrity_error
+ * if the frame is truncated or its checksum does not match, even when the
+ * corruption also made the payload undecodable.
+ */
+pmtv::pmt deserialize_framed(const uint8_t* data, size_t size);
+
+} // namespace legacy_pmt
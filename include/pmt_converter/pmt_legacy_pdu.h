@@ -0,0 +1,146 @@
+#pragma once
+
+#include <pmt_converter/pmt_legacy_format.h>
+#include <pmtv/pmt.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace legacy_pmt {
+
+/**
+ * GR3 PDUs: a legacy PAIR whose car is the metadata dict (or NULL when there
+ * is none) and whose cdr is a uniform vector. The generic codec has no pairs;
+ * these functions encode and decode the PDU shape directly to and from a
+ * (pmtv::map_t, pmtv::Tensor<T>) pair, sizing the message once and copying
+ * the payload as one block.
+ */
+
+namespace detail {
+
+    struct pdu_payload {
+        const uint8_t* data;
+        legacy_uniform_type dtype;
+        size_t count;
+        std::span<const size_t> extents;
+    };
+
+    template <typename T>
+    pdu_payload erase_payload(const pmtv::Tensor<T>& data) {
+        static_assert(legacy_uniform_type_for<T>() != legacy_uniform_type::UNKNOWN,
+                      "No legacy uniform vector type for this element type");
+        const auto& extents = data.extents();
+        return {reinterpret_cast<const uint8_t*>(data.data()), legacy_uniform_type_for<T>(), data.size(),
+                {extents.data(), extents.size()}};
+    }
+
+    size_t pdu_size(const pmtv::map_t& meta, const pdu_payload& payload);
+    size_t serialize_pdu(const pmtv::map_t& meta, const pdu_payload& payload, uint8_t* out, size_t capacity);
+
+    // Decoded metadata and the location of the still encoded payload
+    struct parsed_pdu {
+        pmtv::map_t meta;
+        legacy_uniform_type dtype;
+        size_t count;
+        std::vector<size_t> extents;
+        const uint8_t* payload;
+    };
+
+    parsed_pdu parse_pdu(const uint8_t* data, size_t size);
+    void decode_pdu_payload(const parsed_pdu& pdu, uint8_t* out);
+
+} // namespace detail
+
+/**
+ * Number of bytes serialize_pdu() produces. Throws std::runtime_error if a
+ * metadata value has no legacy representation.
+ */
+template <typename T>
+size_t legacy_pdu_size(const pmtv::map_t& meta, const pmtv::Tensor<T>& data) {
+    return detail::pdu_size(meta, detail::erase_payload(data));
+}
+
+/**
+ * Encode (meta, data) as a legacy PDU into a caller-provided buffer and return
+ * the number of bytes written. An empty meta is written as NULL, as GR3 does.
+ * Throws std::length_error if capacity is smaller than legacy_pdu_size().
+ */
+template <typename T>
+size_t serialize_pdu(const pmtv::map_t& meta, const pmtv::Tensor<T>& data, uint8_t* out, size_t capacity) {
+    return detail::serialize_pdu(meta, detail::erase_payload(data), out, capacity);
+}
+
+template <typename T>
+std::vector<uint8_t> serialize_pdu(const pmtv::map_t& meta, const pmtv::Tensor<T>& data) {
+    auto payload = detail::erase_payload(data);
+    std::vector<uint8_t> out(detail::pdu_size(meta, payload));
+    detail::serialize_pdu(meta, payload, out.data(), out.size());
+    return out;
+}
+
+/** True if data starts with the PDU shape, without decoding it. */
+bool is_legacy_pdu(const uint8_t* data, size_t size);
+
+/**
+ * Decode a legacy PDU whose payload holds T elements. Throws
+ * std::runtime_error if the message is malformed, is not a PDU, or carries a
+ * different payload type.
+ */
+template <typename T>
+std::pair<pmtv::map_t, pmtv::Tensor<T>> deserialize_pdu(const uint8_t* data, size_t size) {
+    detail::parsed_pdu pdu = detail::parse_pdu(data, size);
+    if (pdu.dtype != legacy_uniform_type_for<T>())
+        throw std::runtime_error("Legacy PDU payload type " + std::to_string(static_cast<int>(pdu.dtype)) +
+                                 " does not match the requested type");
+    std::vector<T> vec(pdu.count);
+    detail::decode_pdu_payload(pdu, reinterpret_cast<uint8_t*>(vec.data()));
+    pmtv::Tensor<T> tensor(std::move(vec));
+    if (pdu.extents.size() > 1)
+        tensor.reshape(pdu.extents);
+    return {std::move(pdu.meta), std::move(tensor)};
+}
+
+/** Decode a legacy PDU of any payload type; the second member holds the Tensor. */
+std::pair<pmtv::map_t, pmtv::pmt> deserialize_pdu(const uint8_t* data, size_t size);
+
+/** Encode a PDU whose payload is a Tensor held in a pmtv::pmt, as deserialize_pdu() returns it. */
+std::vector<uint8_t> serialize_pdu(const pmtv::map_t& meta, const pmtv::pmt& data);
+
+/**
+ * Reusable PDU encoder for a stream of messages that share their metadata
+ * keys. The DICT PAIR SYMBOL prefix of every key is encoded once and copied
+ * into later messages while the key set stays the same; a new key set
+ * replaces the cache. Messages are written into a buffer owned by the
+ * encoder, so steady-state encoding does not allocate.
+ */
+class pdu_encoder {
+public:
+    /** The returned bytes stay valid until the next encode(). */
+    template <typename T>
+    std::span<const uint8_t> encode(const pmtv::map_t& meta, const pmtv::Tensor<T>& data) {
+        return encode_erased(meta, detail::erase_payload(data));
+    }
+
+    /** Payload held in a pmtv::pmt; throws std::runtime_error if it is not a Tensor. */
+    std::span<const uint8_t> encode(const pmtv::map_t& meta, const pmtv::pmt& data);
+
+    /** Number of times the key cache was rebuilt, for tests and benchmarks. */
+    size_t key_cache_misses() const { return _misses; }
+
+private:
+    std::span<const uint8_t> encode_erased(const pmtv::map_t& meta, const detail::pdu_payload& payload);
+    bool key_cached(size_t i, const std::string& key) const;
+    void cache_keys(const pmtv::map_t& meta);
+
+    std::vector<uint8_t> _prefixes;  // DICT PAIR SYMBOL <len> <key> for every cached key, in map order
+    std::vector<size_t> _key_offsets; // start of each key's prefix, plus the end
+    std::vector<uint8_t> _buf;
+    size_t _misses = 0;
+};
+
+} // namespace legacy_pmt
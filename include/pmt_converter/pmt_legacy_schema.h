@@ -0,0 +1,296 @@
+#pragma once
+
+#include <pmt_converter/pmt_legacy_codec.h>
+#include <pmt_converter/pmt_legacy_format.h>
+#include <pmtv/pmt.hpp>
+
+#include <algorithm>
+#include <array>
+#include <concepts>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <vector>
+
+namespace legacy_pmt {
+
+/**
+ * Compile-time string usable as a template argument, e.g. field<"rx_time", ...>.
+ */
+template <size_t N>
+struct fixed_string {
+    char chars[N]{};
+    constexpr fixed_string(const char (&s)[N]) { std::copy_n(s, N, chars); }
+    constexpr std::string_view view() const { return {chars, N - 1}; }
+};
+
+template <typename T>
+struct member_traits;
+
+template <typename C, typename M>
+struct member_traits<M C::*> {
+    using class_type = C;
+    using value_type = M;
+};
+
+template <typename T>
+concept schema_value = std::same_as<T, bool> || std::same_as<T, int32_t> || std::same_as<T, int64_t> ||
+                       std::same_as<T, float> || std::same_as<T, double> || std::same_as<T, std::string>;
+
+/**
+ * One dict entry of a static schema: the symbol key and the struct member holding its value.
+ */
+template <fixed_string Key, auto Member>
+struct field {
+    using class_type = typename member_traits<decltype(Member)>::class_type;
+    using value_type = typename member_traits<decltype(Member)>::value_type;
+    static_assert(schema_value<value_type>, "Unsupported schema field type");
+
+    static constexpr std::string_view key = Key.view();
+    static_assert(key.size() <= 0xFFFF, "Schema key too long for a legacy symbol");
+
+    // DICT PAIR SYMBOL <u16 length> <key>: the same bytes in every message
+    static constexpr auto prefix = [] {
+        std::array<uint8_t, 5 + key.size()> p{};
+        p[0] = static_cast<uint8_t>(legacy_tag::LEGACY_PMT_DICT);
+        p[1] = static_cast<uint8_t>(legacy_tag::LEGACY_PMT_PAIR);
+        p[2] = static_cast<uint8_t>(legacy_tag::LEGACY_PMT_SYMBOL);
+        p[3] = static_cast<uint8_t>(key.size() >> 8);
+        p[4] = static_cast<uint8_t>(key.size() & 0xFF);
+        for (size_t i = 0; i < key.size(); ++i)
+            p[5 + i] = static_cast<uint8_t>(key[i]);
+        return p;
+    }();
+
+    static size_t size(const class_type& s) {
+        const value_type& v = s.*Member;
+        if constexpr (std::same_as<value_type, bool>) {
+            return prefix.size() + 1;
+        } else if constexpr (std::same_as<value_type, int32_t>) {
+            return prefix.size() + 1 + 4;
+        } else if constexpr (std::same_as<value_type, std::string>) {
+            // serialize() sizes before it writes, so this is the one place to check
+            if (v.size() > 0xFFFF)
+                throw std::runtime_error("Symbol too long for legacy serialization");
+            return prefix.size() + symbol_header_size + v.size();
+        } else {
+            return prefix.size() + 1 + 8;
+        }
+    }
+
+    static void write(uint8_t*& out, const class_type& s) {
+        const value_type& v = s.*Member;
+        std::memcpy(out, prefix.data(), prefix.size());
+        out += prefix.size();
+
+        if constexpr (std::same_as<value_type, bool>) {
+            write_u8(out, static_cast<uint8_t>(v ? legacy_tag::LEGACY_PMT_TRUE : legacy_tag::LEGACY_PMT_FALSE));
+        } else if constexpr (std::same_as<value_type, int32_t>) {
+            write_u8(out, static_cast<uint8_t>(legacy_tag::LEGACY_PMT_INT32));
+            write_u32(out, static_cast<uint32_t>(v));
+        } else if constexpr (std::same_as<value_type, int64_t>) {
+            write_u8(out, static_cast<uint8_t>(legacy_tag::LEGACY_PMT_INT64));
+            write_u64(out, static_cast<uint64_t>(v));
+        } else if constexpr (std::same_as<value_type, std::string>) {
+            write_symbol(out, v);
+        } else {
+            write_u8(out, static_cast<uint8_t>(legacy_tag::LEGACY_PMT_DOUBLE));
+            write_double(out, static_cast<double>(v));
+        }
+    }
+
+    // Parse this entry directly from the wire; false on any deviation from the template
+    static bool read(const uint8_t*& ptr, const uint8_t* end, class_type& s) {
+        value_type& v = s.*Member;
+        size_t avail = static_cast<size_t>(end - ptr);
+        if (avail < prefix.size() + 1 || std::memcmp(ptr, prefix.data(), prefix.size()) != 0)
+            return false;
+        ptr += prefix.size();
+        avail -= prefix.size() + 1;
+        auto tag = static_cast<legacy_tag>(*ptr++);
+
+        if constexpr (std::same_as<value_type, bool>) {
+            if (tag != legacy_tag::LEGACY_PMT_TRUE && tag != legacy_tag::LEGACY_PMT_FALSE)
+                return false;
+            v = tag == legacy_tag::LEGACY_PMT_TRUE;
+        } else if constexpr (std::same_as<value_type, int32_t>) {
+            if (tag != legacy_tag::LEGACY_PMT_INT32 || avail < 4)
+                return false;
+            v = static_cast<int32_t>(read_u32(ptr));
+        } else if constexpr (std::same_as<value_type, int64_t>) {
+            // GR3 writes longs that fit in 32 bits as INT32
+            if (tag == legacy_tag::LEGACY_PMT_INT64 && avail >= 8)
+                v = static_cast<int64_t>(read_u64(ptr));
+            else if (tag == legacy_tag::LEGACY_PMT_INT32 && avail >= 4)
+                v = static_cast<int32_t>(read_u32(ptr));
+            else
+                return false;
+        } else if constexpr (std::same_as<value_type, std::string>) {
+            if (tag != legacy_tag::LEGACY_PMT_SYMBOL || avail < 2)
+                return false;
+            size_t len = (ptr[0] << 8) | ptr[1];
+            if (avail - 2 < len)
+                return false;
+            v.assign(reinterpret_cast<const char*>(ptr + 2), len);
+            ptr += 2 + len;
+        } else {
+            if (tag != legacy_tag::LEGACY_PMT_DOUBLE || avail < 8)
+                return false;
+            v = static_cast<value_type>(read_double(ptr));
+        }
+        return true;
+    }
+
+    static void to_map(pmtv::map_t& m, const class_type& s) {
+        m.insert_or_assign(std::string(key), pmtv::pmt(s.*Member));
+    }
+
+    static bool from_map(const pmtv::map_t& m, class_type& s) {
+        auto it = m.find(key);
+        if (it == m.end())
+            return false;
+        value_type& v = s.*Member;
+        const pmtv::pmt& p = it->second;
+
+        if constexpr (std::same_as<value_type, int64_t>) {
+            if (auto* i32 = std::get_if<int32_t>(&p)) { v = *i32; return true; }
+        } else if constexpr (std::same_as<value_type, float>) {
+            if (auto* d = std::get_if<double>(&p)) { v = static_cast<float>(*d); return true; }
+        } else if constexpr (std::same_as<value_type, double>) {
+            if (auto* f = std::get_if<float>(&p)) { v = *f; return true; }
+        }
+        if (auto* exact = std::get_if<value_type>(&p)) {
+            v = *exact;
+            return true;
+        }
+        return false;
+    }
+};
+
+/**
+ * Static schema for dict messages with a fixed set of keys and value types.
+ *
+ *     struct rx_tag { int64_t rx_time; double freq; std::string label; };
+ *     using rx_tag_schema = legacy_schema<rx_tag,
+ *                                         field<"rx_time", &rx_tag::rx_time>,
+ *                                         field<"freq", &rx_tag::freq>,
+ *                                         field<"label", &rx_tag::label>>;
+ *
+ * serialize() emits exactly the bytes serialize_to_legacy() would produce for
+ * the equivalent pmtv::map_t, without building one. deserialize() parses the
+ * wire bytes against the precomputed key template and only falls back to the
+ * generic deserialize_from_legacy() path when the message deviates from it.
+ */
+template <typename Struct, typename... Fields>
+class legacy_schema {
+    static_assert((std::same_as<typename Fields::class_type, Struct> && ...),
+                  "All schema fields must be members of the schema struct");
+
+    static constexpr size_t num_fields = sizeof...(Fields);
+
+    // pmtv::map_t iterates in key order, so fields are emitted in that order too
+    static constexpr auto order = [] {
+        std::array<std::string_view, num_fields> keys{Fields::key...};
+        std::array<size_t, num_fields> idx{};
+        for (size_t i = 0; i < num_fields; ++i)
+            idx[i] = i;
+        std::sort(idx.begin(), idx.end(), [&](size_t a, size_t b) { return keys[a] < keys[b]; });
+        return idx;
+    }();
+
+    static constexpr bool unique_keys = [] {
+        std::array<std::string_view, num_fields> keys{Fields::key...};
+        for (size_t i = 1; i < num_fields; ++i)
+            if (keys[order[i - 1]] == keys[order[i]])
+                return false;
+        return true;
+    }();
+    static_assert(unique_keys, "Duplicate key in legacy_schema");
+
+    template <size_t I>
+    using sorted_field = std::tuple_element_t<order[I], std::tuple<Fields...>>;
+
+    template <size_t... I>
+    static size_t size_impl(const Struct& s, std::index_sequence<I...>) {
+        return (size_t{1} + ... + sorted_field<I>::size(s));
+    }
+
+    template <size_t... I>
+    static void write_impl(uint8_t*& out, const Struct& s, std::index_sequence<I...>) {
+        (sorted_field<I>::write(out, s), ...);
+        write_u8(out, static_cast<uint8_t>(legacy_tag::LEGACY_PMT_NULL));
+    }
+
+    template <size_t... I>
+    static bool read_impl(const uint8_t*& ptr, const uint8_t* end, Struct& s, std::index_sequence<I...>) {
+        return (sorted_field<I>::read(ptr, end, s) && ...);
+    }
+
+public:
+    /** Number of bytes serialize() produces for s. */
+    static size_t size(const Struct& s) {
+        return size_impl(s, std::make_index_sequence<num_fields>{});
+    }
+
+    static size_t serialize(const Struct& s, uint8_t* out, size_t capacity) {
+        if (size(s) > capacity)
+            throw std::length_error("Buffer too small for legacy PMT serialization");
+        uint8_t* ptr = out;
+        write_impl(ptr, s, std::make_index_sequence<num_fields>{});
+        return static_cast<size_t>(ptr - out);
+    }
+
+    static std::vector<uint8_t> serialize(const Struct& s) {
+        std::vector<uint8_t> out(size(s));
+        uint8_t* ptr = out.data();
+        write_impl(ptr, s, std::make_index_sequence<num_fields>{});
+        return out;
+    }
+
+    /**
+     * Fast path only: parse data into s if it matches the schema layout exactly.
+     * Returns false (leaving s partially updated) on any mismatch.
+     */
+    static bool try_deserialize(const uint8_t* data, size_t size, Struct& s) {
+        const uint8_t* ptr = data;
+        const uint8_t* end = data + size;
+        return read_impl(ptr, end, s, std::make_index_sequence<num_fields>{}) &&
+               end - ptr == 1 && static_cast<legacy_tag>(*ptr) == legacy_tag::LEGACY_PMT_NULL;
+    }
+
+    /**
+     * Parse data into a Struct, falling back to the generic decoder when the
+     * bytes do not match the schema template (reordered or extra keys, INT32
+     * vs INT64, ...). Throws std::runtime_error if a field is missing or has
+     * an incompatible type.
+     */
+    static Struct deserialize(const uint8_t* data, size_t size) {
+        Struct s{};
+        if (try_deserialize(data, size, s))
+            return s;
+
+        pmtv::pmt obj = deserialize_from_legacy(data, size);
+        auto* m = std::get_if<pmtv::map_t>(&obj);
+        if (!m)
+            throw std::runtime_error("Legacy PMT is not a dict");
+        return from_map(*m);
+    }
+
+    static pmtv::map_t to_map(const Struct& s) {
+        pmtv::map_t m;
+        (Fields::to_map(m, s), ...);
+        return m;
+    }
+
+    static Struct from_map(const pmtv::map_t& m) {
+        Struct s{};
+        if (!(Fields::from_map(m, s) && ...))
+            throw std::runtime_error("Legacy PMT dict does not match schema");
+        return s;
+    }
+};
+
+} // namespace legacy_pmt
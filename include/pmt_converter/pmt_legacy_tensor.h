@@ -0,0 +1,94 @@
+#pragma once
+
+#include <pmt_converter/pmt_legacy_format.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <type_traits>
+#include <vector>
+
+#if __has_include(<mdspan>)
+#include <mdspan>
+#endif
+
+namespace legacy_pmt {
+
+/**
+ * Strided view of tensor data owned elsewhere, e.g. one channel of an
+ * interleaved capture or a transposed matrix. Strides are in elements,
+ * outermost dimension first, and may be zero or negative.
+ */
+template <typename T>
+struct tensor_view {
+    const T* data;
+    std::span<const size_t> extents;
+    std::span<const ptrdiff_t> strides;
+};
+
+namespace detail {
+
+    struct erased_tensor_view {
+        const uint8_t* data;
+        legacy_uniform_type dtype;
+        std::span<const size_t> extents;
+        std::span<const ptrdiff_t> strides;
+    };
+
+    size_t tensor_serialized_size(const erased_tensor_view& view);
+    size_t serialize_tensor(const erased_tensor_view& view, uint8_t* out, size_t capacity);
+
+    template <typename T>
+    erased_tensor_view erase(const tensor_view<T>& view) {
+        static_assert(legacy_uniform_type_for<T>() != legacy_uniform_type::UNKNOWN,
+                      "No legacy uniform vector type for this element type");
+        return {reinterpret_cast<const uint8_t*>(view.data), legacy_uniform_type_for<T>(), view.extents, view.strides};
+    }
+
+} // namespace detail
+
+/**
+ * Number of bytes serialize_tensor_to_legacy() produces for view. Throws
+ * std::runtime_error if extents and strides differ in rank, or the shape
+ * cannot be encoded (rank above uniform_shape_max_rank, extents beyond u32).
+ */
+template <typename T>
+size_t legacy_tensor_size(const tensor_view<T>& view) {
+    return detail::tensor_serialized_size(detail::erase(view));
+}
+
+/**
+ * Encode the elements of view in row-major order as a legacy uniform vector,
+ * with the shape extension when the rank is above one. Elements are gathered
+ * straight from the strided source; runs that are contiguous in memory are
+ * byte-swapped as one block. The bytes equal serialize_to_legacy() of a
+ * contiguous pmtv::Tensor of the same shape and values.
+ * Throws std::length_error if capacity is smaller than legacy_tensor_size(view).
+ */
+template <typename T>
+size_t serialize_tensor_to_legacy(const tensor_view<T>& view, uint8_t* out, size_t capacity) {
+    return detail::serialize_tensor(detail::erase(view), out, capacity);
+}
+
+template <typename T>
+std::vector<uint8_t> serialize_tensor_to_legacy(const tensor_view<T>& view) {
+    std::vector<uint8_t> out(legacy_tensor_size(view));
+    serialize_tensor_to_legacy(view, out.data(), out.size());
+    return out;
+}
+
+#if defined(__cpp_lib_mdspan)
+/** Any std::mdspan whose layout reports strides, layout_stride included. */
+template <typename T, typename Extents, typename Layout, typename Accessor>
+std::vector<uint8_t> serialize_tensor_to_legacy(const std::mdspan<T, Extents, Layout, Accessor>& m) {
+    std::vector<size_t> extents(Extents::rank());
+    std::vector<ptrdiff_t> strides(Extents::rank());
+    for (size_t r = 0; r < Extents::rank(); ++r) {
+        extents[r] = static_cast<size_t>(m.extent(r));
+        strides[r] = static_cast<ptrdiff_t>(m.stride(r));
+    }
+    return serialize_tensor_to_legacy(tensor_view<std::remove_const_t<T>>{m.data_handle(), extents, strides});
+}
+#endif
+
+} // namespace legacy_pmt
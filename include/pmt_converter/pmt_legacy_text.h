@@ -0,0 +1,43 @@
+#pragma once
+
+#include <pmt_converter/legacy/pmt_legacy.h>
+#include <pmtv/pmt.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+namespace legacy_pmt {
+
+/**
+ * Text dumps of PMTs for debug sinks, appended to a caller-owned string so a
+ * capture loop can reuse one buffer (clear() keeps its capacity) instead of
+ * streaming token by token through std::ostream.
+ *
+ * All three sources print in the legacy operator<< style, e.g.
+ *
+ *     {"freq": 2.4e+09, "label": "example", "burst": [0.5 -1 ... (+4094) ], }
+ *
+ * and a message prints the same whether it is given as a tree or as its
+ * legacy encoding.
+ */
+struct format_options {
+    // Containers nested deeper than this print as [...], {...} or (...)
+    size_t max_depth = 8;
+    // Vectors and dicts print at most this many elements, then "... (+N)"
+    size_t max_elements = 16;
+};
+
+void format_to(std::string& out, const std::shared_ptr<legacy::pmt_t>& obj, const format_options& opts = {});
+
+void format_to(std::string& out, const pmtv::pmt& obj, const format_options& opts = {});
+
+/**
+ * Print a legacy-encoded message straight from its bytes, without decoding it
+ * into a tree. Malformed input prints what could be parsed followed by
+ * "<malformed at offset N>" and returns false; so does nesting deeper than
+ * legacy_max_depth (pmt_legacy_format.h), even below max_depth.
+ */
+bool format_legacy_to(std::string& out, const uint8_t* data, size_t size, const format_options& opts = {});
+
+} // namespace legacy_pmt
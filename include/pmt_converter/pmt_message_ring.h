@@ -0,0 +1,105 @@
+#pragma once
+
+#include <pmtv/pmt.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <string>
+
+namespace legacy_pmt {
+
+/**
+ * Lock-free single-producer/single-consumer ring of variable-length messages
+ * in the legacy GNU Radio PMT binary format.
+ *
+ * The ring lives in a shared memory mapping (memfd or POSIX shm), so the
+ * producer and consumer may be threads of one process or separate processes
+ * that attach to the same region. Producers serialize directly into the ring
+ * and consumers either decode a pmtv::pmt or view the encoded bytes in place.
+ */
+class message_ring {
+public:
+    /**
+     * Create a ring backed by an anonymous memfd. The descriptor returned by
+     * fd() can be handed to another process (fork, SCM_RIGHTS) and attached
+     * with from_fd(). Capacity is rounded up to a power of two.
+     */
+    static message_ring create(size_t capacity);
+
+    /**
+     * Create a ring backed by the POSIX shared memory object `name`.
+     * Throws std::system_error if the object already exists.
+     */
+    static message_ring create_shared(const std::string& name, size_t capacity);
+
+    /** Attach to a ring previously created with create_shared(). */
+    static message_ring open_shared(const std::string& name);
+
+    /** Attach to a ring through a duplicate of the descriptor returned by fd(). */
+    static message_ring from_fd(int fd);
+
+    /** Remove the POSIX shared memory object `name`; existing mappings stay valid. */
+    static void unlink_shared(const std::string& name);
+
+    message_ring(message_ring&& other) noexcept;
+    message_ring& operator=(message_ring&& other) noexcept;
+    message_ring(const message_ring&) = delete;
+    message_ring& operator=(const message_ring&) = delete;
+    ~message_ring();
+
+    int fd() const { return _fd; }
+    size_t capacity() const;
+
+    // --- Producer side ---
+
+    /**
+     * Serialize obj in place into the ring.
+     * Returns false if there is not enough free space.
+     */
+    bool try_push(const pmtv::pmt& obj);
+
+    /** Copy an already encoded legacy message into the ring. */
+    bool try_push(const uint8_t* data, size_t size);
+
+    /**
+     * Reserve size contiguous bytes for the next message and return a pointer
+     * to them, or nullptr if the ring is full. The message becomes visible to
+     * the consumer on commit(); reserving again without committing discards it.
+     */
+    uint8_t* try_reserve(size_t size);
+    void commit();
+
+    // --- Consumer side ---
+
+    /** Decode and remove the oldest message, if any. */
+    std::optional<pmtv::pmt> try_pop();
+
+    /**
+     * View the oldest message in place without removing it. Returns an empty
+     * span if the ring is empty. The bytes stay valid until release().
+     */
+    std::span<const uint8_t> try_peek();
+    void release();
+
+private:
+    struct header;
+
+    message_ring(int fd, bool initialize, size_t capacity);
+
+    header* _hdr = nullptr;
+    uint8_t* _data = nullptr;
+    size_t _map_size = 0;
+    int _fd = -1;
+
+    // Producer-local state
+    uint64_t _tail_cache = 0;
+    uint64_t _reserved_pos = 0;
+    size_t _reserved_size = 0;
+
+    // Consumer-local state
+    uint64_t _head_cache = 0;
+    uint64_t _peek_next = 0;
+};
+
+} // namespace legacy_pmt
@@ -1,7 +1,7 @@
 // src/main.cpp
 #include <iostream>
-#include "legacy/pmt_legacy.h"
-#include "pmt_converter.h"
+#include <pmt_converter/legacy/pmt_legacy.h>
+#include <pmt_converter/pmt_converter.h>
 
 int main() {
     using namespace legacy;
@@ -24,7 +24,7 @@ int main() {
     std::cout << "Legacy PMT: " << legacy_obj << std::endl;
 
     // Convert to GNU Radio 4 PMT
-    pmtf::object gr4_obj = to_new_pmt(legacy_obj);
+    pmtv::pmt gr4_obj = to_new_pmt(legacy_obj);
     std::cout << "Converted to GNURadio 4 PMT: " << gr4_obj << std::endl;
 
     // Convert back to legacy
@@ -0,0 +1,297 @@
+#include "byteswap.h"
+
+#include <algorithm>
+#include <cstring>
+
+#if !defined(PMT_CONVERTER_NO_MULTIVERSION)
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define PMT_CONVERTER_BYTESWAP_X86 1
+#elif defined(__aarch64__)
+#include <arm_neon.h>
+#define PMT_CONVERTER_BYTESWAP_NEON 1
+#endif
+#endif
+
+// The shuffle kernels only need the baseline instruction set
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#define PMT_CONVERTER_SHUFFLE_SSE2 1
+#elif defined(__aarch64__)
+#include <arm_neon.h>
+#define PMT_CONVERTER_SHUFFLE_NEON 1
+#endif
+
+namespace legacy_pmt::detail {
+
+using kernel_fn = void (*)(const uint8_t*, uint8_t*, size_t, size_t);
+
+template <typename U>
+static void swap_scalar(const uint8_t* src, uint8_t* dst, size_t count) {
+    for (size_t i = 0; i < count; ++i) {
+        U v;
+        std::memcpy(&v, src + i * sizeof(U), sizeof(U));
+        if constexpr (sizeof(U) == 2)
+            v = __builtin_bswap16(v);
+        else if constexpr (sizeof(U) == 4)
+            v = __builtin_bswap32(v);
+        else
+            v = __builtin_bswap64(v);
+        std::memcpy(dst + i * sizeof(U), &v, sizeof(U));
+    }
+}
+
+static void swap_portable(const uint8_t* src, uint8_t* dst, size_t count, size_t width) {
+    switch (width) {
+        case 2: swap_scalar<uint16_t>(src, dst, count); break;
+        case 4: swap_scalar<uint32_t>(src, dst, count); break;
+        case 8: swap_scalar<uint64_t>(src, dst, count); break;
+        default: std::memcpy(dst, src, count * width); break;
+    }
+}
+
+#if defined(PMT_CONVERTER_BYTESWAP_X86)
+// pshufb control reversing each width-byte lane of a 16-byte block
+__attribute__((target("ssse3")))
+static __m128i reverse_mask(size_t width) {
+    alignas(16) uint8_t m[16];
+    for (size_t i = 0; i < 16; ++i)
+        m[i] = static_cast<uint8_t>(i - i % width + (width - 1 - i % width));
+    return _mm_load_si128(reinterpret_cast<const __m128i*>(m));
+}
+
+__attribute__((target("ssse3")))
+static void swap_ssse3(const uint8_t* src, uint8_t* dst, size_t count, size_t width) {
+    const __m128i mask = reverse_mask(width);
+    size_t bytes = count * width;
+    size_t i = 0;
+    for (; i + 64 <= bytes; i += 64) {
+        __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+        __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i + 16));
+        __m128i c = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i + 32));
+        __m128i d = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i + 48));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm_shuffle_epi8(a, mask));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i + 16), _mm_shuffle_epi8(b, mask));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i + 32), _mm_shuffle_epi8(c, mask));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i + 48), _mm_shuffle_epi8(d, mask));
+    }
+    for (; i + 16 <= bytes; i += 16) {
+        __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm_shuffle_epi8(a, mask));
+    }
+    swap_portable(src + i, dst + i, (bytes - i) / width, width);
+}
+
+__attribute__((target("avx2")))
+static void swap_avx2(const uint8_t* src, uint8_t* dst, size_t count, size_t width) {
+    const __m128i lane = reverse_mask(width);
+    const __m256i mask = _mm256_broadcastsi128_si256(lane);
+    size_t bytes = count * width;
+    size_t i = 0;
+    for (; i + 128 <= bytes; i += 128) {
+        __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i));
+        __m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i + 32));
+        __m256i c = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i + 64));
+        __m256i d = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i + 96));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), _mm256_shuffle_epi8(a, mask));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i + 32), _mm256_shuffle_epi8(b, mask));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i + 64), _mm256_shuffle_epi8(c, mask));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i + 96), _mm256_shuffle_epi8(d, mask));
+    }
+    for (; i + 32 <= bytes; i += 32) {
+        __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), _mm256_shuffle_epi8(a, mask));
+    }
+    swap_ssse3(src + i, dst + i, (bytes - i) / width, width);
+}
+
+static kernel_fn select_kernel(const char** name) {
+    if (__builtin_cpu_supports("avx2")) {
+        *name = "avx2";
+        return swap_avx2;
+    }
+    if (__builtin_cpu_supports("ssse3")) {
+        *name = "ssse3";
+        return swap_ssse3;
+    }
+    *name = "portable";
+    return swap_portable;
+}
+#elif defined(PMT_CONVERTER_BYTESWAP_NEON)
+static void swap_neon(const uint8_t* src, uint8_t* dst, size_t count, size_t width) {
+    size_t bytes = count * width;
+    size_t i = 0;
+    for (; i + 16 <= bytes; i += 16) {
+        uint8x16_t v = vld1q_u8(src + i);
+        switch (width) {
+            case 2: v = vrev16q_u8(v); break;
+            case 4: v = vrev32q_u8(v); break;
+            default: v = vrev64q_u8(v); break;
+        }
+        vst1q_u8(dst + i, v);
+    }
+    swap_portable(src + i, dst + i, (bytes - i) / width, width);
+}
+
+static kernel_fn select_kernel(const char** name) {
+    *name = "neon";
+    return swap_neon;
+}
+#else
+static kernel_fn select_kernel(const char** name) {
+    *name = "portable";
+    return swap_portable;
+}
+#endif
+
+namespace {
+    struct dispatch {
+        const char* name = nullptr;
+        kernel_fn fn = select_kernel(&name);
+    };
+
+    const dispatch& selected() {
+        static const dispatch d;
+        return d;
+    }
+} // namespace
+
+void byteswap_copy(const uint8_t* src, uint8_t* dst, size_t count, size_t width) {
+    // Short runs (scalars inside dicts) are not worth the indirect call
+    if (count * width < 32 || (width != 2 && width != 4 && width != 8)) {
+        swap_portable(src, dst, count, width);
+        return;
+    }
+    selected().fn(src, dst, count, width);
+}
+
+const char* byteswap_kernel_name() {
+    return selected().name;
+}
+
+// --- Byte shuffle ---
+
+static void shuffle_portable(const uint8_t* in, uint8_t* out, size_t count, size_t width, size_t first) {
+    for (size_t i = first; i < count; ++i)
+        for (size_t b = 0; b < width; ++b)
+            out[b * count + i] = in[i * width + b];
+}
+
+static void unshuffle_portable(const uint8_t* in, uint8_t* out, size_t count, size_t width, size_t first) {
+    for (size_t i = first; i < count; ++i)
+        for (size_t b = 0; b < width; ++b)
+            out[i * width + b] = in[b * count + i];
+}
+
+#if defined(PMT_CONVERTER_SHUFFLE_SSE2) || defined(PMT_CONVERTER_SHUFFLE_NEON)
+#if defined(PMT_CONVERTER_SHUFFLE_SSE2)
+using vec16 = __m128i;
+
+static vec16 load16(const uint8_t* p) {
+    return _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+}
+
+static void store16(uint8_t* p, vec16 v) {
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(p), v);
+}
+
+// Even and odd bytes of the 32 bytes a, b
+static vec16 even_bytes(vec16 a, vec16 b) {
+    const __m128i low = _mm_set1_epi16(0x00FF);
+    return _mm_packus_epi16(_mm_and_si128(a, low), _mm_and_si128(b, low));
+}
+
+static vec16 odd_bytes(vec16 a, vec16 b) {
+    return _mm_packus_epi16(_mm_srli_epi16(a, 8), _mm_srli_epi16(b, 8));
+}
+
+// Interleaved bytes of the low and high halves of a and b
+static vec16 zip_low(vec16 a, vec16 b) {
+    return _mm_unpacklo_epi8(a, b);
+}
+
+static vec16 zip_high(vec16 a, vec16 b) {
+    return _mm_unpackhi_epi8(a, b);
+}
+#else
+using vec16 = uint8x16_t;
+
+static vec16 load16(const uint8_t* p) { return vld1q_u8(p); }
+static void store16(uint8_t* p, vec16 v) { vst1q_u8(p, v); }
+static vec16 even_bytes(vec16 a, vec16 b) { return vuzp1q_u8(a, b); }
+static vec16 odd_bytes(vec16 a, vec16 b) { return vuzp2q_u8(a, b); }
+static vec16 zip_low(vec16 a, vec16 b) { return vzip1q_u8(a, b); }
+static vec16 zip_high(vec16 a, vec16 b) { return vzip2q_u8(a, b); }
+#endif
+
+// 16 elements are W vectors. Splitting even from odd bytes moves the lowest
+// bit of each byte index to the top; log2(W) rounds leave plane b in vector b
+template <size_t W>
+static void shuffle_vec(const uint8_t* in, uint8_t* out, size_t count) {
+    size_t i = 0;
+    for (; i + 16 <= count; i += 16) {
+        vec16 v[W], t[W];
+        for (size_t k = 0; k < W; ++k)
+            v[k] = load16(in + i * W + 16 * k);
+        for (size_t round = 1; round < W; round *= 2) {
+            for (size_t j = 0; j < W / 2; ++j) {
+                t[j] = even_bytes(v[2 * j], v[2 * j + 1]);
+                t[j + W / 2] = odd_bytes(v[2 * j], v[2 * j + 1]);
+            }
+            std::copy(t, t + W, v);
+        }
+        for (size_t b = 0; b < W; ++b)
+            store16(out + b * count + i, v[b]);
+    }
+    shuffle_portable(in, out, count, W, i);
+}
+
+// The rounds of shuffle_vec in reverse, interleaving instead of splitting
+template <size_t W>
+static void unshuffle_vec(const uint8_t* in, uint8_t* out, size_t count) {
+    size_t i = 0;
+    for (; i + 16 <= count; i += 16) {
+        vec16 v[W], t[W];
+        for (size_t b = 0; b < W; ++b)
+            v[b] = load16(in + b * count + i);
+        for (size_t round = 1; round < W; round *= 2) {
+            for (size_t j = 0; j < W / 2; ++j) {
+                t[2 * j] = zip_low(v[j], v[j + W / 2]);
+                t[2 * j + 1] = zip_high(v[j], v[j + W / 2]);
+            }
+            std::copy(t, t + W, v);
+        }
+        for (size_t k = 0; k < W; ++k)
+            store16(out + i * W + 16 * k, v[k]);
+    }
+    unshuffle_portable(in, out, count, W, i);
+}
+
+void byte_shuffle(const uint8_t* in, uint8_t* out, size_t count, size_t width) {
+    switch (width) {
+        case 2: shuffle_vec<2>(in, out, count); break;
+        case 4: shuffle_vec<4>(in, out, count); break;
+        case 8: shuffle_vec<8>(in, out, count); break;
+        default: shuffle_portable(in, out, count, width, 0); break;
+    }
+}
+
+void byte_unshuffle(const uint8_t* in, uint8_t* out, size_t count, size_t width) {
+    switch (width) {
+        case 2: unshuffle_vec<2>(in, out, count); break;
+        case 4: unshuffle_vec<4>(in, out, count); break;
+        case 8: unshuffle_vec<8>(in, out, count); break;
+        default: unshuffle_portable(in, out, count, width, 0); break;
+    }
+}
+#else
+void byte_shuffle(const uint8_t* in, uint8_t* out, size_t count, size_t width) {
+    shuffle_portable(in, out, count, width, 0);
+}
+
+void byte_unshuffle(const uint8_t* in, uint8_t* out, size_t count, size_t width) {
+    unshuffle_portable(in, out, count, width, 0);
+}
+#endif
+
+} // namespace legacy_pmt::detail
@@ -0,0 +1,31 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace legacy_pmt::detail {
+
+/**
+ * Copy count elements of width bytes (2, 4 or 8) from src to dst, reversing
+ * the bytes of each. src and dst must not overlap. Dispatches once per process
+ * to the widest kernel the CPU supports (AVX2, SSSE3 or NEON, with a scalar
+ * fallback), unless the build disables multiversioning.
+ */
+void byteswap_copy(const uint8_t* src, uint8_t* dst, size_t count, size_t width);
+
+/** Name of the kernel byteswap_copy() dispatches to, for benchmark reports. */
+const char* byteswap_kernel_name();
+
+/**
+ * Byte-shuffle count elements of width bytes into width planes,
+ * out[b * count + i] = in[i * width + b], so that the slowly changing high
+ * bytes of samples sit next to each other for the compressor. Transposes 16
+ * elements at a time with SSE2 or NEON, which the x86-64 and aarch64
+ * baselines include, so no dispatch is needed. in and out must not overlap.
+ */
+void byte_shuffle(const uint8_t* in, uint8_t* out, size_t count, size_t width);
+
+/** Inverse of byte_shuffle(): out[i * width + b] = in[b * count + i]. */
+void byte_unshuffle(const uint8_t* in, uint8_t* out, size_t count, size_t width);
+
+} // namespace legacy_pmt::detail
@@ -0,0 +1,151 @@
+#include <pmt_converter/pmt_legacy_framed.h>
+
+#include <array>
+#include <bit>
+#include <cstring>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <nmmintrin.h>
+#define PMT_CONVERTER_CRC32C_X86 1
+#elif defined(__aarch64__) && defined(__ARM_FEATURE_CRC32)
+#include <arm_acle.h>
+#define PMT_CONVERTER_CRC32C_ARM 1
+#endif
+
+namespace legacy_pmt {
+
+// Reflected Castagnoli polynomial
+static constexpr uint32_t crc32c_poly = 0x82F63B78;
+
+// Slicing-by-8 tables for the portable implementation
+static constexpr auto crc32c_tables = [] {
+    std::array<std::array<uint32_t, 256>, 8> t{};
+    for (uint32_t i = 0; i < 256; ++i) {
+        uint32_t c = i;
+        for (int k = 0; k < 8; ++k)
+            c = (c >> 1) ^ (crc32c_poly & (0u - (c & 1)));
+        t[0][i] = c;
+    }
+    for (uint32_t i = 0; i < 256; ++i)
+        for (size_t s = 1; s < 8; ++s)
+            t[s][i] = (t[s - 1][i] >> 8) ^ t[0][t[s - 1][i] & 0xFF];
+    return t;
+}();
+
+static uint32_t crc32c_portable(uint32_t crc, const uint8_t* p, size_t n) {
+    const auto& t = crc32c_tables;
+    while (n >= 8) {
+        uint64_t word;
+        std::memcpy(&word, p, 8);
+        if constexpr (std::endian::native == std::endian::big)
+            word = std::byteswap(word);
+        word ^= crc;
+        crc = t[7][word & 0xFF] ^ t[6][(word >> 8) & 0xFF] ^ t[5][(word >> 16) & 0xFF] ^
+              t[4][(word >> 24) & 0xFF] ^ t[3][(word >> 32) & 0xFF] ^ t[2][(word >> 40) & 0xFF] ^
+              t[1][(word >> 48) & 0xFF] ^ t[0][word >> 56];
+        p += 8;
+        n -= 8;
+    }
+    while (n--)
+        crc = (crc >> 8) ^ t[0][(crc ^ *p++) & 0xFF];
+    return crc;
+}
+
+#if defined(PMT_CONVERTER_CRC32C_X86)
+__attribute__((target("sse4.2")))
+static uint32_t crc32c_hw(uint32_t crc, const uint8_t* p, size_t n) {
+#if defined(__x86_64__)
+    uint64_t c = crc;
+    while (n >= 8) {
+        uint64_t word;
+        std::memcpy(&word, p, 8);
+        c = _mm_crc32_u64(c, word);
+        p += 8;
+        n -= 8;
+    }
+    crc = static_cast<uint32_t>(c);
+#endif
+    while (n--)
+        crc = _mm_crc32_u8(crc, *p++);
+    return crc;
+}
+
+static const bool have_hw_crc32c = __builtin_cpu_supports("sse4.2");
+#elif defined(PMT_CONVERTER_CRC32C_ARM)
+static uint32_t crc32c_hw(uint32_t crc, const uint8_t* p, size_t n) {
+    while (n >= 8) {
+        uint64_t word;
+        std::memcpy(&word, p, 8);
+        crc = __crc32cd(crc, word);
+        p += 8;
+        n -= 8;
+    }
+    while (n--)
+        crc = __crc32cb(crc, *p++);
+    return crc;
+}
+
+static constexpr bool have_hw_crc32c = true;
+#endif
+
+uint32_t crc32c(const uint8_t* data, size_t size, uint32_t crc) {
+    crc = ~crc;
+#if defined(PMT_CONVERTER_CRC32C_X86) || defined(PMT_CONVERTER_CRC32C_ARM)
+    if (have_hw_crc32c)
+        return ~crc32c_hw(crc, data, size);
+#endif
+    return ~crc32c_portable(crc, data, size);
+}
+
+// Appending len2 zero bytes to a message is a linear map over GF(2) on the
+// CRC register; combine by applying it to crc_a via repeated squaring
+static uint32_t gf2_matrix_times(const uint32_t* mat, uint32_t vec) {
+    uint32_t sum = 0;
+    while (vec) {
+        if (vec & 1)
+            sum ^= *mat;
+        vec >>= 1;
+        ++mat;
+    }
+    return sum;
+}
+
+static void gf2_matrix_square(uint32_t* square, const uint32_t* mat) {
+    for (int n = 0; n < 32; ++n)
+        square[n] = gf2_matrix_times(mat, mat[n]);
+}
+
+uint32_t crc32c_combine(uint32_t crc_a, uint32_t crc_b, size_t size_b) {
+    if (size_b == 0)
+        return crc_a;
+
+    uint32_t even[32];
+    uint32_t odd[32];
+
+    // Operator for one zero bit
+    odd[0] = crc32c_poly;
+    uint32_t row = 1;
+    for (int n = 1; n < 32; ++n) {
+        odd[n] = row;
+        row <<= 1;
+    }
+    gf2_matrix_square(even, odd); // two zero bits
+    gf2_matrix_square(odd, even); // four zero bits
+
+    do {
+        gf2_matrix_square(even, odd);
+        if (size_b & 1)
+            crc_a = gf2_matrix_times(even, crc_a);
+        size_b >>= 1;
+        if (size_b == 0)
+            break;
+        gf2_matrix_square(odd, even);
+        if (size_b & 1)
+            crc_a = gf2_matrix_times(odd, crc_a);
+        size_b >>= 1;
+    } while (size_b != 0);
+
+    return crc_a ^ crc_b;
+}
+
+} // namespace legacy_pmt
@@ -1,10 +1,21 @@
 #include <pmt_converter/pmt_legacy_codec.h>
+#include <pmt_converter/pmt_legacy_dedup.h>
+#include <pmt_converter/pmt_legacy_format.h>
+#include <pmt_converter/pmt_legacy_framed.h>
+#include <pmt_converter/pmt_legacy_pdu.h>
+#include "byteswap.h"
+#include "pmt_legacy_codec_detail.h"
+#include "thread_pool.h"
 
 #include <stdexcept>
+#include <atomic>
 #include <cstring>
 #include <cmath>
 #include <string>
 #include <limits>
+#include <optional>
+#include <span>
+#include <type_traits>
 #include <variant>
 #include <iostream>
 #include <algorithm>
@@ -18,326 +29,281 @@ using namespace pmtv;
 
 namespace legacy_pmt {
 
-enum class legacy_tag : uint8_t {
-    LEGACY_PMT_TRUE = 0x00,
-    LEGACY_PMT_FALSE = 0x01,
-    LEGACY_PMT_SYMBOL = 0x02,
-    LEGACY_PMT_INT32 = 0x03,
-    LEGACY_PMT_DOUBLE = 0x04,
-    LEGACY_PMT_COMPLEX = 0x05,
-    LEGACY_PMT_NULL = 0x06,
-    LEGACY_PMT_PAIR = 0x07,
-    LEGACY_PMT_VECTOR = 0x08,
-    LEGACY_PMT_DICT = 0x09,    
-    LEGACY_PMT_UNIFORM_VECTOR = 0x0A,
-    LEGACY_PMT_UINT64 = 0x0B,
-    LEGACY_PMT_TUPLE = 0x0C,
-    LEGACY_PMT_INT64 = 0x0D
-};
-
-enum class legacy_uniform_type : uint8_t {
-    U8 = 0x00,
-    S8 = 0x01,
-    U16 = 0x02,
-    S16 = 0x03,
-    U32 = 0x04,
-    S32 = 0x05,
-    U64 = 0x06,
-    S64 = 0x07,
-    F32 = 0x08,
-    F64 = 0x09,    
-    C32 = 0x0A,
-    C64 = 0x0B,
-    UNKNOWN = 0xFF
-};
+static std::atomic<size_t> parallel_threshold_bytes{parallel_options{}.threshold_bytes};
+static std::atomic<size_t> parallel_chunk_bytes{parallel_options{}.chunk_bytes};
+static std::atomic<unsigned> parallel_max_threads{parallel_options{}.max_threads};
 
-static void write_u8(std::vector<uint8_t>& out, uint8_t v) {
-    out.push_back(v);
+void set_parallel_options(const parallel_options& opts) {
+    parallel_threshold_bytes.store(opts.threshold_bytes, std::memory_order_relaxed);
+    parallel_chunk_bytes.store(std::max<size_t>(opts.chunk_bytes, 1), std::memory_order_relaxed);
+    parallel_max_threads.store(opts.max_threads, std::memory_order_relaxed);
 }
 
-static void write_u16(std::vector<uint8_t>& out, uint32_t v) {
-    for (int i = 1; i >= 0; --i)
-        out.push_back((v >> (i * 8)) & 0xFF);
+parallel_options get_parallel_options() {
+    return {parallel_threshold_bytes.load(std::memory_order_relaxed),
+            parallel_chunk_bytes.load(std::memory_order_relaxed),
+            parallel_max_threads.load(std::memory_order_relaxed)};
 }
 
-static void write_u32(std::vector<uint8_t>& out, uint32_t v) {
-    for (int i = 3; i >= 0; --i)
-        out.push_back((v >> (i * 8)) & 0xFF);
-}
+// How a uniform payload is split: a single inline chunk below the parallel
+// threshold, otherwise chunk_bytes pieces spread over the codec thread pool
+struct chunk_plan {
+    size_t per_chunk;
+    size_t num_chunks;
+    unsigned max_threads;
+};
 
-static void write_u64(std::vector<uint8_t>& out, uint64_t v) {
-    for (int i = 7; i >= 0; --i)
-        out.push_back((v >> (i * 8)) & 0xFF);
-}
+static chunk_plan plan_chunks(size_t num_elements, size_t element_size) {
+    const size_t bytes = num_elements * element_size;
+    const unsigned max_threads = parallel_max_threads.load(std::memory_order_relaxed);
+    if (bytes < parallel_threshold_bytes.load(std::memory_order_relaxed) || max_threads == 1) {
+        return {num_elements, 1, 1};
+    }
 
-static void write_double(std::vector<uint8_t>& out, double d) {
-    uint64_t bits;
-    std::memcpy(&bits, &d, sizeof(double));
-    write_u64(out, bits);
+    const size_t per_chunk = std::max<size_t>(parallel_chunk_bytes.load(std::memory_order_relaxed) / element_size, 1);
+    return {per_chunk, (num_elements + per_chunk - 1) / per_chunk, max_threads};
 }
 
-static uint64_t read_u32(const uint8_t*& data) {
-    uint64_t result = 0;
-    for (int i = 0; i < 4; ++i) {
-        result = (result << 8) | data[i];
+// Call fn(chunk, first, count) for every chunk of [0, num_elements)
+template <typename F>
+void for_each_chunk(const chunk_plan& plan, size_t num_elements, F&& fn) {
+    if (plan.num_chunks <= 1) {
+        fn(size_t{0}, size_t{0}, num_elements);
+        return;
     }
-    data += 4;
-    return result;
-}
 
-static uint64_t read_u64(const uint8_t*& data) {
-    uint64_t result = 0;
-    for (int i = 0; i < 8; ++i) {
-        result = (result << 8) | data[i];
-    }
-    data += 8;
-    return result;
+    detail::parallel_for(plan.num_chunks, plan.max_threads, [&](size_t chunk) {
+        size_t first = chunk * plan.per_chunk;
+        fn(chunk, first, std::min(plan.per_chunk, num_elements - first));
+    });
 }
 
-static double read_double(const uint8_t*& data) {
-    uint64_t bits = read_u64(data);
-    double d;
-    std::memcpy(&d, &bits, sizeof(double));
-    return d;
-}
+// Scalar the wire byte order applies to: the element itself, or each half of a complex
+template <typename T>
+struct wire_scalar {
+    using type = T;
+};
 
-std::vector<uint8_t> serialize_integral(const pmtv::pmt& obj) {
-    return std::visit([](const auto& val) -> std::vector<uint8_t> {
-        using T = std::decay_t<decltype(val)>;
-        std::vector<uint8_t> out;
+template <typename T>
+struct wire_scalar<std::complex<T>> {
+    using type = T;
+};
 
-        if constexpr (std::is_same_v<T, int32_t>) {
-            write_u8(out, static_cast<uint8_t>(legacy_tag::LEGACY_PMT_INT32));
-            write_u32(out, static_cast<uint32_t>(val));
-        } else if constexpr (std::is_same_v<T, int64_t>) {
-            write_u8(out, static_cast<uint8_t>(legacy_tag::LEGACY_PMT_INT64));
-            write_u64(out, static_cast<uint64_t>(val));
-        } else {
-            throw std::runtime_error("Unsupported Integral PMT type for serialization");
+template <typename T>
+void encode_big_endian_block(const T* src, size_t count, uint8_t* out) {
+    using S = typename wire_scalar<T>::type;
+    if constexpr (sizeof(T) == 1) {
+        std::memcpy(out, src, count);
+    } else if constexpr (std::endian::native == std::endian::little) {
+        detail::byteswap_copy(reinterpret_cast<const uint8_t*>(src), out, count * (sizeof(T) / sizeof(S)), sizeof(S));
+    } else {
+        for (size_t i = 0; i < count; ++i) {
+            serialize_to_big_endian(src[i], out);
         }
-
-        return out;
-    }, obj);
-
+    }
 }
 
-std::vector<uint8_t> serialize_real(const pmtv::pmt& obj) {
-    return std::visit([](const auto& val) -> std::vector<uint8_t> {
-        using T = std::decay_t<decltype(val)>;
-        std::vector<uint8_t> out;
-
-        write_u8(out, static_cast<uint8_t>(legacy_tag::LEGACY_PMT_DOUBLE));
-        if constexpr (std::is_same_v<T, float>) {
-            write_double(out, static_cast<double>(val));
-        } else if constexpr (std::is_same_v<T, double>) {
-            write_double(out, val);
-        } else {
-            throw std::runtime_error("Unsupported PMT type for serialization");
+template <typename T>
+void decode_big_endian_block(const uint8_t* src, size_t count, T* dst) {
+    using S = typename wire_scalar<T>::type;
+    if constexpr (sizeof(T) == 1) {
+        std::memcpy(dst, src, count);
+    } else if constexpr (std::endian::native == std::endian::little) {
+        detail::byteswap_copy(src, reinterpret_cast<uint8_t*>(dst), count * (sizeof(T) / sizeof(S)), sizeof(S));
+    } else {
+        for (size_t i = 0; i < count; ++i) {
+            dst[i] = deserialize_from_big_endian<T>(src);
         }
+    }
+}
 
-        return out;
-    }, obj);
+// Running CRC32C over a message in framed mode. Bytes before mark have been
+// folded in; uniform payloads fold themselves block by block as they are
+// byte-swapped and everything else is folded lazily when the mark moves.
+struct checksum_state {
+    const uint8_t* mark;
+    uint32_t crc;
+};
 
+static void fold_checksum(checksum_state& cs, const uint8_t* upto) {
+    if (upto > cs.mark) {
+        cs.crc = crc32c(cs.mark, static_cast<size_t>(upto - cs.mark), cs.crc);
+        cs.mark = upto;
+    }
 }
 
-std::vector<uint8_t> serialize_string(const std::string& str) {
-    std::vector<uint8_t> out;
+// Blocks small enough that the checksum reads them back from L1/L2
+static constexpr size_t checksum_block_bytes = 32 * 1024;
 
-    write_u8(out, static_cast<uint8_t>(legacy_tag::LEGACY_PMT_SYMBOL));
-    write_u16(out, static_cast<uint32_t>(str.size()));
-    out.insert(out.end(), str.begin(), str.end());    
-
-    return out;
+template <typename T>
+uint32_t encode_block_checksummed(const T* src, size_t count, uint8_t* out, uint32_t crc) {
+    const size_t per_block = std::max<size_t>(checksum_block_bytes / sizeof(T), 1);
+    for (size_t first = 0; first < count; first += per_block) {
+        size_t n = std::min(per_block, count - first);
+        encode_big_endian_block(src + first, n, out + first * sizeof(T));
+        crc = crc32c(out + first * sizeof(T), n * sizeof(T), crc);
+    }
+    return crc;
 }
 
 template <typename T>
-constexpr legacy_uniform_type legacy_uniform_type_for() {
-    if constexpr (std::is_same_v<T, uint8_t>) return legacy_uniform_type::U8;
-    else if constexpr (std::is_same_v<T, int8_t>) return legacy_uniform_type::S8;
-    else if constexpr (std::is_same_v<T, uint16_t>) return legacy_uniform_type::U16;
-    else if constexpr (std::is_same_v<T, int16_t>) return legacy_uniform_type::S16;
-    else if constexpr (std::is_same_v<T, uint32_t>) return legacy_uniform_type::U32;
-    else if constexpr (std::is_same_v<T, int32_t>) return legacy_uniform_type::S32;
-    else if constexpr (std::is_same_v<T, uint64_t>) return legacy_uniform_type::U64;
-    else if constexpr (std::is_same_v<T, int64_t>) return legacy_uniform_type::S64;
-    else if constexpr (std::is_same_v<T, float>) return legacy_uniform_type::F32;
-    else if constexpr (std::is_same_v<T, double>) return legacy_uniform_type::F64;
-    else if constexpr (std::is_same_v<T, std::complex<float>>) return legacy_uniform_type::C32;
-    else if constexpr (std::is_same_v<T, std::complex<double>>) return legacy_uniform_type::C64;
-    else return legacy_uniform_type::UNKNOWN;
-}
-
-
-// Helper function to swap bytes if necessary
-template <typename T>
-requires std::is_integral_v<T> && (!std::is_same_v<T, bool>) // Ensure it's an integral type, but not bool
-T to_big_endian_integral(T value) {
-    if constexpr (std::endian::native == std::endian::little) {
-        if constexpr (sizeof(T) == 1) {
-            return value; // Single byte, no swap needed
-        } else if constexpr (sizeof(T) == 2) {
-            return static_cast<T>(
-                ((static_cast<uint16_t>(value) & 0xFF00) >> 8) |
-                ((static_cast<uint16_t>(value) & 0x00FF) << 8)
-            );
-        } else if constexpr (sizeof(T) == 4) {
-            return static_cast<T>(
-                ((static_cast<uint32_t>(value) & 0xFF000000) >> 24) |
-                ((static_cast<uint32_t>(value) & 0x00FF0000) >> 8) |
-                ((static_cast<uint32_t>(value) & 0x0000FF00) << 8) |
-                ((static_cast<uint32_t>(value) & 0x000000FF) << 24)
-            );
-        } else if constexpr (sizeof(T) == 8) {
-            uint64_t u64_val = static_cast<uint64_t>(value);
-            return static_cast<T>(
-                ((u64_val & 0xFF00000000000000ULL) >> 56) |
-                ((u64_val & 0x00FF000000000000ULL) >> 40) |
-                ((u64_val & 0x0000FF0000000000ULL) >> 24) |
-                ((u64_val & 0x000000FF00000000ULL) >> 8)  |
-                ((u64_val & 0x00000000FF000000ULL) << 8)  |
-                ((u64_val & 0x0000000000FF0000ULL) << 24) |
-                ((u64_val & 0x000000000000FF00ULL) << 40) |
-                ((u64_val & 0x00000000000000FFULL) << 56)
-            );
-        } else {
-            // Generic byte swap for other integral sizes (less efficient but works)
-            std::vector<uint8_t> bytes(sizeof(T));
-            std::memcpy(bytes.data(), &value, sizeof(T));
-            std::reverse(bytes.begin(), bytes.end());
-            T result;
-            std::memcpy(&result, bytes.data(), sizeof(T));
-            return result;
-        }
+uint32_t decode_block_checksummed(const uint8_t* src, size_t count, T* dst, uint32_t crc) {
+    const size_t per_block = std::max<size_t>(checksum_block_bytes / sizeof(T), 1);
+    for (size_t first = 0; first < count; first += per_block) {
+        size_t n = std::min(per_block, count - first);
+        crc = crc32c(src + first * sizeof(T), n * sizeof(T), crc);
+        decode_big_endian_block(src + first * sizeof(T), n, dst + first);
     }
-    return value; // No swap needed if native is big-endian
+    return crc;
 }
 
+// Fold per-chunk CRCs, computed independently on the pool, into the running checksum
+static void combine_chunk_checksums(checksum_state& cs, const chunk_plan& plan, const std::vector<uint32_t>& crcs,
+                                    size_t num_elements, size_t element_size) {
+    for (size_t chunk = 0; chunk < plan.num_chunks; ++chunk) {
+        size_t count = std::min(plan.per_chunk, num_elements - chunk * plan.per_chunk);
+        cs.crc = crc32c_combine(cs.crc, crcs[chunk], count * element_size);
+    }
+}
 
-// Function to serialize any trivially copyable type to big-endian bytes
 template <typename T>
-requires std::is_trivially_copyable_v<T>
-void serialize_to_big_endian(const T& value, std::vector<uint8_t>& out) {
-    if constexpr (std::is_integral_v<T> && !std::is_same_v<T, bool>) {
-        // Handle integral types directly
-        T big_endian_val = to_big_endian_integral(value);
-        const uint8_t* bytes = reinterpret_cast<const uint8_t*>(&big_endian_val);
-        out.insert(out.end(), bytes, bytes + sizeof(T));
-    } else if constexpr (std::is_floating_point_v<T>) {
-        // Handle floating-point types (float, double, long double)
-        // Use std::bit_cast to treat float as an integer of the same size
-        if constexpr (sizeof(T) == sizeof(uint32_t)) { // For float
-            uint32_t int_repr = std::bit_cast<uint32_t>(value);
-            uint32_t big_endian_int = to_big_endian_integral(int_repr);
-            const uint8_t* bytes = reinterpret_cast<const uint8_t*>(&big_endian_int);
-            out.insert(out.end(), bytes, bytes + sizeof(uint32_t));
-        } else if constexpr (sizeof(T) == sizeof(uint64_t)) { // For double
-            uint64_t int_repr = std::bit_cast<uint64_t>(value);
-            uint64_t big_endian_int = to_big_endian_integral(int_repr);
-            const uint8_t* bytes = reinterpret_cast<const uint8_t*>(&big_endian_int);
-            out.insert(out.end(), bytes, bytes + sizeof(uint64_t));
-        } else {
-            // Fallback for other floating point types (e.g., long double) or unsupported sizes
-            // Consider specific handling or assertion here.
-            std::cout << "Warning: Unsupported floating point size for bit_cast and endian swap." << std::endl;
-            // For now, just copy raw bytes (will be platform native endianness)
-            const uint8_t* bytes = reinterpret_cast<const uint8_t*>(&value);
-            out.insert(out.end(), bytes, bytes + sizeof(T));
-        }
-    } else if constexpr (std::is_same_v<T, std::complex<float>>) {
-        serialize_to_big_endian(value.real(), out);
-        serialize_to_big_endian(value.imag(), out);
-    } else if constexpr (std::is_same_v<T, std::complex<double>>) {
-        serialize_to_big_endian(value.real(), out);
-        serialize_to_big_endian(value.imag(), out);
+void encode_payload(const T* data, size_t size, uint8_t* out, checksum_state* cs) {
+    const chunk_plan plan = plan_chunks(size, sizeof(T));
+    if (!cs) {
+        for_each_chunk(plan, size, [&](size_t, size_t first, size_t count) {
+            encode_big_endian_block(data + first, count, out + first * sizeof(T));
+        });
+        return;
     }
-    else {
-        // For other trivially copyable types where byte order isn't a concern
-        // or you don't need to swap them (e.g., char, uint8_t, or just raw memory dump)
-        const uint8_t* bytes = reinterpret_cast<const uint8_t*>(&value);
-        out.insert(out.end(), bytes, bytes + sizeof(T));
+
+    fold_checksum(*cs, out);
+    if (plan.num_chunks <= 1) {
+        cs->crc = encode_block_checksummed(data, size, out, cs->crc);
+    } else {
+        std::vector<uint32_t> crcs(plan.num_chunks);
+        for_each_chunk(plan, size, [&](size_t chunk, size_t first, size_t count) {
+            crcs[chunk] = encode_block_checksummed(data + first, count, out + first * sizeof(T), 0);
+        });
+        combine_chunk_checksums(*cs, plan, crcs, size, sizeof(T));
     }
+    cs->mark = out + size * sizeof(T);
 }
 
 template <typename T>
-std::vector<uint8_t> serialize_uniform_vector(const std::vector<T>& vec) {
-    std::vector<uint8_t> out;
-
-    write_u8(out, static_cast<uint8_t>(legacy_tag::LEGACY_PMT_UNIFORM_VECTOR));
-    write_u8(out, static_cast<uint8_t>(legacy_uniform_type_for<T>()));
-    write_u32(out, static_cast<uint32_t>(vec.size()));
-    // Padding
-    write_u8(out, static_cast<uint8_t>(1));
-    write_u8(out, static_cast<uint8_t>(0));
-
-    // out.insert(out.end(),
-    //        reinterpret_cast<const uint8_t*>(vec.data()),
-    //        reinterpret_cast<const uint8_t*>(vec.data()) + vec.size() * sizeof(T)); 
-
-    for (const auto& val : vec) {
-        serialize_to_big_endian(val, out);
-    }
-
+void serialize_uniform_vector(const T* data, size_t size, uint8_t*& out, checksum_state* cs = nullptr,
+                              std::span<const size_t> extents = {}) {
+    write_uniform_vector_header(out, legacy_uniform_type_for<T>(), size, extents);
+    encode_payload(data, size, out, cs);
+    out += size * sizeof(T);
+}
 
-    return out;
+template <typename T>
+void serialize_uniform_vector(const std::vector<T>& vec, uint8_t*& out, checksum_state* cs = nullptr) {
+    serialize_uniform_vector(vec.data(), vec.size(), out, cs);
 }
 
 template <typename T>
-std::vector<uint8_t> serialize_uniform_vector(const pmtv::Tensor<T>& vec) {
-    std::vector<uint8_t> out;
-
-    write_u8(out, static_cast<uint8_t>(legacy_tag::LEGACY_PMT_UNIFORM_VECTOR));
-    write_u8(out, static_cast<uint8_t>(legacy_uniform_type_for<T>()));
-    write_u32(out, static_cast<uint32_t>(vec.size()));
-    // Padding
-    write_u8(out, static_cast<uint8_t>(1));
-    write_u8(out, static_cast<uint8_t>(0));
-
-    // out.insert(out.end(),
-    //        reinterpret_cast<const uint8_t*>(vec.data()),
-    //        reinterpret_cast<const uint8_t*>(vec.data()) + vec.size() * sizeof(T)); 
-
-    for (const auto& val : vec) {
-        serialize_to_big_endian(val, out);
-    }
+std::span<const size_t> tensor_extents(const pmtv::Tensor<T>& vec) {
+    const auto& extents = vec.extents();
+    return {extents.data(), extents.size()};
+}
 
+template <typename T>
+void serialize_uniform_vector(const pmtv::Tensor<T>& vec, uint8_t*& out, checksum_state* cs = nullptr) {
+    serialize_uniform_vector(vec.data(), vec.size(), out, cs, tensor_extents(vec));
+}
 
-    return out;
+size_t detail::uniform_shape_count(std::span<const size_t> extents) {
+    if (extents.size() > uniform_shape_max_rank)
+        throw std::runtime_error("Tensor rank " + std::to_string(extents.size()) +
+                                 " too high for the legacy shape extension");
+
+    constexpr size_t max_count = std::numeric_limits<uint32_t>::max();
+    size_t count = 1;
+    for (size_t e : extents) {
+        if (e > max_count || (e != 0 && count > max_count / e))
+            throw std::runtime_error("Tensor too large for a legacy uniform vector");
+        count *= e;
+    }
+    return count;
 }
-// std::vector<uint8_t> serialize_map(const map_t& m) {
-//     std::vector<uint8_t> result;
 
-//     // Legacy tag for map might be something like 0x13 — adjust as needed
-//     result.push_back(0x13); 
+// Multi-dimensional tensors keep their shape in the uniform vector padding.
+// The u32 length is checked here, before a header could truncate it
+static size_t uniform_vector_size(std::span<const size_t> extents, size_t size, size_t element_size) {
+    if (size > std::numeric_limits<uint32_t>::max())
+        throw std::runtime_error("Uniform vector too long for legacy serialization");
+    if (extents.size() > 1 && detail::uniform_shape_count(extents) != size)
+        throw std::runtime_error("Tensor extents do not match its size");
+    return uniform_vector_header_size_for(extents.size()) + size * element_size;
+}
 
-//     // Write number of elements (big-endian uint32)
-//     uint32_t size = static_cast<uint32_t>(m.size());
-//     result.push_back((size >> 24) & 0xff);
-//     result.push_back((size >> 16) & 0xff);
-//     result.push_back((size >> 8) & 0xff);
-//     result.push_back(size & 0xff);
+template <typename T>
+size_t uniform_vector_size(const pmtv::Tensor<T>& vec) {
+    return uniform_vector_size(tensor_extents(vec), vec.size(), sizeof(T));
+}
 
-//     for (const auto& [key, value] : m) {
-//         // Serialize key as symbol or string
-//         std::vector<uint8_t> key_data = serialize_string_key(key);  // define this
-//         result.insert(result.end(), key_data.begin(), key_data.end());
+// Each entry is DICT PAIR <symbol key> <value>, closed by a NULL
+static size_t map_serialized_size(const map_t& m) {
+    size_t size = 1;
+    for (const auto& [key, value] : m) {
+        if (key.size() > std::numeric_limits<uint16_t>::max())
+            throw std::runtime_error("Symbol too long for legacy serialization");
+        size += 2 + symbol_header_size + key.size() + legacy_serialized_size(value);
+    }
+    return size;
+}
 
-//         // Serialize value
-//         std::vector<uint8_t> value_data = serialize_to_legacy(value);
-//         result.insert(result.end(), value_data.begin(), value_data.end());
-//     }
+// --- Serialization: basic types ---
+size_t legacy_serialized_size(const pmtv::pmt& obj) {
+    return std::visit([](const auto& val) -> size_t {
+        using T = std::decay_t<decltype(val)>;
 
-//     return result;
-// }
+        if constexpr (std::same_as<T, std::monostate> || std::same_as<T, bool>) {
+            return 1;
+        }
+        else if constexpr (std::same_as<T, int32_t>) {
+            return 1 + sizeof(uint32_t);
+        }
+        else if constexpr (std::same_as<T, int64_t>) {
+            return 1 + sizeof(uint64_t);
+        }
+        else if constexpr (std::floating_point<T>) {
+            return 1 + sizeof(double);
+        }
+        else if constexpr (std::same_as<T, std::string>) {
+            if (val.size() > std::numeric_limits<uint16_t>::max())
+                throw std::runtime_error("Symbol too long for legacy serialization");
+            return symbol_header_size + val.size();
+        }
+        else if constexpr (UniformVector<T>) {
+            return uniform_vector_size(val);
+        }
+        else if constexpr (std::is_same_v<T, map_t>) {
+            return map_serialized_size(val);
+        }
+        else {
+            throw std::runtime_error("Unsupported PMT type for legacy serialization");
+        }
+    }, obj);
+}
 
+static void serialize_unchecked(const pmtv::pmt& obj, uint8_t*& out, checksum_state* cs = nullptr);
 
-// --- Serialization: basic types ---
-std::vector<uint8_t> serialize_to_legacy(const pmtv::pmt& obj) {
+static void serialize_map_unchecked(const map_t& m, uint8_t*& out, checksum_state* cs = nullptr) {
+    for (const auto& [key, value] : m) {
+        write_u8(out, static_cast<uint8_t>(legacy_tag::LEGACY_PMT_DICT));
+        write_u8(out, static_cast<uint8_t>(legacy_tag::LEGACY_PMT_PAIR));
+        write_symbol(out, key);
+        serialize_unchecked(value, out, cs);
+    }
+    write_u8(out, static_cast<uint8_t>(legacy_tag::LEGACY_PMT_NULL));
+}
 
-    return std::visit([](const auto& val) -> std::vector<uint8_t> {
+static void serialize_unchecked(const pmtv::pmt& obj, uint8_t*& out, checksum_state* cs) {
+    std::visit([&out, cs](const auto& val) {
         using T = std::decay_t<decltype(val)>;
 
-        std::vector<uint8_t> out;
-
         if constexpr (std::same_as<T, std::monostate>){
             write_u8(out, static_cast<uint8_t>(legacy_tag::LEGACY_PMT_NULL));
         }
@@ -346,189 +312,237 @@ std::vector<uint8_t> serialize_to_legacy(const pmtv::pmt& obj) {
                 write_u8(out, static_cast<uint8_t>(legacy_tag::LEGACY_PMT_TRUE));
             } else {
                 write_u8(out, static_cast<uint8_t>(legacy_tag::LEGACY_PMT_FALSE));
-            }            
+            }
         }
-        else if constexpr (std::integral<T>){
-            out = serialize_integral(val);
+        else if constexpr (std::same_as<T, int32_t>) {
+            write_u8(out, static_cast<uint8_t>(legacy_tag::LEGACY_PMT_INT32));
+            write_u32(out, static_cast<uint32_t>(val));
+        }
+        else if constexpr (std::same_as<T, int64_t>) {
+            write_u8(out, static_cast<uint8_t>(legacy_tag::LEGACY_PMT_INT64));
+            write_u64(out, static_cast<uint64_t>(val));
         }
         else if constexpr (std::floating_point<T>) {
-            out = serialize_real(val);
+            write_u8(out, static_cast<uint8_t>(legacy_tag::LEGACY_PMT_DOUBLE));
+            write_double(out, static_cast<double>(val));
         }
         else if constexpr (std::same_as<T, std::string>) {
-            out = serialize_string(val);
+            write_symbol(out, val);
         }
-
-        else if constexpr (std::ranges::range<T>) {
-            if constexpr (UniformVector<T>) {
-                out = serialize_uniform_vector(val);
-            } else {
-                // out = serialize_pmt_vector(val);
-            }
-        }      
-        if constexpr (std::is_same_v<T, map_t>) {
-            throw std::runtime_error("No Legacy serialization defined for pmt::dict");
+        else if constexpr (UniformVector<T>) {
+            serialize_uniform_vector(val, out, cs);
         }
-
-        return out;
+        else if constexpr (std::is_same_v<T, map_t>) {
+            serialize_map_unchecked(val, out, cs);
+        }
+        // Anything else has already been rejected by legacy_serialized_size()
     }, obj);
+}
 
-    std::vector<uint8_t> out;
-
-    // //if (obj.is_none()) {
-    // if (std::holds_alternative<std::monostate>(obj)) {
-    //     write_u8(out, static_cast<uint8_t>(legacy_tag::LEGACY_PMT_NULL));
-    // // } else if (obj.is_boolean()) {
-    // } else if (std::holds_alternative<bool>(obj)) {
-    //     if (pmtv::cast<bool>(obj)) {
-    //         write_u8(out, static_cast<uint8_t>(legacy_tag::LEGACY_PMT_TRUE));
-    //     } else {
-    //         write_u8(out, static_cast<uint8_t>(legacy_tag::LEGACY_PMT_FALSE));
-    //     }
-    //     // write_u8(out, pmtv::cast<bool>(obj) ? 0 : 1); // legacy pmt serializes True as 0 ?!?!?!
-    // } else if (std::holds_alternative<int32_t>(obj)) {
-    //     write_u8(out, static_cast<uint8_t>(legacy_tag::LEGACY_PMT_INT32));
-    //     write_u32(out, static_cast<uint32_t>(pmtv::cast<int32_t>(obj)));
-    // } else if (std::holds_alternative<int64_t>(obj)) {
-    //     write_u8(out, static_cast<uint8_t>(legacy_tag::LEGACY_PMT_INT64));
-    //     write_u64(out, static_cast<uint64_t>(pmtv::cast<int64_t>(obj)));
-    // } else if (std::holds_alternative<double>(obj)) {
-    //     write_u8(out, static_cast<uint8_t>(legacy_tag::LEGACY_PMT_DOUBLE));
-    //     write_double(out, pmtv::cast<double>(obj));
-    // } else if (std::holds_alternative<std::string>(obj)) {
-    //     write_u8(out, static_cast<uint8_t>(legacy_tag::LEGACY_PMT_SYMBOL));
-    //     const auto& str = pmtv::cast<std::string>(obj);
-    //     write_u16(out, static_cast<uint32_t>(str.size()));
-    //     out.insert(out.end(), str.begin(), str.end());
-    // } else {
-    //     throw std::runtime_error("Unsupported pmtv::pmt type for legacy serialization (yet)");
-    // }
+size_t serialize_to_legacy(const pmtv::pmt& obj, uint8_t* out, size_t capacity) {
+    size_t size = legacy_serialized_size(obj);
+    if (size > capacity)
+        throw std::length_error("Buffer too small for legacy PMT serialization");
 
-    return out;
+    uint8_t* ptr = out;
+    serialize_unchecked(obj, ptr);
+    return static_cast<size_t>(ptr - out);
 }
 
-
-template <typename T>
-requires std::is_integral_v<T> && (!std::is_same_v<T, bool>)
-T from_big_endian_integral_to_native(T value) {
-    if constexpr (std::endian::native == std::endian::little) {
-        if constexpr (sizeof(T) == 1) {
-            return value; // Single byte, no swap needed
-        } else if constexpr (sizeof(T) == 2) {
-            return static_cast<T>(
-                ((static_cast<uint16_t>(value) & 0xFF00) >> 8) |
-                ((static_cast<uint16_t>(value) & 0x00FF) << 8)
-            );
-        } else if constexpr (sizeof(T) == 4) {
-            return static_cast<T>(
-                ((static_cast<uint32_t>(value) & 0xFF000000) >> 24) |
-                ((static_cast<uint32_t>(value) & 0x00FF0000) >> 8) |
-                ((static_cast<uint32_t>(value) & 0x0000FF00) << 8) |
-                ((static_cast<uint32_t>(value) & 0x000000FF) << 24)
-            );
-        } else if constexpr (sizeof(T) == 8) {
-            uint64_t u64_val = static_cast<uint64_t>(value);
-            return static_cast<T>(
-                ((u64_val & 0xFF00000000000000ULL) >> 56) |
-                ((u64_val & 0x00FF000000000000ULL) >> 40) |
-                ((u64_val & 0x0000FF0000000000ULL) >> 24) |
-                ((u64_val & 0x000000FF00000000ULL) >> 8)  |
-                ((u64_val & 0x00000000FF000000ULL) << 8)  |
-                ((u64_val & 0x0000000000FF0000ULL) << 24) |
-                ((u64_val & 0x000000000000FF00ULL) << 40) |
-                ((u64_val & 0x00000000000000FFULL) << 56)
-            );
-        } else {
-            // Generic byte swap for other integral sizes
-            std::vector<uint8_t> bytes(sizeof(T));
-            std::memcpy(bytes.data(), &value, sizeof(T));
-            std::reverse(bytes.begin(), bytes.end()); // Reverse to convert big-endian to native
-            T result;
-            std::memcpy(&result, bytes.data(), sizeof(T));
-            return result;
-        }
-    }
-    return value; // No swap needed if native is big-endian
+void detail::serialize_legacy_sized(const pmtv::pmt& obj, uint8_t* out) {
+    serialize_unchecked(obj, out);
 }
 
+std::vector<uint8_t> serialize_to_legacy(const pmtv::pmt& obj) {
+    std::vector<uint8_t> out(legacy_serialized_size(obj));
+    uint8_t* ptr = out.data();
+    serialize_unchecked(obj, ptr);
+    return out;
+}
 
-// Function to deserialize from a big-endian byte stream into a single object of type T
-template <typename T>
-requires std::is_trivially_copyable_v<T>
-T deserialize_from_big_endian(const uint8_t*& ptr) { // ptr is passed by reference to advance it
-    T result;
-
-    if constexpr (std::is_integral_v<T> && !std::is_same_v<T, bool>) {
-        // Read bytes directly into an integral variable
-        T temp_val;
-        std::memcpy(&temp_val, ptr, sizeof(T));
-        result = from_big_endian_integral_to_native(temp_val);
-    } else if constexpr (std::is_floating_point_v<T>) {
-        // Use std::bit_cast for floating-point types
-        if constexpr (sizeof(T) == sizeof(uint32_t)) { // For float
-            uint32_t int_repr;
-            std::memcpy(&int_repr, ptr, sizeof(uint32_t));
-            uint32_t native_endian_int = from_big_endian_integral_to_native(int_repr);
-            result = std::bit_cast<T>(native_endian_int);
-        } else if constexpr (sizeof(T) == sizeof(uint64_t)) { // For double
-            uint64_t int_repr;
-            std::memcpy(&int_repr, ptr, sizeof(uint64_t));
-            uint64_t native_endian_int = from_big_endian_integral_to_native(int_repr);
-            result = std::bit_cast<T>(native_endian_int);
-        } else {
-            // Fallback for other floating point types
-            std::cout << "Warning: Unsupported floating point size for deserialization." << std::endl;
-            // For now, just copy raw bytes (will be platform native endianness if not swapped)
-            std::memcpy(&result, ptr, sizeof(T));
-        }
-    } else if constexpr (std::is_same_v<T, std::complex<float>>) {
-        // Deserialize real and imaginary parts separately
-        float real_part = deserialize_from_big_endian<float>(ptr);
-        float imag_part = deserialize_from_big_endian<float>(ptr);
-        result = std::complex<float>(real_part, imag_part);
-        // Important: ptr was advanced by inner calls, so we don't advance it again here.
-        return result; // Return early because ptr is already advanced
-    } else if constexpr (std::is_same_v<T, std::complex<double>>) {
-        // Deserialize real and imaginary parts separately
-        double real_part = deserialize_from_big_endian<double>(ptr);
-        double imag_part = deserialize_from_big_endian<double>(ptr);
-        result = std::complex<double>(real_part, imag_part);
-        // Important: ptr was advanced by inner calls, so we don't advance it again here.
-        return result; // Return early
-    }
-    // For other trivially copyable types (e.g., structs that are themselves flat byte representations
-    // and don't need internal member endian conversion), just copy directly.
-    // If a struct has internal members that require endian conversion, you'd need to
-    // deserialize each member individually.
-    else {
-        // Default: just copy the bytes directly
-        std::memcpy(&result, ptr, sizeof(T));
-    }
 
-    // Advance the pointer for the next read, unless it's handled by recursive calls
-    ptr += sizeof(T);
-    return result;
+// Elements are fixed size, so large payloads split trivially across threads
+template <typename VTYPE>
+void decode_payload(const uint8_t* ptr, size_t num_elements, VTYPE* dst) {
+    const chunk_plan plan = plan_chunks(num_elements, sizeof(VTYPE));
+    for_each_chunk(plan, num_elements, [&](size_t, size_t first, size_t count) {
+        decode_big_endian_block(ptr + first * sizeof(VTYPE), count, dst + first);
+    });
 }
 
 // Main function to create the vector
 template <typename VTYPE>
-std::vector<VTYPE> create_vector_from_big_endian(const uint8_t* ptr, size_t num_elements) {
-    std::vector<VTYPE> vec;
-    vec.reserve(num_elements); // Pre-allocate for efficiency
+std::vector<VTYPE> create_vector_from_big_endian(const uint8_t* ptr, size_t num_elements, checksum_state* cs = nullptr) {
+    std::vector<VTYPE> vec(num_elements);
+    if (!cs) {
+        decode_payload(ptr, num_elements, vec.data());
+        return vec;
+    }
 
-    for (size_t i = 0; i < num_elements; ++i) {
-        vec.push_back(deserialize_from_big_endian<VTYPE>(ptr));
+    const chunk_plan plan = plan_chunks(num_elements, sizeof(VTYPE));
+    fold_checksum(*cs, ptr);
+    if (plan.num_chunks <= 1) {
+        cs->crc = decode_block_checksummed(ptr, num_elements, vec.data(), cs->crc);
+    } else {
+        std::vector<uint32_t> crcs(plan.num_chunks);
+        for_each_chunk(plan, num_elements, [&](size_t chunk, size_t first, size_t count) {
+            crcs[chunk] = decode_block_checksummed(ptr + first * sizeof(VTYPE), count, vec.data() + first, 0);
+        });
+        combine_chunk_checksums(*cs, plan, crcs, num_elements, sizeof(VTYPE));
     }
+    cs->mark = ptr + num_elements * sizeof(VTYPE);
     return vec;
 }
 
+// Subtrees defined so far in a deduplicated message, and how far references
+// have expanded it
+struct dedup_state {
+    struct def {
+        std::optional<pmtv::pmt> value;
+        size_t size = 0; // expanded encoded size
+    };
+    std::vector<def> defs;
+    // Expanded size beyond the bytes consumed: what references added over their own 5 bytes
+    size_t extra = 0;
+    size_t limit = 0;
+};
 
+struct decode_context {
+    const uint8_t* begin;
+    const uint8_t* end;
+    checksum_state* checksum;
+    // Null for plain legacy
+    dedup_state* dedup = nullptr;
+    size_t max_depth = legacy_max_depth;
+};
 
-// --- Deserialization: basic types ---
-pmtv::pmt deserialize_from_legacy(const uint8_t* data, size_t size) {
-    const uint8_t* ptr = data;
+static std::string offset_suffix(const uint8_t* ptr, const decode_context& ctx) {
+    return " at offset " + std::to_string(ptr - ctx.begin);
+}
 
-    if (size == 0)
-        throw std::runtime_error("Empty legacy PMT buffer");
+static void require_bytes(const uint8_t* ptr, const decode_context& ctx, size_t n) {
+    if (static_cast<size_t>(ctx.end - ptr) < n)
+        throw std::runtime_error("Truncated legacy PMT buffer" + offset_suffix(ptr, ctx));
+}
+
+static void require_depth(const uint8_t* ptr, const decode_context& ctx, size_t depth) {
+    if (depth > ctx.max_depth)
+        throw std::runtime_error("Legacy PMT nested deeper than " + std::to_string(ctx.max_depth) + " levels" +
+                                 offset_suffix(ptr, ctx));
+}
+
+// Extents from the shape extension in a uniform vector's padding; empty if the
+// padding carries none, as in everything GR3 writes
+static std::vector<size_t> read_shape(const uint8_t* pad, size_t npad, size_t len, const decode_context& ctx) {
+    if (npad < uniform_shape_pad_size(0) || pad[0] != uniform_shape_marker)
+        return {};
+    size_t rank = pad[1];
+    if (npad != uniform_shape_pad_size(rank))
+        throw std::runtime_error("Malformed legacy PMT tensor shape" + offset_suffix(pad, ctx));
+
+    std::vector<size_t> extents(rank);
+    const uint8_t* p = pad + 4;
+    size_t count = 1;
+    for (size_t& e : extents) {
+        e = read_u32(p);
+        if (e != 0 && count > std::numeric_limits<uint32_t>::max() / e)
+            throw std::runtime_error("Legacy PMT tensor shape does not match its length" + offset_suffix(pad, ctx));
+        count *= e;
+    }
+    if (rank == 0 || count != len)
+        throw std::runtime_error("Legacy PMT tensor shape does not match its length" + offset_suffix(pad, ctx));
+    return extents;
+}
+
+struct uniform_vector_header {
+    legacy_uniform_type dtype;
+    size_t len;
+    std::vector<size_t> extents;
+};
+
+// Everything after the UNIFORM_VECTOR tag up to the first element
+static uniform_vector_header read_uniform_vector_header(const uint8_t*& ptr, const decode_context& ctx) {
+    require_bytes(ptr, ctx, 1 + 4 + 1);
+    uniform_vector_header h;
+    h.dtype = static_cast<legacy_uniform_type>(ptr[0]);
+    if (legacy_uniform_element_size(h.dtype) == 0)
+        throw std::runtime_error("Unsupported or unknown legacy PMT uniform vector tag " +
+                                 std::to_string(static_cast<int>(h.dtype)) + offset_suffix(ptr, ctx));
+    ptr += 1;
+    h.len = read_u32(ptr);
+    uint8_t npad = *ptr++;
+    require_bytes(ptr, ctx, npad);
+    h.extents = read_shape(ptr, npad, h.len, ctx);
+    ptr += npad;
+    return h;
+}
+
+// Calls fn(std::type_identity<T>{}) with the element type of a known dtype
+template <typename F>
+decltype(auto) visit_uniform_type(legacy_uniform_type dtype, F&& fn) {
+    switch (dtype) {
+        case legacy_uniform_type::U8:  return fn(std::type_identity<uint8_t>{});
+        case legacy_uniform_type::S8:  return fn(std::type_identity<int8_t>{});
+        case legacy_uniform_type::U16: return fn(std::type_identity<uint16_t>{});
+        case legacy_uniform_type::S16: return fn(std::type_identity<int16_t>{});
+        case legacy_uniform_type::U32: return fn(std::type_identity<uint32_t>{});
+        case legacy_uniform_type::S32: return fn(std::type_identity<int32_t>{});
+        case legacy_uniform_type::U64: return fn(std::type_identity<uint64_t>{});
+        case legacy_uniform_type::S64: return fn(std::type_identity<int64_t>{});
+        case legacy_uniform_type::F32: return fn(std::type_identity<float>{});
+        case legacy_uniform_type::F64: return fn(std::type_identity<double>{});
+        case legacy_uniform_type::C32: return fn(std::type_identity<std::complex<float>>{});
+        case legacy_uniform_type::C64: return fn(std::type_identity<std::complex<double>>{});
+        default:
+            throw std::runtime_error("Unsupported or unknown legacy PMT uniform vector tag " +
+                                     std::to_string(static_cast<int>(dtype)));
+    }
+}
+
+template <typename VTYPE>
+pmtv::pmt deserialize_uniform_vector(const uint8_t*& ptr, const decode_context& ctx, size_t len,
+                                     const std::vector<size_t>& extents) {
+    require_bytes(ptr, ctx, len * sizeof(VTYPE));
+    std::vector<VTYPE> vec = create_vector_from_big_endian<VTYPE>(ptr, len, ctx.checksum);
+    ptr += len * sizeof(VTYPE);
+    pmtv::Tensor<VTYPE> tensor(std::move(vec));
+    if (extents.size() > 1)
+        tensor.reshape(extents);
+    return tensor;
+}
+
+static pmtv::pmt deserialize_node(const uint8_t*& ptr, const decode_context& ctx, size_t depth);
+
+// A legacy dict is a chain of DICT (key . value) links terminated by NULL.
+// The leading DICT tag has already been consumed by the caller.
+static map_t deserialize_dict(const uint8_t*& ptr, const decode_context& ctx, size_t depth) {
+    map_t m;
+    while (true) {
+        require_bytes(ptr, ctx, 1);
+        if (static_cast<legacy_tag>(*ptr++) != legacy_tag::LEGACY_PMT_PAIR)
+            throw std::runtime_error("Malformed legacy PMT dict entry" + offset_suffix(ptr - 1, ctx));
+
+        const uint8_t* key_start = ptr;
+        pmtv::pmt key = deserialize_node(ptr, ctx, depth + 1);
+        auto* sym = std::get_if<std::string>(&key);
+        if (!sym)
+            throw std::runtime_error("Legacy PMT dict keys must be symbols" + offset_suffix(key_start, ctx));
+        pmtv::pmt value = deserialize_node(ptr, ctx, depth + 1);
+        m.insert_or_assign(std::move(*sym), std::move(value));
+
+        require_bytes(ptr, ctx, 1);
+        auto link = static_cast<legacy_tag>(*ptr++);
+        if (link == legacy_tag::LEGACY_PMT_NULL)
+            return m;
+        if (link != legacy_tag::LEGACY_PMT_DICT)
+            throw std::runtime_error("Malformed legacy PMT dict" + offset_suffix(ptr - 1, ctx));
+    }
+}
+
+// --- Deserialization: basic types ---
+static pmtv::pmt deserialize_node(const uint8_t*& ptr, const decode_context& ctx, size_t depth) {
+    require_bytes(ptr, ctx, 1);
+    require_depth(ptr, ctx, depth);
 
     auto tag = static_cast<legacy_tag>(*ptr++);
     pmtv::pmt ret;
@@ -542,105 +556,437 @@ pmtv::pmt deserialize_from_legacy(const uint8_t* data, size_t size) {
             ret = false;
             return ret;
         case legacy_tag::LEGACY_PMT_INT32:
+            require_bytes(ptr, ctx, 4);
             ret = static_cast<int32_t>(read_u32(ptr));
             return ret;
         case legacy_tag::LEGACY_PMT_INT64:
+            require_bytes(ptr, ctx, 8);
             ret = static_cast<int64_t>(read_u64(ptr));
             return ret;
         case legacy_tag::LEGACY_PMT_DOUBLE:
+            require_bytes(ptr, ctx, 8);
             ret = read_double(ptr);
             return ret;
         case legacy_tag::LEGACY_PMT_SYMBOL: {
+            require_bytes(ptr, ctx, 2);
             uint16_t len = (ptr[0] << 8) | (ptr[1] << 0);
             ptr += 2;
-            std::string sym(reinterpret_cast<const char*>(ptr), len);
+            require_bytes(ptr, ctx, len);
+            ret = std::string(reinterpret_cast<const char*>(ptr), len);
             ptr += len;
-            ret = sym;
             return ret;
         }
         case legacy_tag::LEGACY_PMT_UNIFORM_VECTOR: {
-            legacy_uniform_type dtype = static_cast<legacy_uniform_type>(ptr[0]);
-            ptr += 1;
-            uint16_t len = read_u32(ptr); // ptr is incremented inside read_u32
-            uint8_t npad = ptr[0]; ptr += 1;
-            ptr += npad;
-
-            switch (dtype) {
-                case legacy_uniform_type::U8: {
-                    using VTYPE = uint8_t;
-                    std::vector<VTYPE> vec = create_vector_from_big_endian<VTYPE>(ptr, len);
-                    ret = pmtv::Tensor<VTYPE>(vec);
-                    break;
-                }
-                case legacy_uniform_type::S8: {
-                    using VTYPE = int8_t;
-                    std::vector<VTYPE> vec = create_vector_from_big_endian<VTYPE>(ptr, len);
-                    ret = pmtv::Tensor<VTYPE>(vec); break;
-                }
-                case legacy_uniform_type::U16: {
-                    using VTYPE = uint16_t;
-                    std::vector<VTYPE> vec = create_vector_from_big_endian<VTYPE>(ptr, len);
-                    ret = pmtv::Tensor<VTYPE>(vec); break;
-                }
-                case legacy_uniform_type::S16: {
-                    using VTYPE = int16_t;
-                    std::vector<VTYPE> vec = create_vector_from_big_endian<VTYPE>(ptr, len);
-                    ret = pmtv::Tensor<VTYPE>(vec); break;
-                }
-                case legacy_uniform_type::U32: {
-                    using VTYPE = uint32_t;
-                    std::vector<VTYPE> vec = create_vector_from_big_endian<VTYPE>(ptr, len);
-                    ret = pmtv::Tensor<VTYPE>(vec); break;
-                }
-                case legacy_uniform_type::S32: {
-                    using VTYPE = int32_t;
-                    std::vector<VTYPE> vec = create_vector_from_big_endian<VTYPE>(ptr, len);
-                    ret = pmtv::Tensor<VTYPE>(vec); break;
-                }
-                case legacy_uniform_type::U64: {
-                    using VTYPE = uint64_t;
-                    std::vector<VTYPE> vec = create_vector_from_big_endian<VTYPE>(ptr, len);
-                    ret = pmtv::Tensor<VTYPE>(vec); break;
-                }
-                case legacy_uniform_type::S64: {
-                    using VTYPE = int64_t;
-                    std::vector<VTYPE> vec = create_vector_from_big_endian<VTYPE>(ptr, len);
-                    ret = pmtv::Tensor<VTYPE>(vec); break;
-                }                                                                                                                           
-                case legacy_uniform_type::F32: {
-                    using VTYPE = float;
-                    std::vector<VTYPE> vec = create_vector_from_big_endian<VTYPE>(ptr, len);
-                    ret = pmtv::Tensor<VTYPE>(vec); break;
-                }    
-                case legacy_uniform_type::F64: {
-                    using VTYPE = double;
-                    std::vector<VTYPE> vec = create_vector_from_big_endian<VTYPE>(ptr, len);
-                    ret = pmtv::Tensor<VTYPE>(vec); break;
-                }   
-                case legacy_uniform_type::C32: {
-                    using VTYPE = std::complex<float>;
-                    std::vector<VTYPE> vec = create_vector_from_big_endian<VTYPE>(ptr, len);
-                    ret = pmtv::Tensor<VTYPE>(vec); break;
-                }    
-                case legacy_uniform_type::C64: {
-                    using VTYPE = std::complex<double>;
-                    std::vector<VTYPE> vec = create_vector_from_big_endian<VTYPE>(ptr, len);
-                    ret = pmtv::Tensor<VTYPE>(vec); break;
-                }             
-                default: {
-                    throw std::runtime_error("Unsupported or unknown legacy PMT uniform vector tag");
-                }                      
-            }
-            return ret;
-
-
+            uniform_vector_header h = read_uniform_vector_header(ptr, ctx);
+            return visit_uniform_type(h.dtype, [&]<typename T>(std::type_identity<T>) {
+                return deserialize_uniform_vector<T>(ptr, ctx, h.len, h.extents);
+            });
         }
         case legacy_tag::LEGACY_PMT_DICT: {
-            throw std::runtime_error("No Deserialization defined for Legacy pmt dict");
+            ret = deserialize_dict(ptr, ctx, depth);
+            return ret;
+        }
+        case legacy_tag::LEGACY_PMT_DEF: {
+            if (!ctx.dedup)
+                break;
+            auto& defs = ctx.dedup->defs;
+            // The id is taken before decoding, so nested definitions number after it
+            size_t id = defs.size();
+            defs.emplace_back();
+            const uint8_t* start = ptr;
+            size_t extra = ctx.dedup->extra;
+            ret = deserialize_node(ptr, ctx, depth + 1);
+            defs[id].value = ret;
+            defs[id].size = static_cast<size_t>(ptr - start) + (ctx.dedup->extra - extra);
+            return ret;
+        }
+        case legacy_tag::LEGACY_PMT_REF: {
+            if (!ctx.dedup)
+                break;
+            auto& defs = ctx.dedup->defs;
+            require_bytes(ptr, ctx, 4);
+            size_t id = read_u32(ptr);
+            if (id >= defs.size() || !defs[id].value)
+                throw std::runtime_error("Deduplicated legacy PMT references undefined node " + std::to_string(id) +
+                                         offset_suffix(ptr - 5, ctx));
+            // Consumed bytes never exceed the input, so only references can exceed the limit
+            size_t expanded = static_cast<size_t>(ptr - ctx.begin) + ctx.dedup->extra;
+            if (defs[id].size > ctx.dedup->limit - std::min(ctx.dedup->limit, expanded))
+                throw std::runtime_error("Deduplicated legacy PMT expands beyond " +
+                                         std::to_string(ctx.dedup->limit) + " bytes" + offset_suffix(ptr - 5, ctx));
+            ctx.dedup->extra += defs[id].size - std::min<size_t>(defs[id].size, 5);
+            ret = *defs[id].value;
+            return ret;
         }
         default:
-            throw std::runtime_error("Unsupported or unknown legacy PMT tag");
+            break;
+    }
+    // DEF/REF only mean something inside a deduplicated message
+    throw std::runtime_error("Unsupported or unknown legacy PMT tag " + std::to_string(static_cast<int>(tag)) +
+                             offset_suffix(ptr - 1, ctx));
+}
+
+pmtv::pmt deserialize_from_legacy(const uint8_t* data, size_t size) {
+    if (size == 0)
+        throw std::runtime_error("Empty legacy PMT buffer");
+
+    const uint8_t* ptr = data;
+    return deserialize_node(ptr, {data, data + size, nullptr}, 0);
+}
+
+// Containers recurse into their elements with depth + 1; the last element of a
+// pair and the links of a dict chain are walked in the loop, so long lists
+// cost no stack
+static void skip_node(const uint8_t*& ptr, const decode_context& ctx, size_t depth) {
+    require_depth(ptr, ctx, depth);
+    while (true) {
+        require_bytes(ptr, ctx, 1);
+        const uint8_t* start = ptr;
+        auto tag = static_cast<legacy_tag>(*ptr++);
+
+        switch (tag) {
+            case legacy_tag::LEGACY_PMT_TRUE:
+            case legacy_tag::LEGACY_PMT_FALSE:
+            case legacy_tag::LEGACY_PMT_NULL:
+                return;
+            case legacy_tag::LEGACY_PMT_INT32:
+                require_bytes(ptr, ctx, 4);
+                ptr += 4;
+                return;
+            case legacy_tag::LEGACY_PMT_INT64:
+            case legacy_tag::LEGACY_PMT_UINT64:
+            case legacy_tag::LEGACY_PMT_DOUBLE:
+                require_bytes(ptr, ctx, 8);
+                ptr += 8;
+                return;
+            case legacy_tag::LEGACY_PMT_COMPLEX:
+                require_bytes(ptr, ctx, 16);
+                ptr += 16;
+                return;
+            case legacy_tag::LEGACY_PMT_SYMBOL: {
+                require_bytes(ptr, ctx, 2);
+                size_t len = (ptr[0] << 8) | ptr[1];
+                ptr += 2;
+                require_bytes(ptr, ctx, len);
+                ptr += len;
+                return;
+            }
+            case legacy_tag::LEGACY_PMT_PAIR:
+                skip_node(ptr, ctx, depth + 1);
+                continue; // cdr
+            case legacy_tag::LEGACY_PMT_VECTOR:
+            case legacy_tag::LEGACY_PMT_TUPLE: {
+                require_bytes(ptr, ctx, 4);
+                size_t len = read_u32(ptr);
+                for (size_t i = 0; i < len; ++i)
+                    skip_node(ptr, ctx, depth + 1);
+                return;
+            }
+            case legacy_tag::LEGACY_PMT_DICT:
+                while (true) {
+                    require_bytes(ptr, ctx, 1);
+                    if (static_cast<legacy_tag>(*ptr++) != legacy_tag::LEGACY_PMT_PAIR)
+                        throw std::runtime_error("Malformed legacy PMT dict entry" + offset_suffix(ptr - 1, ctx));
+                    skip_node(ptr, ctx, depth + 1);
+                    skip_node(ptr, ctx, depth + 1);
+                    require_bytes(ptr, ctx, 1);
+                    auto link = static_cast<legacy_tag>(*ptr++);
+                    if (link == legacy_tag::LEGACY_PMT_NULL)
+                        return;
+                    if (link != legacy_tag::LEGACY_PMT_DICT)
+                        throw std::runtime_error("Malformed legacy PMT dict" + offset_suffix(ptr - 1, ctx));
+                }
+            case legacy_tag::LEGACY_PMT_UNIFORM_VECTOR: {
+                require_bytes(ptr, ctx, 1 + 4 + 1);
+                auto dtype = static_cast<legacy_uniform_type>(*ptr);
+                size_t width = legacy_uniform_element_size(dtype);
+                if (width == 0)
+                    throw std::runtime_error("Unsupported or unknown legacy PMT uniform vector tag " +
+                                             std::to_string(static_cast<int>(dtype)) + offset_suffix(ptr, ctx));
+                ptr += 1;
+                size_t len = read_u32(ptr);
+                uint8_t npad = *ptr++;
+                require_bytes(ptr, ctx, npad);
+                ptr += npad;
+                if (len > static_cast<size_t>(ctx.end - ptr) / width)
+                    throw std::runtime_error("Truncated legacy PMT buffer" + offset_suffix(ptr, ctx));
+                ptr += len * width;
+                return;
+            }
+            default:
+                throw std::runtime_error("Unsupported or unknown legacy PMT tag " +
+                                         std::to_string(static_cast<int>(tag)) + offset_suffix(start, ctx));
+        }
     }
 }
 
+size_t legacy_encoded_size(const uint8_t* data, size_t size) {
+    if (size == 0)
+        throw std::runtime_error("Empty legacy PMT buffer");
+
+    const uint8_t* ptr = data;
+    skip_node(ptr, {data, data + size, nullptr}, 0);
+    return static_cast<size_t>(ptr - data);
+}
+
+// --- Deduplicated mode ---
+pmtv::pmt deserialize_deduplicated(const uint8_t* data, size_t size, size_t max_expansion) {
+    if (!is_deduplicated(data, size))
+        return deserialize_from_legacy(data, size);
+    if (size == dedup_header_size)
+        throw std::runtime_error("Empty deduplicated legacy PMT");
+
+    const uint8_t* body = data + dedup_header_size;
+    const uint8_t* ptr = body;
+    dedup_state dedup;
+    dedup.limit = detail::dedup_expansion_limit(size, max_expansion);
+    return deserialize_node(ptr, {body, data + size, nullptr, &dedup}, 0);
+}
+
+// --- PDU mode ---
+static size_t pdu_payload_size(const detail::pdu_payload& payload) {
+    return uniform_vector_size(payload.extents, payload.count, legacy_uniform_element_size(payload.dtype));
+}
+
+static void serialize_pdu_payload(const detail::pdu_payload& payload, uint8_t*& out) {
+    write_uniform_vector_header(out, payload.dtype, payload.count, payload.extents);
+    visit_uniform_type(payload.dtype, [&]<typename T>(std::type_identity<T>) {
+        encode_payload(reinterpret_cast<const T*>(payload.data), payload.count, out, nullptr);
+    });
+    out += payload.count * legacy_uniform_element_size(payload.dtype);
+}
+
+size_t detail::pdu_size(const map_t& meta, const pdu_payload& payload) {
+    // GR3 writes missing metadata as NULL rather than an empty dict
+    return 1 + (meta.empty() ? 1 : map_serialized_size(meta)) + pdu_payload_size(payload);
+}
+
+size_t detail::serialize_pdu(const map_t& meta, const pdu_payload& payload, uint8_t* out, size_t capacity) {
+    size_t size = pdu_size(meta, payload);
+    if (size > capacity)
+        throw std::length_error("Buffer too small for legacy PDU serialization");
+
+    uint8_t* ptr = out;
+    write_u8(ptr, static_cast<uint8_t>(legacy_tag::LEGACY_PMT_PAIR));
+    if (meta.empty())
+        write_u8(ptr, static_cast<uint8_t>(legacy_tag::LEGACY_PMT_NULL));
+    else
+        serialize_map_unchecked(meta, ptr);
+    serialize_pdu_payload(payload, ptr);
+    return size;
+}
+
+detail::parsed_pdu detail::parse_pdu(const uint8_t* data, size_t size) {
+    if (size == 0)
+        throw std::runtime_error("Empty legacy PMT buffer");
+
+    const decode_context ctx{data, data + size, nullptr};
+    const uint8_t* ptr = data;
+    if (static_cast<legacy_tag>(*ptr++) != legacy_tag::LEGACY_PMT_PAIR)
+        throw std::runtime_error("Not a legacy PDU: expected a pair" + offset_suffix(data, ctx));
+
+    parsed_pdu pdu;
+    require_bytes(ptr, ctx, 1);
+    auto car = static_cast<legacy_tag>(*ptr++);
+    if (car == legacy_tag::LEGACY_PMT_DICT)
+        pdu.meta = deserialize_dict(ptr, ctx, 1);
+    else if (car != legacy_tag::LEGACY_PMT_NULL)
+        throw std::runtime_error("Legacy PDU metadata must be a dict" + offset_suffix(ptr - 1, ctx));
+
+    require_bytes(ptr, ctx, 1);
+    if (static_cast<legacy_tag>(*ptr++) != legacy_tag::LEGACY_PMT_UNIFORM_VECTOR)
+        throw std::runtime_error("Legacy PDU payload must be a uniform vector" + offset_suffix(ptr - 1, ctx));
+    uniform_vector_header h = read_uniform_vector_header(ptr, ctx);
+    require_bytes(ptr, ctx, h.len * legacy_uniform_element_size(h.dtype));
+
+    pdu.dtype = h.dtype;
+    pdu.count = h.len;
+    pdu.extents = std::move(h.extents);
+    pdu.payload = ptr;
+    return pdu;
+}
+
+void detail::decode_pdu_payload(const parsed_pdu& pdu, uint8_t* out) {
+    visit_uniform_type(pdu.dtype, [&]<typename T>(std::type_identity<T>) {
+        decode_payload(pdu.payload, pdu.count, reinterpret_cast<T*>(out));
+    });
+}
+
+bool is_legacy_pdu(const uint8_t* data, size_t size) {
+    if (size < 3 || static_cast<legacy_tag>(data[0]) != legacy_tag::LEGACY_PMT_PAIR)
+        return false;
+    auto car = static_cast<legacy_tag>(data[1]);
+    if (car != legacy_tag::LEGACY_PMT_DICT && car != legacy_tag::LEGACY_PMT_NULL)
+        return false;
+
+    const uint8_t* ptr = data + 1;
+    try {
+        skip_node(ptr, {data, data + size, nullptr}, 1);
+    } catch (const std::runtime_error&) {
+        return false;
+    }
+    return ptr < data + size && static_cast<legacy_tag>(*ptr) == legacy_tag::LEGACY_PMT_UNIFORM_VECTOR;
+}
+
+std::pair<map_t, pmtv::pmt> deserialize_pdu(const uint8_t* data, size_t size) {
+    detail::parsed_pdu pdu = detail::parse_pdu(data, size);
+    pmtv::pmt payload = visit_uniform_type(pdu.dtype, [&]<typename T>(std::type_identity<T>) -> pmtv::pmt {
+        std::vector<T> vec(pdu.count);
+        decode_payload(pdu.payload, pdu.count, vec.data());
+        pmtv::Tensor<T> tensor(std::move(vec));
+        if (pdu.extents.size() > 1)
+            tensor.reshape(pdu.extents);
+        return tensor;
+    });
+    return {std::move(pdu.meta), std::move(payload)};
+}
+
+std::vector<uint8_t> serialize_pdu(const map_t& meta, const pmtv::pmt& data) {
+    return std::visit([&meta](const auto& val) -> std::vector<uint8_t> {
+        using T = std::decay_t<decltype(val)>;
+        if constexpr (UniformVector<T>)
+            return serialize_pdu(meta, val);
+        else
+            throw std::runtime_error("Legacy PDU payload must be a Tensor");
+    }, data);
+}
+
+std::span<const uint8_t> pdu_encoder::encode(const map_t& meta, const pmtv::pmt& data) {
+    return std::visit([this, &meta](const auto& val) -> std::span<const uint8_t> {
+        using T = std::decay_t<decltype(val)>;
+        if constexpr (UniformVector<T>)
+            return encode_erased(meta, detail::erase_payload(val));
+        else
+            throw std::runtime_error("Legacy PDU payload must be a Tensor");
+    }, data);
+}
+
+bool pdu_encoder::key_cached(size_t i, const std::string& key) const {
+    const uint8_t* cached = _prefixes.data() + _key_offsets[i] + 2 + symbol_header_size;
+    size_t len = _key_offsets[i + 1] - _key_offsets[i] - 2 - symbol_header_size;
+    return key.size() == len && std::memcmp(cached, key.data(), len) == 0;
+}
+
+void pdu_encoder::cache_keys(const map_t& meta) {
+    _prefixes.clear();
+    _key_offsets.clear();
+    for (const auto& [key, value] : meta) {
+        if (key.size() > std::numeric_limits<uint16_t>::max())
+            throw std::runtime_error("Symbol too long for legacy serialization");
+        _key_offsets.push_back(_prefixes.size());
+        _prefixes.resize(_prefixes.size() + 2 + symbol_header_size + key.size());
+        uint8_t* p = _prefixes.data() + _key_offsets.back();
+        write_u8(p, static_cast<uint8_t>(legacy_tag::LEGACY_PMT_DICT));
+        write_u8(p, static_cast<uint8_t>(legacy_tag::LEGACY_PMT_PAIR));
+        write_symbol(p, key);
+    }
+    _key_offsets.push_back(_prefixes.size());
+    ++_misses;
+}
+
+std::span<const uint8_t> pdu_encoder::encode_erased(const map_t& meta, const detail::pdu_payload& payload) {
+    // Keys are checked against the cache in the same pass that sizes the values
+    bool cached = meta.size() + 1 == _key_offsets.size();
+    size_t size = 1 + 1 + pdu_payload_size(payload);
+    size_t i = 0;
+    for (const auto& [key, value] : meta) {
+        cached = cached && key_cached(i++, key);
+        size += legacy_serialized_size(value);
+    }
+    if (!cached)
+        cache_keys(meta);
+    size += _prefixes.size();
+    if (_buf.size() < size)
+        _buf.resize(size);
+
+    uint8_t* ptr = _buf.data();
+    write_u8(ptr, static_cast<uint8_t>(legacy_tag::LEGACY_PMT_PAIR));
+    i = 0;
+    for (const auto& [key, value] : meta) {
+        size_t n = _key_offsets[i + 1] - _key_offsets[i];
+        std::memcpy(ptr, _prefixes.data() + _key_offsets[i], n);
+        ptr += n;
+        ++i;
+        serialize_unchecked(value, ptr);
+    }
+    // An empty dict is NULL; a non-empty one ends with it
+    write_u8(ptr, static_cast<uint8_t>(legacy_tag::LEGACY_PMT_NULL));
+    serialize_pdu_payload(payload, ptr);
+    return {_buf.data(), size};
+}
+
+// --- Framed mode ---
+static constexpr uint8_t frame_magic[3] = {'L', 'P', 'F'};
+static constexpr uint8_t frame_version = 1;
+
+size_t framed_size(const pmtv::pmt& obj) {
+    return frame_header_size + legacy_serialized_size(obj) + frame_trailer_size;
+}
+
+static void serialize_framed_unchecked(const pmtv::pmt& obj, size_t payload_size, uint8_t* out) {
+    std::memcpy(out, frame_magic, sizeof(frame_magic));
+    out += sizeof(frame_magic);
+    write_u8(out, frame_version);
+    write_u32(out, static_cast<uint32_t>(payload_size));
+
+    checksum_state cs{out, 0};
+    serialize_unchecked(obj, out, &cs);
+    fold_checksum(cs, out);
+    write_u32(out, cs.crc);
+}
+
+size_t serialize_framed(const pmtv::pmt& obj, uint8_t* out, size_t capacity) {
+    size_t payload_size = legacy_serialized_size(obj);
+    size_t size = frame_header_size + payload_size + frame_trailer_size;
+    if (size > capacity)
+        throw std::length_error("Buffer too small for framed legacy PMT serialization");
+    if (payload_size > std::numeric_limits<uint32_t>::max())
+        throw std::runtime_error("Legacy PMT too large for a frame");
+
+    serialize_framed_unchecked(obj, payload_size, out);
+    return size;
+}
+
+std::vector<uint8_t> serialize_framed(const pmtv::pmt& obj) {
+    std::vector<uint8_t> out(framed_size(obj));
+    serialize_framed(obj, out.data(), out.size());
+    return out;
+}
+
+pmtv::pmt deserialize_framed(const uint8_t* data, size_t size) {
+    if (size < frame_header_size + frame_trailer_size || std::memcmp(data, frame_magic, sizeof(frame_magic)) != 0 ||
+        data[3] != frame_version)
+        throw legacy_integrity_error("Not a framed legacy PMT");
+
+    const uint8_t* ptr = data + 4;
+    size_t payload_size = read_u32(ptr);
+    if (payload_size != size - frame_header_size - frame_trailer_size)
+        throw legacy_integrity_error("Framed legacy PMT length mismatch: header says " +
+                                     std::to_string(payload_size) + " bytes, frame carries " +
+                                     std::to_string(size - frame_header_size - frame_trailer_size));
+
+    const uint8_t* payload = ptr;
+    const uint8_t* payload_end = payload + payload_size;
+    const uint8_t* trailer = payload_end;
+    uint32_t expected = static_cast<uint32_t>(read_u32(trailer));
+
+    checksum_state cs{payload, 0};
+    pmtv::pmt obj;
+    try {
+        obj = deserialize_node(ptr, {payload, payload_end, &cs}, 0);
+        if (ptr != payload_end)
+            throw std::runtime_error("Trailing bytes after legacy PMT at offset " + std::to_string(ptr - payload));
+    } catch (const std::runtime_error& e) {
+        // Report corruption rather than whatever the garbage decoded into
+        if (crc32c(payload, payload_size) != expected)
+            throw legacy_integrity_error("Framed legacy PMT checksum mismatch");
+        throw;
+    }
+
+    fold_checksum(cs, payload_end);
+    if (cs.crc != expected)
+        throw legacy_integrity_error("Framed legacy PMT checksum mismatch");
+    return obj;
+}
+
 } // namespace legacy_pmt
@@ -0,0 +1,25 @@
+#pragma once
+
+#include <pmtv/pmt.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+
+namespace legacy_pmt::detail {
+
+/**
+ * Encode obj into out, which the caller has sized with legacy_serialized_size(obj),
+ * without walking obj a second time to size it.
+ */
+void serialize_legacy_sized(const pmtv::pmt& obj, uint8_t* out);
+
+/**
+ * Element count of a tensor with these extents, shared by every encoder that
+ * writes the shape extension. Throws std::runtime_error if the rank does not
+ * fit the padding or the count does not fit the u32 length, the same limits
+ * read_shape enforces on decode.
+ */
+size_t uniform_shape_count(std::span<const size_t> extents);
+
+} // namespace legacy_pmt::detail
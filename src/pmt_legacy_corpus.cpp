@@ -0,0 +1,258 @@
+#include <pmt_converter/pmt_legacy_corpus.h>
+#include <pmt_converter/pmt_legacy_format.h>
+
+#include <algorithm>
+#include <bit>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+
+namespace legacy_pmt {
+
+const char* corpus_kind_name(corpus_kind kind) {
+    switch (kind) {
+        case corpus_kind::tag_dict: return "tag_dict";
+        case corpus_kind::pdu_u8: return "pdu_u8";
+        case corpus_kind::pdu_c32: return "pdu_c32";
+        case corpus_kind::c32_burst: return "c32_burst";
+        case corpus_kind::nested_dict: return "nested_dict";
+    }
+    return "unknown";
+}
+
+namespace {
+
+    struct splitmix64 {
+        uint64_t state;
+
+        uint64_t next() {
+            uint64_t z = (state += 0x9e3779b97f4a7c15ULL);
+            z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+            z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+            return z ^ (z >> 31);
+        }
+
+        // Uniform in [0, n); the modulo bias is negligible for corpus work
+        uint64_t below(uint64_t n) { return next() % n; }
+
+        size_t uniform(size_t min, size_t max) { return min + below(max - min + 1); }
+
+        // Pick a power-of-two octave uniformly, then a value inside it
+        size_t log_uniform(const size_range& r) {
+            if (r.min >= r.max)
+                return r.min;
+            size_t lo = std::bit_width(std::max<size_t>(r.min, 1)) - 1;
+            size_t hi = std::bit_width(r.max) - 1;
+            size_t octave = uniform(lo, hi);
+            size_t first = std::max(r.min, size_t{1} << octave);
+            size_t last = std::min(r.max, (size_t{2} << octave) - 1);
+            return uniform(first, last);
+        }
+    };
+
+    // Appends wire-format pieces to a growing message
+    class message_writer {
+    public:
+        explicit message_writer(std::vector<uint8_t>& out) : _out(out) {}
+
+        uint8_t* grow(size_t n) {
+            size_t at = _out.size();
+            _out.resize(at + n);
+            return _out.data() + at;
+        }
+
+        void tag(legacy_tag t) { _out.push_back(static_cast<uint8_t>(t)); }
+
+        void symbol(std::string_view s) {
+            uint8_t* p = grow(symbol_header_size + s.size());
+            write_symbol(p, s);
+        }
+
+        void int32(int32_t v) {
+            uint8_t* p = grow(5);
+            write_u8(p, static_cast<uint8_t>(legacy_tag::LEGACY_PMT_INT32));
+            write_u32(p, static_cast<uint32_t>(v));
+        }
+
+        void int64(int64_t v) {
+            uint8_t* p = grow(9);
+            write_u8(p, static_cast<uint8_t>(legacy_tag::LEGACY_PMT_INT64));
+            write_u64(p, static_cast<uint64_t>(v));
+        }
+
+        void real(double v) {
+            uint8_t* p = grow(9);
+            write_u8(p, static_cast<uint8_t>(legacy_tag::LEGACY_PMT_DOUBLE));
+            write_double(p, v);
+        }
+
+        void boolean(bool v) { tag(v ? legacy_tag::LEGACY_PMT_TRUE : legacy_tag::LEGACY_PMT_FALSE); }
+
+        // Header only; the caller writes count elements of the dtype after it
+        uint8_t* uniform_vector(legacy_uniform_type dtype, size_t count) {
+            uint8_t* p = grow(uniform_vector_header_size + count * legacy_uniform_element_size(dtype));
+            write_uniform_vector_header(p, dtype, count);
+            return p;
+        }
+
+        void dict_entry(std::string_view key) {
+            tag(legacy_tag::LEGACY_PMT_DICT);
+            tag(legacy_tag::LEGACY_PMT_PAIR);
+            symbol(key);
+        }
+
+    private:
+        std::vector<uint8_t>& _out;
+    };
+
+    enum class value_type { int32, int64, real, boolean, symbol };
+
+    struct tag_key {
+        std::string_view name;
+        value_type type;
+    };
+
+    // Keys seen on typical GR3 stream tags and PDU metadata, in key order as
+    // serialize_to_legacy() emits dicts
+    constexpr tag_key tag_keys[] = {
+        {"burst_id", value_type::int64}, {"crc_ok", value_type::boolean},   {"freq_offset", value_type::real},
+        {"label", value_type::symbol},   {"packet_len", value_type::int32}, {"rx_freq", value_type::real},
+        {"rx_rate", value_type::real},   {"rx_time", value_type::int64},    {"seq", value_type::int64},
+        {"snr", value_type::real},       {"source", value_type::symbol},    {"valid", value_type::boolean},
+    };
+    constexpr size_t num_tag_keys = std::size(tag_keys);
+    static_assert(num_tag_keys == corpus_max_tag_entries);
+
+    constexpr std::string_view labels[] = {"burst_start", "burst_end", "sob", "eob", "preamble", "header_ok"};
+
+    void write_value(message_writer& w, splitmix64& rng, value_type type) {
+        switch (type) {
+            case value_type::int32:
+                w.int32(static_cast<int32_t>(rng.below(65536)));
+                break;
+            case value_type::int64:
+                w.int64(static_cast<int64_t>(rng.next() >> 12));
+                break;
+            case value_type::real:
+                w.real(static_cast<double>(static_cast<int64_t>(rng.below(2000000000)) - 1000000000) / 1024.0);
+                break;
+            case value_type::boolean:
+                w.boolean(rng.below(2) == 0);
+                break;
+            case value_type::symbol:
+                w.symbol(labels[rng.below(std::size(labels))]);
+                break;
+        }
+    }
+
+    // count (at most num_tag_keys) distinct keys, emitted in key order
+    void write_tag_dict(message_writer& w, splitmix64& rng, size_t count) {
+        // Selection sampling keeps the chosen keys in order
+        size_t remaining = count;
+        for (size_t i = 0; i < num_tag_keys && remaining > 0; ++i) {
+            if (rng.below(num_tag_keys - i) < remaining) {
+                w.dict_entry(tag_keys[i].name);
+                write_value(w, rng, tag_keys[i].type);
+                --remaining;
+            }
+        }
+        w.tag(legacy_tag::LEGACY_PMT_NULL);
+    }
+
+    // Random bytes, taken from each word in big-endian order like every other field
+    void fill_u8(uint8_t* p, size_t n, splitmix64& rng) {
+        uint8_t* end = p + n;
+        while (end - p >= 8)
+            write_u64(p, rng.next());
+        if (p != end) {
+            uint8_t word[8];
+            uint8_t* w = word;
+            write_u64(w, rng.next());
+            std::memcpy(p, word, static_cast<size_t>(end - p));
+        }
+    }
+
+    // Noisy sawtooth samples, as big-endian float pairs
+    void fill_c32(uint8_t* p, size_t n, splitmix64& rng) {
+        for (size_t i = 0; i < n; ++i) {
+            for (int part = 0; part < 2; ++part) {
+                auto q = static_cast<int32_t>((i * (part ? 7 : 13)) % 2048) - 1024 + static_cast<int32_t>(rng.below(64));
+                write_u32(p, std::bit_cast<uint32_t>(static_cast<float>(q) / 1024.0f));
+            }
+        }
+    }
+
+    void write_pdu(message_writer& w, splitmix64& rng, legacy_uniform_type dtype, size_t count) {
+        w.tag(legacy_tag::LEGACY_PMT_PAIR);
+        write_tag_dict(w, rng, rng.uniform(1, 4));
+        uint8_t* p = w.uniform_vector(dtype, count);
+        if (dtype == legacy_uniform_type::U8)
+            fill_u8(p, count, rng);
+        else
+            fill_c32(p, count, rng);
+    }
+
+    void write_nested(message_writer& w, splitmix64& rng, size_t depth) {
+        w.dict_entry("depth");
+        w.int32(static_cast<int32_t>(depth));
+        if (depth > 1) {
+            w.dict_entry("inner");
+            write_nested(w, rng, depth - 1);
+        } else {
+            w.dict_entry("leaf");
+            write_value(w, rng, value_type::symbol);
+        }
+        w.tag(legacy_tag::LEGACY_PMT_NULL);
+    }
+
+} // namespace
+
+std::vector<corpus_message> generate_legacy_corpus(const corpus_options& opts) {
+    uint64_t total_weight = 0;
+    for (uint32_t w : opts.weights)
+        total_weight += w;
+    if (total_weight == 0)
+        throw std::invalid_argument("Corpus weights are all zero");
+    for (const size_range& r : {opts.tag_entries, opts.pdu_bytes, opts.pdu_samples, opts.burst_samples,
+                                opts.nesting_depth})
+        if (r.min > r.max)
+            throw std::invalid_argument("Corpus size range has min > max");
+    if (opts.tag_entries.max > corpus_max_tag_entries)
+        throw std::invalid_argument("Corpus tag dicts have at most " + std::to_string(corpus_max_tag_entries) +
+                                    " entries");
+
+    splitmix64 rng{opts.seed};
+    std::vector<corpus_message> corpus(opts.messages);
+    for (auto& msg : corpus) {
+        uint64_t pick = rng.below(total_weight);
+        size_t kind = 0;
+        while (pick >= opts.weights[kind])
+            pick -= opts.weights[kind++];
+        msg.kind = static_cast<corpus_kind>(kind);
+
+        message_writer w(msg.bytes);
+        switch (msg.kind) {
+            case corpus_kind::tag_dict:
+                write_tag_dict(w, rng, std::max<size_t>(rng.log_uniform(opts.tag_entries), 1));
+                break;
+            case corpus_kind::pdu_u8:
+                write_pdu(w, rng, legacy_uniform_type::U8, rng.log_uniform(opts.pdu_bytes));
+                break;
+            case corpus_kind::pdu_c32:
+                write_pdu(w, rng, legacy_uniform_type::C32, rng.log_uniform(opts.pdu_samples));
+                break;
+            case corpus_kind::c32_burst: {
+                size_t n = rng.log_uniform(opts.burst_samples);
+                fill_c32(w.uniform_vector(legacy_uniform_type::C32, n), n, rng);
+                break;
+            }
+            case corpus_kind::nested_dict:
+                write_nested(w, rng, std::max<size_t>(rng.log_uniform(opts.nesting_depth), 1));
+                break;
+        }
+    }
+    return corpus;
+}
+
+} // namespace legacy_pmt
@@ -0,0 +1,247 @@
+#include <pmt_converter/pmt_legacy_dedup.h>
+#include <pmt_converter/legacy/pmt_legacy_hash.h>
+#include <pmt_converter/pmt_legacy_codec.h>
+#include <pmt_converter/pmt_legacy_format.h>
+
+#include <algorithm>
+#include <cstring>
+#include <limits>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+
+namespace legacy_pmt {
+
+static constexpr uint8_t dedup_magic[3] = {'L', 'P', 'R'};
+static constexpr uint8_t dedup_version = 1;
+
+// Encoded size of a REF: tag and u32 id
+static constexpr size_t ref_size = 5;
+
+bool is_deduplicated(const uint8_t* data, size_t size) {
+    return size >= dedup_header_size && std::memcmp(data, dedup_magic, sizeof(dedup_magic)) == 0 &&
+           data[3] == dedup_version;
+}
+
+namespace {
+
+    // A node of the plain encoding, in preorder; `next` is the index of the
+    // first node after its subtree
+    struct encoded_node {
+        size_t offset;
+        size_t size;
+        size_t next;
+    };
+
+    // Index every node of a plain legacy encoding produced by serialize_to_legacy()
+    size_t index_nodes(const uint8_t* data, size_t size, size_t pos, std::vector<encoded_node>& nodes) {
+        size_t self = nodes.size();
+        nodes.push_back({pos, 0, 0});
+
+        switch (static_cast<legacy_tag>(data[pos])) {
+            case legacy_tag::LEGACY_PMT_PAIR:
+                pos = index_nodes(data, size, pos + 1, nodes);
+                pos = index_nodes(data, size, pos, nodes);
+                break;
+            case legacy_tag::LEGACY_PMT_VECTOR:
+            case legacy_tag::LEGACY_PMT_TUPLE: {
+                const uint8_t* p = data + pos + 1;
+                size_t len = read_u32(p);
+                pos += 5;
+                for (size_t i = 0; i < len; ++i)
+                    pos = index_nodes(data, size, pos, nodes);
+                break;
+            }
+            case legacy_tag::LEGACY_PMT_DICT:
+                // DICT PAIR key value, repeated, then NULL; only keys and values are nodes
+                while (static_cast<legacy_tag>(data[pos]) == legacy_tag::LEGACY_PMT_DICT) {
+                    pos = index_nodes(data, size, pos + 2, nodes);
+                    pos = index_nodes(data, size, pos, nodes);
+                }
+                pos += 1;
+                break;
+            default:
+                pos += legacy_encoded_size(data + pos, size - pos);
+                break;
+        }
+
+        nodes[self].size = pos - nodes[self].offset;
+        nodes[self].next = nodes.size();
+        return pos;
+    }
+
+    constexpr size_t no_ref = std::numeric_limits<size_t>::max();
+
+    void append(std::vector<uint8_t>& out, const uint8_t* data, size_t size) {
+        out.insert(out.end(), data, data + size);
+    }
+
+    struct expanded_span {
+        size_t offset = 0;
+        size_t size = 0;
+        bool complete = false;
+    };
+
+    void require(const uint8_t* ptr, const uint8_t* end, size_t n) {
+        if (static_cast<size_t>(end - ptr) < n)
+            throw std::runtime_error("Truncated deduplicated legacy PMT buffer");
+    }
+
+    void expand_node(const uint8_t*& ptr, const uint8_t* end, std::vector<uint8_t>& out,
+                     std::vector<expanded_span>& defs, size_t limit) {
+        require(ptr, end, 1);
+        switch (static_cast<legacy_tag>(*ptr)) {
+            case legacy_tag::LEGACY_PMT_DEF: {
+                ++ptr;
+                size_t id = defs.size();
+                defs.emplace_back();
+                size_t start = out.size();
+                expand_node(ptr, end, out, defs, limit);
+                defs[id] = {start, out.size() - start, true};
+                return;
+            }
+            case legacy_tag::LEGACY_PMT_REF: {
+                require(ptr, end, ref_size);
+                ++ptr;
+                size_t id = read_u32(ptr);
+                if (id >= defs.size() || !defs[id].complete)
+                    throw std::runtime_error("Deduplicated legacy PMT references undefined node " + std::to_string(id));
+                // Plain bytes never outgrow the input, so only references can exceed the limit
+                if (defs[id].size > limit - std::min(limit, out.size()))
+                    throw std::runtime_error("Deduplicated legacy PMT expands beyond " + std::to_string(limit) +
+                                             " bytes");
+                // Resize first: the source span lives in out itself
+                size_t at = out.size();
+                out.resize(at + defs[id].size);
+                std::memcpy(out.data() + at, out.data() + defs[id].offset, defs[id].size);
+                return;
+            }
+            case legacy_tag::LEGACY_PMT_PAIR:
+                out.push_back(*ptr++);
+                expand_node(ptr, end, out, defs, limit);
+                expand_node(ptr, end, out, defs, limit);
+                return;
+            case legacy_tag::LEGACY_PMT_VECTOR:
+            case legacy_tag::LEGACY_PMT_TUPLE: {
+                require(ptr, end, 5);
+                append(out, ptr, 5);
+                ++ptr;
+                size_t len = read_u32(ptr);
+                for (size_t i = 0; i < len; ++i)
+                    expand_node(ptr, end, out, defs, limit);
+                return;
+            }
+            case legacy_tag::LEGACY_PMT_DICT:
+                while (true) {
+                    require(ptr, end, 2);
+                    if (static_cast<legacy_tag>(ptr[1]) != legacy_tag::LEGACY_PMT_PAIR)
+                        throw std::runtime_error("Malformed deduplicated legacy PMT dict entry");
+                    append(out, ptr, 2);
+                    ptr += 2;
+                    expand_node(ptr, end, out, defs, limit);
+                    expand_node(ptr, end, out, defs, limit);
+                    require(ptr, end, 1);
+                    auto link = static_cast<legacy_tag>(*ptr);
+                    if (link == legacy_tag::LEGACY_PMT_NULL) {
+                        out.push_back(*ptr++);
+                        return;
+                    }
+                    if (link != legacy_tag::LEGACY_PMT_DICT)
+                        throw std::runtime_error("Malformed deduplicated legacy PMT dict");
+                }
+            default: {
+                // Leaves carry no DEF/REF, copy them as they are
+                size_t n = legacy_encoded_size(ptr, static_cast<size_t>(end - ptr));
+                append(out, ptr, n);
+                ptr += n;
+                return;
+            }
+        }
+    }
+
+} // namespace
+
+std::vector<uint8_t> serialize_deduplicated(const pmtv::pmt& obj, const dedup_options& opts) {
+    std::vector<uint8_t> plain = serialize_to_legacy(obj);
+    if (opts.strict)
+        return plain;
+
+    std::vector<encoded_node> nodes;
+    index_nodes(plain.data(), plain.size(), 0, nodes);
+
+    // Greedy, in preorder: the first copy of a subtree is kept, later copies
+    // become references and their own subtrees are not visited. A reference
+    // never points into a replaced subtree, since those are never indexed.
+    size_t min_size = std::max(opts.min_subtree_bytes, ref_size + 1);
+    std::unordered_map<std::span<const uint8_t>, size_t, encoded_hash, encoded_equal> seen;
+    std::vector<size_t> ref_of(nodes.size(), no_ref);
+    std::vector<bool> defined(nodes.size(), false);
+    bool any_ref = false;
+    for (size_t i = 1; i < nodes.size();) {
+        if (nodes[i].size < min_size) {
+            ++i;
+            continue;
+        }
+        std::span<const uint8_t> bytes(plain.data() + nodes[i].offset, nodes[i].size);
+        auto [it, inserted] = seen.try_emplace(bytes, i);
+        if (inserted) {
+            ++i;
+            continue;
+        }
+        ref_of[i] = it->second;
+        defined[it->second] = true;
+        any_ref = true;
+        i = nodes[i].next;
+    }
+
+    std::vector<uint8_t> out(dedup_magic, dedup_magic + sizeof(dedup_magic));
+    out.push_back(dedup_version);
+    if (!any_ref) {
+        append(out, plain.data(), plain.size());
+        return out;
+    }
+
+    // Ids follow the order in which the decoder meets DEF tags, i.e. preorder
+    std::vector<uint32_t> id_of(nodes.size(), 0);
+    uint32_t next_id = 0;
+    size_t cursor = 0;
+    for (size_t i = 0; i < nodes.size();) {
+        const encoded_node& n = nodes[i];
+        if (ref_of[i] != no_ref) {
+            append(out, plain.data() + cursor, n.offset - cursor);
+            uint8_t ref[ref_size];
+            uint8_t* p = ref;
+            write_u8(p, static_cast<uint8_t>(legacy_tag::LEGACY_PMT_REF));
+            write_u32(p, id_of[ref_of[i]]);
+            append(out, ref, ref_size);
+            cursor = n.offset + n.size;
+            i = n.next;
+            continue;
+        }
+        if (defined[i]) {
+            append(out, plain.data() + cursor, n.offset - cursor);
+            out.push_back(static_cast<uint8_t>(legacy_tag::LEGACY_PMT_DEF));
+            cursor = n.offset;
+            id_of[i] = next_id++;
+        }
+        ++i;
+    }
+    append(out, plain.data() + cursor, plain.size() - cursor);
+    return out;
+}
+
+std::vector<uint8_t> expand_deduplicated(const uint8_t* data, size_t size, size_t max_expansion) {
+    if (!is_deduplicated(data, size))
+        return std::vector<uint8_t>(data, data + size);
+
+    const uint8_t* ptr = data + dedup_header_size;
+    const uint8_t* end = data + size;
+    std::vector<uint8_t> out;
+    out.reserve(size);
+    std::vector<expanded_span> defs;
+    expand_node(ptr, end, out, defs, detail::dedup_expansion_limit(size, max_expansion));
+    return out;
+}
+
+} // namespace legacy_pmt
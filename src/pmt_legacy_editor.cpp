@@ -0,0 +1,95 @@
+#include <pmt_converter/pmt_legacy_editor.h>
+#include <pmt_converter/pmt_legacy_codec.h>
+
+#include <cstring>
+#include <stdexcept>
+#include <string>
+
+namespace legacy_pmt {
+
+static void require_bytes(size_t pos, size_t size, size_t n) {
+    if (size - pos < n)
+        throw std::runtime_error("Truncated legacy PMT buffer at offset " + std::to_string(pos));
+}
+
+std::optional<legacy_value_ref> legacy_editor::find(key_path path) const {
+    size_t pos = 0;
+
+    for (std::string_view key : path) {
+        // The previous key may have been the last thing in the buffer
+        require_bytes(pos, _size, 1);
+        if (static_cast<legacy_tag>(_data[pos]) != legacy_tag::LEGACY_PMT_DICT)
+            return std::nullopt;
+
+        // DICT PAIR key value, repeated, then NULL; keys are compared as raw
+        // symbol bytes and everything else is skipped without decoding
+        bool found = false;
+        while (!found) {
+            require_bytes(pos, _size, 1);
+            auto link = static_cast<legacy_tag>(_data[pos]);
+            if (link == legacy_tag::LEGACY_PMT_NULL)
+                return std::nullopt;
+            require_bytes(pos, _size, 2);
+            if (link != legacy_tag::LEGACY_PMT_DICT ||
+                static_cast<legacy_tag>(_data[pos + 1]) != legacy_tag::LEGACY_PMT_PAIR)
+                throw std::runtime_error("Malformed legacy PMT dict at offset " + std::to_string(pos));
+            pos += 2;
+
+            size_t key_size = legacy_encoded_size(_data + pos, _size - pos);
+            found = static_cast<legacy_tag>(_data[pos]) == legacy_tag::LEGACY_PMT_SYMBOL &&
+                    key_size - symbol_header_size == key.size() &&
+                    std::memcmp(_data + pos + symbol_header_size, key.data(), key.size()) == 0;
+            pos += key_size;
+            if (!found)
+                pos += legacy_encoded_size(_data + pos, _size - pos);
+        }
+    }
+
+    require_bytes(pos, _size, 1);
+    return legacy_value_ref{pos, legacy_encoded_size(_data + pos, _size - pos), static_cast<legacy_tag>(_data[pos])};
+}
+
+std::optional<pmtv::pmt> legacy_editor::get(key_path path) const {
+    auto ref = find(path);
+    if (!ref)
+        return std::nullopt;
+    return deserialize_from_legacy(_data + ref->offset, ref->size);
+}
+
+bool legacy_editor::set(key_path path, const pmtv::pmt& value) {
+    std::vector<uint8_t> encoded = serialize_to_legacy(value);
+    return replace(path, encoded.data(), encoded.size());
+}
+
+bool legacy_editor::replace(key_path path, const uint8_t* encoded, size_t size) {
+    auto ref = find(path);
+    if (!ref)
+        return false;
+
+    if (size == ref->size) {
+        std::memcpy(_data + ref->offset, encoded, size);
+        return true;
+    }
+    if (!_growable)
+        throw std::length_error("Legacy PMT edit changes the message size (" + std::to_string(ref->size) + " to " +
+                                std::to_string(size) + " bytes) in a fixed buffer");
+
+    size_t tail = ref->offset + ref->size;
+    size_t tail_size = _size - tail;
+    size_t new_size = _size - ref->size + size;
+    if (size > ref->size) {
+        _growable->resize(new_size);
+        _data = _growable->data();
+        std::memmove(_data + ref->offset + size, _data + tail, tail_size);
+        std::memcpy(_data + ref->offset, encoded, size);
+    } else {
+        std::memcpy(_data + ref->offset, encoded, size);
+        std::memmove(_data + ref->offset + size, _data + tail, tail_size);
+        _growable->resize(new_size);
+        _data = _growable->data();
+    }
+    _size = new_size;
+    return true;
+}
+
+} // namespace legacy_pmt
@@ -0,0 +1,298 @@
+#include <pmt_converter/pmt_legacy_envelope.h>
+#include <pmt_converter/pmt_legacy_codec.h>
+#include <pmt_converter/pmt_legacy_format.h>
+#include "byteswap.h"
+
+#include <algorithm>
+#include <cstring>
+#include <new>
+#include <stdexcept>
+#include <string>
+
+#ifdef PMT_CONVERTER_HAVE_ZSTD
+#include <zstd.h>
+#endif
+
+namespace legacy_pmt {
+
+static constexpr uint8_t envelope_magic[3] = {'L', 'P', 'Z'};
+static constexpr uint8_t envelope_version = 1;
+
+// Byte width of the scalars making up a uniform vector element; complex types
+// shuffle by their real/imaginary component width
+static size_t uniform_scalar_width(legacy_uniform_type dtype) {
+    switch (dtype) {
+        case legacy_uniform_type::U16:
+        case legacy_uniform_type::S16:
+            return 2;
+        case legacy_uniform_type::U32:
+        case legacy_uniform_type::S32:
+        case legacy_uniform_type::F32:
+        case legacy_uniform_type::C32:
+            return 4;
+        case legacy_uniform_type::U64:
+        case legacy_uniform_type::S64:
+        case legacy_uniform_type::F64:
+        case legacy_uniform_type::C64:
+            return 8;
+        default:
+            return 1;
+    }
+}
+
+// Offset and scalar width of the shufflable payload of a top-level uniform
+// vector, or width 1 if the message has nothing worth shuffling
+static std::pair<size_t, size_t> shuffle_region(const uint8_t* legacy, size_t size) {
+    if (size < 7 || static_cast<legacy_tag>(legacy[0]) != legacy_tag::LEGACY_PMT_UNIFORM_VECTOR)
+        return {0, 1};
+    size_t offset = 7 + legacy[6];
+    if (offset > size)
+        return {0, 1};
+    return {offset, uniform_scalar_width(static_cast<legacy_uniform_type>(legacy[1]))};
+}
+
+// out[plane * n + i] = in[i * width + plane]; trailing bytes are copied as is
+static void shuffle_bytes(const uint8_t* in, uint8_t* out, size_t size, size_t width) {
+    size_t n = size / width;
+    detail::byte_shuffle(in, out, n, width);
+    std::memcpy(out + n * width, in + n * width, size - n * width);
+}
+
+static void unshuffle_bytes(const uint8_t* in, uint8_t* out, size_t size, size_t width) {
+    size_t n = size / width;
+    detail::byte_unshuffle(in, out, n, width);
+    std::memcpy(out + n * width, in + n * width, size - n * width);
+}
+
+bool envelope_codec_available(envelope_codec codec) {
+    switch (codec) {
+        case envelope_codec::none:
+            return true;
+        case envelope_codec::zstd:
+#ifdef PMT_CONVERTER_HAVE_ZSTD
+            return true;
+#else
+            return false;
+#endif
+    }
+    return false;
+}
+
+bool is_envelope(const uint8_t* data, size_t size) {
+    return size >= envelope_header_size && std::memcmp(data, envelope_magic, sizeof(envelope_magic)) == 0 &&
+           data[3] == envelope_version;
+}
+
+std::vector<uint8_t> wrap_envelope(const uint8_t* legacy, size_t size, const envelope_options& opts) {
+    if (!envelope_codec_available(opts.codec))
+        throw std::runtime_error("Envelope codec not available in this build");
+
+    envelope_filter filter = envelope_filter::none;
+    std::vector<uint8_t> filtered;
+    const uint8_t* body = legacy;
+    if (opts.shuffle) {
+        auto [offset, width] = shuffle_region(legacy, size);
+        if (width > 1) {
+            filter = envelope_filter::byte_shuffle;
+            filtered.resize(size);
+            std::memcpy(filtered.data(), legacy, offset);
+            shuffle_bytes(legacy + offset, filtered.data() + offset, size - offset, width);
+            body = filtered.data();
+        }
+    }
+
+    std::vector<uint8_t> out(envelope_header_size);
+    uint8_t* ptr = out.data();
+    std::memcpy(ptr, envelope_magic, sizeof(envelope_magic));
+    ptr += sizeof(envelope_magic);
+    write_u8(ptr, envelope_version);
+    write_u8(ptr, static_cast<uint8_t>(opts.codec));
+    write_u8(ptr, static_cast<uint8_t>(filter));
+    write_u16(ptr, 0);
+    write_u64(ptr, size);
+
+    switch (opts.codec) {
+        case envelope_codec::none:
+            out.resize(envelope_header_size + size);
+            std::memcpy(out.data() + envelope_header_size, body, size);
+            break;
+        case envelope_codec::zstd: {
+#ifdef PMT_CONVERTER_HAVE_ZSTD
+            out.resize(envelope_header_size + ZSTD_compressBound(size));
+            size_t n = ZSTD_compress(out.data() + envelope_header_size, out.size() - envelope_header_size,
+                                     body, size, opts.level);
+            if (ZSTD_isError(n))
+                throw std::runtime_error(std::string("zstd compression failed: ") + ZSTD_getErrorName(n));
+            out.resize(envelope_header_size + n);
+#endif
+            break;
+        }
+    }
+    return out;
+}
+
+std::vector<uint8_t> serialize_to_envelope(const pmtv::pmt& obj, const envelope_options& opts) {
+    auto legacy = serialize_to_legacy(obj);
+    return wrap_envelope(legacy.data(), legacy.size(), opts);
+}
+
+std::vector<uint8_t> unwrap_envelope(const uint8_t* data, size_t size, size_t max_raw_size) {
+    envelope_decoder dec(max_raw_size);
+    size_t used = dec.feed(data, size);
+    if (!dec.complete() || used != size)
+        throw std::runtime_error("Truncated or trailing data in legacy PMT envelope");
+    auto bytes = dec.legacy_bytes();
+    return {bytes.begin(), bytes.end()};
+}
+
+pmtv::pmt deserialize_from_envelope(const uint8_t* data, size_t size, size_t max_raw_size) {
+    envelope_decoder dec(max_raw_size);
+    size_t used = dec.feed(data, size);
+    if (!dec.complete() || used != size)
+        throw std::runtime_error("Truncated or trailing data in legacy PMT envelope");
+    return dec.take();
+}
+
+envelope_decoder::envelope_decoder(size_t max_raw_size) : _max_raw_size(max_raw_size) {}
+
+envelope_decoder::~envelope_decoder() {
+#ifdef PMT_CONVERTER_HAVE_ZSTD
+    ZSTD_freeDCtx(static_cast<ZSTD_DCtx*>(_zstd));
+#endif
+}
+
+void envelope_decoder::reset() {
+    _state = state::header;
+    _header_fill = 0;
+    _raw_size = 0;
+    _raw_fill = 0;
+    _raw.clear();
+}
+
+size_t envelope_decoder::feed(const uint8_t* data, size_t size) {
+    size_t used = 0;
+
+    if (_state == state::header) {
+        size_t n = std::min(size, envelope_header_size - _header_fill);
+        std::memcpy(_header + _header_fill, data, n);
+        _header_fill += n;
+        used += n;
+        if (_header_fill < envelope_header_size)
+            return used;
+
+        if (!is_envelope(_header, envelope_header_size))
+            throw std::runtime_error("Not a legacy PMT envelope");
+        _codec = static_cast<envelope_codec>(_header[4]);
+        _filter = static_cast<envelope_filter>(_header[5]);
+        if (!envelope_codec_available(_codec))
+            throw std::runtime_error("Envelope codec not available in this build");
+        if (_filter != envelope_filter::none && _filter != envelope_filter::byte_shuffle)
+            throw std::runtime_error("Unknown legacy PMT envelope filter");
+
+        const uint8_t* p = _header + 8;
+        uint64_t raw_size = read_u64(p);
+        if (raw_size == 0)
+            throw std::runtime_error("Empty legacy PMT envelope");
+        if (raw_size > _max_raw_size)
+            throw std::runtime_error("Legacy PMT envelope of " + std::to_string(raw_size) +
+                                     " bytes exceeds the limit of " + std::to_string(_max_raw_size));
+        _raw_size = static_cast<size_t>(raw_size);
+        _raw.clear();
+        _raw_fill = 0;
+        _frame_checked = false;
+        _state = state::body;
+
+#ifdef PMT_CONVERTER_HAVE_ZSTD
+        if (_codec == envelope_codec::zstd) {
+            if (!_zstd) {
+                _zstd = ZSTD_createDCtx();
+                if (!_zstd)
+                    throw std::bad_alloc();
+            }
+            ZSTD_DCtx_reset(static_cast<ZSTD_DCtx*>(_zstd), ZSTD_reset_session_only);
+        }
+#endif
+    }
+
+    if (_state != state::body)
+        return used;
+
+    if (_codec == envelope_codec::none) {
+        size_t n = std::min(size - used, _raw_size - _raw_fill);
+        _raw.resize(_raw_fill + n);
+        std::memcpy(_raw.data() + _raw_fill, data + used, n);
+        _raw_fill += n;
+        used += n;
+        if (_raw_fill == _raw_size)
+            finish_body();
+        return used;
+    }
+
+#ifdef PMT_CONVERTER_HAVE_ZSTD
+    if (!_frame_checked && used < size) {
+        // The frame header normally arrives with the first piece of the body;
+        // a content size that disagrees with the envelope header is corrupt
+        unsigned long long content = ZSTD_getFrameContentSize(data + used, size - used);
+        if (content != ZSTD_CONTENTSIZE_ERROR && content != ZSTD_CONTENTSIZE_UNKNOWN && content != _raw_size)
+            throw std::runtime_error("Legacy PMT envelope size does not match its zstd frame");
+        _frame_checked = true;
+    }
+
+    ZSTD_inBuffer in{data + used, size - used, 0};
+    bool frame_done = false;
+    while (in.pos < in.size) {
+        // Grow the output as it is produced rather than trusting the declared size
+        if (_raw_fill == _raw.size() && _raw.size() < _raw_size)
+            _raw.resize(std::min(_raw_size, std::max(2 * _raw.size(), ZSTD_DStreamOutSize())));
+        ZSTD_outBuffer out{_raw.data(), _raw.size(), _raw_fill};
+        size_t in_before = in.pos;
+        size_t ret = ZSTD_decompressStream(static_cast<ZSTD_DCtx*>(_zstd), &out, &in);
+        if (ZSTD_isError(ret))
+            throw std::runtime_error(std::string("zstd decompression failed: ") + ZSTD_getErrorName(ret));
+        bool progress = in.pos != in_before || out.pos != _raw_fill;
+        _raw_fill = out.pos;
+        if (ret == 0) {
+            // zstd stops at the frame boundary; later input is the next envelope
+            frame_done = true;
+            break;
+        }
+        if (!progress && _raw_fill == _raw_size)
+            throw std::runtime_error("Legacy PMT envelope larger than its declared size");
+    }
+    used += in.pos;
+    if (frame_done) {
+        if (_raw_fill != _raw_size)
+            throw std::runtime_error("Legacy PMT envelope shorter than its declared size");
+        finish_body();
+    }
+#endif
+    return used;
+}
+
+void envelope_decoder::finish_body() {
+    if (_filter == envelope_filter::byte_shuffle) {
+        auto [offset, width] = shuffle_region(_raw.data(), _raw.size());
+        if (width > 1) {
+            std::vector<uint8_t> plain(_raw.size());
+            std::memcpy(plain.data(), _raw.data(), offset);
+            unshuffle_bytes(_raw.data() + offset, plain.data() + offset, _raw.size() - offset, width);
+            _raw.swap(plain);
+        }
+    }
+    _state = state::complete;
+}
+
+std::span<const uint8_t> envelope_decoder::legacy_bytes() const {
+    if (_state != state::complete)
+        throw std::logic_error("Legacy PMT envelope not complete");
+    return _raw;
+}
+
+pmtv::pmt envelope_decoder::take() {
+    auto bytes = legacy_bytes();
+    pmtv::pmt obj = deserialize_from_legacy(bytes.data(), bytes.size());
+    reset();
+    return obj;
+}
+
+} // namespace legacy_pmt
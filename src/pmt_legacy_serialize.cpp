@@ -0,0 +1,179 @@
+#include <pmt_converter/legacy/pmt_legacy_hash.h>
+#include <pmt_converter/legacy/pmt_legacy_serialize.h>
+#include <pmt_converter/pmt_legacy_format.h>
+#include "pmt_legacy_writer.h"
+
+#include <limits>
+#include <stdexcept>
+#include <string>
+
+using legacy::pmt_t;
+using pmt_ptr = std::shared_ptr<legacy::pmt_t>;
+
+namespace legacy_pmt {
+
+using detail::fits_int32;
+
+size_t legacy_pmt_serialized_size(const pmt_ptr& obj) {
+    if (!obj || obj->is_bool())
+        return 1;
+    if (obj->is_int())
+        return fits_int32(obj->to_int()) ? 1 + 4 : 1 + 8;
+    if (obj->is_symbol()) {
+        size_t len = obj->to_symbol().size();
+        if (len > std::numeric_limits<uint16_t>::max())
+            throw std::runtime_error("Symbol too long for legacy serialization");
+        return symbol_header_size + len;
+    }
+    if (obj->is_pair())
+        return 1 + legacy_pmt_serialized_size(obj->car()) + legacy_pmt_serialized_size(obj->cdr());
+    if (obj->is_vector()) {
+        size_t size = 1 + 4;
+        for (const auto& item : obj->to_vector())
+            size += legacy_pmt_serialized_size(item);
+        return size;
+    }
+    if (obj->is_dict()) {
+        // Each entry is DICT PAIR <key> <value>, closed by a NULL
+        size_t size = 1;
+        for (const auto& [k, v] : obj->to_dict())
+            size += 2 + legacy_pmt_serialized_size(k) + legacy_pmt_serialized_size(v);
+        return size;
+    }
+    throw std::runtime_error("Unsupported legacy PMT type for serialization");
+}
+
+size_t serialize_legacy_pmt(const pmt_ptr& obj, uint8_t* out, size_t capacity) {
+    size_t size = legacy_pmt_serialized_size(obj);
+    if (size > capacity)
+        throw std::length_error("Buffer too small for legacy PMT serialization");
+
+    detail::pointer_sink sink{out};
+    detail::write_node(obj, sink);
+    return static_cast<size_t>(sink.ptr - out);
+}
+
+std::vector<uint8_t> serialize_legacy_pmt(const pmt_ptr& obj) {
+    std::vector<uint8_t> out(legacy_pmt_serialized_size(obj));
+    detail::pointer_sink sink{out.data()};
+    detail::write_node(obj, sink);
+    return out;
+}
+
+static void require_bytes(const uint8_t* ptr, const uint8_t* end, size_t n) {
+    if (static_cast<size_t>(end - ptr) < n)
+        throw std::runtime_error("Truncated legacy PMT buffer");
+}
+
+// Every child counts as a level, the cdr of a pair included: the decoded tree
+// is destroyed recursively, so a long chain is as deep as a nested one
+static pmt_ptr deserialize_node(const uint8_t*& ptr, const uint8_t* end, size_t depth) {
+    if (depth > legacy_max_depth)
+        throw std::runtime_error("Legacy PMT nested deeper than " + std::to_string(legacy_max_depth) + " levels");
+    require_bytes(ptr, end, 1);
+    auto tag = static_cast<legacy_tag>(*ptr++);
+
+    switch (tag) {
+        case legacy_tag::LEGACY_PMT_NULL:
+            return nullptr;
+        case legacy_tag::LEGACY_PMT_TRUE:
+            return pmt_t::make_bool(true);
+        case legacy_tag::LEGACY_PMT_FALSE:
+            return pmt_t::make_bool(false);
+        case legacy_tag::LEGACY_PMT_INT32:
+            require_bytes(ptr, end, 4);
+            return pmt_t::make_int(static_cast<int32_t>(read_u32(ptr)));
+        case legacy_tag::LEGACY_PMT_INT64:
+        case legacy_tag::LEGACY_PMT_UINT64:
+            require_bytes(ptr, end, 8);
+            return pmt_t::make_int(static_cast<int64_t>(read_u64(ptr)));
+        case legacy_tag::LEGACY_PMT_SYMBOL: {
+            require_bytes(ptr, end, 2);
+            uint16_t len = (ptr[0] << 8) | (ptr[1] << 0);
+            ptr += 2;
+            require_bytes(ptr, end, len);
+            auto sym = pmt_t::make_symbol(std::string(reinterpret_cast<const char*>(ptr), len));
+            ptr += len;
+            return sym;
+        }
+        case legacy_tag::LEGACY_PMT_PAIR: {
+            auto car = deserialize_node(ptr, end, depth + 1);
+            auto cdr = deserialize_node(ptr, end, depth + 1);
+            return pmt_t::make_pair(std::move(car), std::move(cdr));
+        }
+        case legacy_tag::LEGACY_PMT_VECTOR:
+        case legacy_tag::LEGACY_PMT_TUPLE: {
+            require_bytes(ptr, end, 4);
+            uint32_t len = static_cast<uint32_t>(read_u32(ptr));
+            // Every element takes at least one byte
+            require_bytes(ptr, end, len);
+            legacy::pmt_vector vec;
+            vec.reserve(len);
+            for (uint32_t i = 0; i < len; ++i)
+                vec.push_back(deserialize_node(ptr, end, depth + 1));
+            return std::make_shared<pmt_t>(std::in_place_type<legacy::pmt_vector>, std::move(vec));
+        }
+        case legacy_tag::LEGACY_PMT_DICT: {
+            legacy::pmt_dict dict;
+            while (true) {
+                require_bytes(ptr, end, 1);
+                if (static_cast<legacy_tag>(*ptr++) != legacy_tag::LEGACY_PMT_PAIR)
+                    throw std::runtime_error("Malformed legacy PMT dict entry");
+                auto key = deserialize_node(ptr, end, depth + 1);
+                auto value = deserialize_node(ptr, end, depth + 1);
+                dict.emplace(std::move(key), std::move(value));
+
+                require_bytes(ptr, end, 1);
+                auto link = static_cast<legacy_tag>(*ptr++);
+                if (link == legacy_tag::LEGACY_PMT_NULL)
+                    break;
+                if (link != legacy_tag::LEGACY_PMT_DICT)
+                    throw std::runtime_error("Malformed legacy PMT dict");
+            }
+            return std::make_shared<pmt_t>(std::in_place_type<legacy::pmt_dict>, std::move(dict));
+        }
+        case legacy_tag::LEGACY_PMT_DOUBLE:
+        case legacy_tag::LEGACY_PMT_COMPLEX:
+        case legacy_tag::LEGACY_PMT_UNIFORM_VECTOR:
+            throw std::runtime_error("Legacy PMT type " + std::to_string(static_cast<int>(tag)) +
+                                     " has no legacy::pmt_t representation");
+        default:
+            throw std::runtime_error("Unsupported or unknown legacy PMT tag " + std::to_string(static_cast<int>(tag)));
+    }
+}
+
+pmt_ptr deserialize_legacy_pmt(const uint8_t* data, size_t size) {
+    if (size == 0)
+        throw std::runtime_error("Empty legacy PMT buffer");
+
+    const uint8_t* ptr = data;
+    return deserialize_node(ptr, data + size, 0);
+}
+
+} // namespace legacy_pmt
+
+// Equal dicts hold entries with equal encodings, so their canonical orders
+// match entry for entry
+bool legacy::detail::dict_equal(const pmt_dict& a, const pmt_dict& b) {
+    if (a.size() != b.size())
+        return false;
+    legacy_pmt::detail::ordered_entries ea(a);
+    legacy_pmt::detail::ordered_entries eb(b);
+    for (size_t i = 0; i < ea.size(); ++i) {
+        if (!deep_equal(ea[i]->first, eb[i]->first) || !deep_equal(ea[i]->second, eb[i]->second))
+            return false;
+    }
+    return true;
+}
+
+namespace legacy_pmt {
+
+uint64_t legacy_pmt_hash(const pmt_ptr& obj) {
+    return detail::hash_node(obj);
+}
+
+uint64_t legacy_bytes_hash(const uint8_t* data, size_t size) {
+    return detail::hash_bytes(data, size);
+}
+
+} // namespace legacy_pmt
@@ -0,0 +1,129 @@
+#include <pmt_converter/pmt_legacy_tensor.h>
+#include "byteswap.h"
+#include "pmt_legacy_codec_detail.h"
+
+#include <array>
+#include <bit>
+#include <cstring>
+#include <stdexcept>
+
+namespace legacy_pmt::detail {
+
+namespace {
+
+    // Byte width of the scalars that are swapped; complex types swap their
+    // real and imaginary parts separately
+    size_t scalar_width(legacy_uniform_type dtype) {
+        size_t elem = legacy_uniform_element_size(dtype);
+        return dtype == legacy_uniform_type::C32 || dtype == legacy_uniform_type::C64 ? elem / 2 : elem;
+    }
+
+    size_t element_count(const erased_tensor_view& view) {
+        if (view.extents.size() != view.strides.size())
+            throw std::runtime_error("Tensor view extents and strides differ in rank");
+        if (view.extents.empty())
+            throw std::runtime_error("Tensor view has no extents");
+        return uniform_shape_count(view.extents);
+    }
+
+    template <typename U>
+    U to_wire(U v) {
+        if constexpr (std::endian::native == std::endian::little)
+            return std::byteswap(v);
+        else
+            return v;
+    }
+
+    // count elements, stride bytes apart, each made of `scalars` big-endian scalars of type U
+    template <typename U>
+    void gather(const uint8_t* src, ptrdiff_t stride, size_t count, size_t scalars, uint8_t* out) {
+        for (size_t i = 0; i < count; ++i, src += stride) {
+            for (size_t k = 0; k < scalars; ++k, out += sizeof(U)) {
+                U v;
+                std::memcpy(&v, src + k * sizeof(U), sizeof(U));
+                v = to_wire(v);
+                std::memcpy(out, &v, sizeof(U));
+            }
+        }
+    }
+
+    void gather(const uint8_t* src, ptrdiff_t stride, size_t count, size_t width, size_t scalars, uint8_t* out) {
+        switch (width) {
+            case 1: return gather<uint8_t>(src, stride, count, scalars, out);
+            case 2: return gather<uint16_t>(src, stride, count, scalars, out);
+            case 4: return gather<uint32_t>(src, stride, count, scalars, out);
+            default: return gather<uint64_t>(src, stride, count, scalars, out);
+        }
+    }
+
+    void copy_contiguous(const uint8_t* src, size_t count, size_t width, size_t scalars, uint8_t* out) {
+        if (width > 1 && std::endian::native == std::endian::little)
+            byteswap_copy(src, out, count * scalars, width);
+        else
+            std::memcpy(out, src, count * scalars * width);
+    }
+
+} // namespace
+
+size_t tensor_serialized_size(const erased_tensor_view& view) {
+    return uniform_vector_header_size_for(view.extents.size()) +
+           element_count(view) * legacy_uniform_element_size(view.dtype);
+}
+
+size_t serialize_tensor(const erased_tensor_view& view, uint8_t* out, size_t capacity) {
+    size_t size = tensor_serialized_size(view);
+    if (size > capacity)
+        throw std::length_error("Buffer too small for legacy PMT serialization");
+
+    size_t count = element_count(view);
+    uint8_t* ptr = out;
+    write_uniform_vector_header(ptr, view.dtype, count, view.extents);
+    if (count == 0)
+        return size;
+
+    const size_t elem = legacy_uniform_element_size(view.dtype);
+    const size_t width = scalar_width(view.dtype);
+    const size_t scalars = elem / width;
+    const auto& extents = view.extents;
+    const auto& strides = view.strides;
+
+    // Innermost dimensions that are contiguous in memory form one run, so a
+    // row-major view is a single block and a column slice one run per row
+    size_t outer = extents.size() - 1;
+    size_t run = extents[outer];
+    const bool contiguous = strides[outer] == 1;
+    while (contiguous && outer > 0 && strides[outer - 1] == static_cast<ptrdiff_t>(run)) {
+        --outer;
+        run *= extents[outer];
+    }
+    const ptrdiff_t run_stride = strides[extents.size() - 1] * static_cast<ptrdiff_t>(elem);
+
+    // Odometer over the remaining outer dimensions
+    std::array<size_t, uniform_shape_max_rank> idx{};
+    const uint8_t* base = view.data;
+    while (true) {
+        if (contiguous)
+            copy_contiguous(base, run, width, scalars, ptr);
+        else
+            gather(base, run_stride, run, width, scalars, ptr);
+        ptr += run * elem;
+
+        size_t d = outer;
+        while (d > 0) {
+            --d;
+            const ptrdiff_t step = strides[d] * static_cast<ptrdiff_t>(elem);
+            if (++idx[d] < extents[d]) {
+                base += step;
+                break;
+            }
+            base -= step * static_cast<ptrdiff_t>(extents[d] - 1);
+            idx[d] = 0;
+            if (d == 0)
+                return size;
+        }
+        if (outer == 0)
+            return size;
+    }
+}
+
+} // namespace legacy_pmt::detail
@@ -0,0 +1,410 @@
+#include <pmt_converter/pmt_legacy_text.h>
+#include <pmt_converter/pmt_legacy_format.h>
+#include "pmt_legacy_writer.h"
+
+#include <algorithm>
+#include <charconv>
+#include <cmath>
+#include <complex>
+#include <concepts>
+#include <string_view>
+#include <type_traits>
+
+namespace legacy_pmt {
+
+namespace {
+
+    template <typename T>
+    void append_number(std::string& out, T v) {
+        char buf[32];
+        auto res = std::to_chars(buf, buf + sizeof(buf), v);
+        out.append(buf, res.ptr);
+    }
+
+    template <typename T>
+    void append_value(std::string& out, const T& v) {
+        if constexpr (std::same_as<T, bool>) {
+            out += v ? "true" : "false";
+        } else if constexpr (std::same_as<T, std::complex<float>> || std::same_as<T, std::complex<double>>) {
+            append_number(out, v.real());
+            if (!std::signbit(v.imag()))
+                out += '+';
+            append_number(out, v.imag());
+            out += 'j';
+        } else {
+            append_number(out, v);
+        }
+    }
+
+    void append_symbol(std::string& out, std::string_view sym) {
+        out += '"';
+        out += sym;
+        out += '"';
+    }
+
+    void append_elided(std::string& out, size_t remaining) {
+        out += "... (+";
+        append_number(out, remaining);
+        out += ") ";
+    }
+
+    // Scalars of a contiguous array, in the vector style
+    template <typename T>
+    void append_array(std::string& out, const T* data, size_t n, const format_options& opts) {
+        out += '[';
+        size_t shown = std::min(n, opts.max_elements);
+        for (size_t i = 0; i < shown; ++i) {
+            append_value(out, data[i]);
+            out += ' ';
+        }
+        if (shown < n)
+            append_elided(out, n - shown);
+        out += ']';
+    }
+
+    // --- legacy::pmt_t ---
+
+    void format_node(std::string& out, const std::shared_ptr<legacy::pmt_t>& obj, const format_options& opts,
+                     size_t depth) {
+        if (!obj) {
+            out += "<null>";
+        } else if (obj->is_bool()) {
+            append_value(out, obj->to_bool());
+        } else if (obj->is_int()) {
+            append_number(out, obj->to_int());
+        } else if (obj->is_symbol()) {
+            append_symbol(out, obj->to_symbol());
+        } else if (obj->is_pair()) {
+            if (depth >= opts.max_depth) {
+                out += "(...)";
+                return;
+            }
+            out += '(';
+            format_node(out, obj->car(), opts, depth + 1);
+            out += " . ";
+            format_node(out, obj->cdr(), opts, depth + 1);
+            out += ')';
+        } else if (obj->is_vector()) {
+            if (depth >= opts.max_depth) {
+                out += "[...]";
+                return;
+            }
+            const auto& vec = obj->to_vector();
+            size_t shown = std::min(vec.size(), opts.max_elements);
+            out += '[';
+            for (size_t i = 0; i < shown; ++i) {
+                format_node(out, vec[i], opts, depth + 1);
+                out += ' ';
+            }
+            if (shown < vec.size())
+                append_elided(out, vec.size() - shown);
+            out += ']';
+        } else if (obj->is_dict()) {
+            if (depth >= opts.max_depth) {
+                out += "{...}";
+                return;
+            }
+            // Canonical entry order, so the dump matches the encoded message
+            detail::ordered_entries entries(obj->to_dict());
+            size_t shown = std::min(entries.size(), opts.max_elements);
+            out += '{';
+            for (size_t i = 0; i < shown; ++i) {
+                format_node(out, entries[i]->first, opts, depth + 1);
+                out += ": ";
+                format_node(out, entries[i]->second, opts, depth + 1);
+                out += ", ";
+            }
+            if (shown < entries.size())
+                append_elided(out, entries.size() - shown);
+            out += '}';
+        }
+    }
+
+    // --- pmtv::pmt ---
+
+    void format_pmtv(std::string& out, const pmtv::pmt& obj, const format_options& opts, size_t depth) {
+        std::visit([&](const auto& val) {
+            using T = std::decay_t<decltype(val)>;
+
+            if constexpr (std::same_as<T, std::monostate>) {
+                out += "<null>";
+            } else if constexpr (std::same_as<T, std::string>) {
+                append_symbol(out, val);
+            } else if constexpr (pmtv::UniformVector<T>) {
+                append_array(out, val.data(), val.size(), opts);
+            } else if constexpr (std::same_as<T, std::vector<std::string>> || std::same_as<T, std::vector<pmtv::pmt>>) {
+                if (depth >= opts.max_depth) {
+                    out += "[...]";
+                    return;
+                }
+                size_t shown = std::min(val.size(), opts.max_elements);
+                out += '[';
+                for (size_t i = 0; i < shown; ++i) {
+                    if constexpr (std::same_as<T, std::vector<std::string>>)
+                        append_symbol(out, val[i]);
+                    else
+                        format_pmtv(out, val[i], opts, depth + 1);
+                    out += ' ';
+                }
+                if (shown < val.size())
+                    append_elided(out, val.size() - shown);
+                out += ']';
+            } else if constexpr (std::same_as<T, pmtv::map_t>) {
+                if (depth >= opts.max_depth) {
+                    out += "{...}";
+                    return;
+                }
+                size_t shown = 0;
+                out += '{';
+                for (const auto& [k, v] : val) {
+                    if (shown++ == opts.max_elements) {
+                        append_elided(out, val.size() - opts.max_elements);
+                        break;
+                    }
+                    append_symbol(out, k);
+                    out += ": ";
+                    format_pmtv(out, v, opts, depth + 1);
+                    out += ", ";
+                }
+                out += '}';
+            } else if constexpr (std::is_arithmetic_v<T> || std::same_as<T, std::complex<float>> ||
+                                 std::same_as<T, std::complex<double>>) {
+                append_value(out, val);
+            } else {
+                out += "<?>";
+            }
+        }, obj);
+    }
+
+    // --- Legacy bytes ---
+
+    struct malformed {
+        const uint8_t* at;
+    };
+
+    class bytes_formatter {
+    public:
+        bytes_formatter(std::string& out, const uint8_t* end, const format_options& opts)
+            : _out(out), _end(end), _opts(opts) {}
+
+        // Print one node; with print == false only skip over it. Skipping
+        // recurses too, so nesting past legacy_max_depth is malformed
+        void node(const uint8_t*& ptr, size_t depth, bool print) {
+            need(ptr, 1);
+            const uint8_t* start = ptr;
+            if (depth > legacy_max_depth)
+                throw malformed{start};
+            auto tag = static_cast<legacy_tag>(*ptr++);
+
+            switch (tag) {
+                case legacy_tag::LEGACY_PMT_NULL:
+                    if (print) _out += "<null>";
+                    return;
+                case legacy_tag::LEGACY_PMT_TRUE:
+                case legacy_tag::LEGACY_PMT_FALSE:
+                    if (print) append_value(_out, tag == legacy_tag::LEGACY_PMT_TRUE);
+                    return;
+                case legacy_tag::LEGACY_PMT_INT32:
+                    need(ptr, 4);
+                    if (print) append_number(_out, static_cast<int32_t>(read_u32(ptr)));
+                    else ptr += 4;
+                    return;
+                case legacy_tag::LEGACY_PMT_INT64:
+                case legacy_tag::LEGACY_PMT_UINT64:
+                    need(ptr, 8);
+                    if (!print) ptr += 8;
+                    else if (tag == legacy_tag::LEGACY_PMT_INT64) append_number(_out, static_cast<int64_t>(read_u64(ptr)));
+                    else append_number(_out, read_u64(ptr));
+                    return;
+                case legacy_tag::LEGACY_PMT_DOUBLE:
+                    need(ptr, 8);
+                    if (print) append_number(_out, read_double(ptr));
+                    else ptr += 8;
+                    return;
+                case legacy_tag::LEGACY_PMT_COMPLEX:
+                    need(ptr, 16);
+                    if (print) {
+                        double re = read_double(ptr);
+                        append_value(_out, std::complex<double>(re, read_double(ptr)));
+                    } else {
+                        ptr += 16;
+                    }
+                    return;
+                case legacy_tag::LEGACY_PMT_SYMBOL: {
+                    need(ptr, 2);
+                    size_t len = (ptr[0] << 8) | ptr[1];
+                    ptr += 2;
+                    need(ptr, len);
+                    if (print) append_symbol(_out, std::string_view(reinterpret_cast<const char*>(ptr), len));
+                    ptr += len;
+                    return;
+                }
+                case legacy_tag::LEGACY_PMT_PAIR:
+                    print = print && open(depth, "(...)");
+                    if (print) _out += '(';
+                    node(ptr, depth + 1, print);
+                    if (print) {
+                        _out += " . ";
+                        node(ptr, depth + 1, true);
+                        _out += ')';
+                        return;
+                    }
+                    // Walk a skipped list along its cdrs, like skip_node
+                    while (need(ptr, 1), static_cast<legacy_tag>(*ptr) == legacy_tag::LEGACY_PMT_PAIR) {
+                        ++ptr;
+                        node(ptr, depth + 1, false);
+                    }
+                    node(ptr, depth + 1, false);
+                    return;
+                case legacy_tag::LEGACY_PMT_VECTOR:
+                case legacy_tag::LEGACY_PMT_TUPLE: {
+                    need(ptr, 4);
+                    size_t len = read_u32(ptr);
+                    print = print && open(depth, "[...]");
+                    if (print) _out += '[';
+                    for (size_t i = 0; i < len; ++i) {
+                        bool show = print && i < _opts.max_elements;
+                        node(ptr, depth + 1, show);
+                        if (show) _out += ' ';
+                    }
+                    if (print) {
+                        if (len > _opts.max_elements)
+                            append_elided(_out, len - _opts.max_elements);
+                        _out += ']';
+                    }
+                    return;
+                }
+                case legacy_tag::LEGACY_PMT_DICT:
+                    dict(ptr, depth, print);
+                    return;
+                case legacy_tag::LEGACY_PMT_UNIFORM_VECTOR:
+                    uniform_vector(ptr, print);
+                    return;
+                default:
+                    throw malformed{start};
+            }
+        }
+
+    private:
+        void need(const uint8_t* ptr, size_t n) const {
+            if (static_cast<size_t>(_end - ptr) < n)
+                throw malformed{ptr};
+        }
+
+        // False (after printing the placeholder) if the container is past max_depth
+        bool open(size_t depth, const char* placeholder) {
+            if (depth < _opts.max_depth)
+                return true;
+            _out += placeholder;
+            return false;
+        }
+
+        // The leading DICT tag has been consumed
+        void dict(const uint8_t*& ptr, size_t depth, bool print) {
+            print = print && open(depth, "{...}");
+            if (print) _out += '{';
+            size_t entries = 0;
+            while (true) {
+                need(ptr, 1);
+                if (static_cast<legacy_tag>(*ptr) != legacy_tag::LEGACY_PMT_PAIR)
+                    throw malformed{ptr};
+                ++ptr;
+                bool show = print && entries++ < _opts.max_elements;
+                node(ptr, depth + 1, show);
+                if (show) _out += ": ";
+                node(ptr, depth + 1, show);
+                if (show) _out += ", ";
+
+                need(ptr, 1);
+                auto link = static_cast<legacy_tag>(*ptr);
+                if (link != legacy_tag::LEGACY_PMT_NULL && link != legacy_tag::LEGACY_PMT_DICT)
+                    throw malformed{ptr};
+                ++ptr;
+                if (link == legacy_tag::LEGACY_PMT_NULL)
+                    break;
+            }
+            if (print) {
+                if (entries > _opts.max_elements)
+                    append_elided(_out, entries - _opts.max_elements);
+                _out += '}';
+            }
+        }
+
+        template <typename T>
+        void uniform_elements(const uint8_t* ptr, size_t len) {
+            _out += '[';
+            size_t shown = std::min(len, _opts.max_elements);
+            for (size_t i = 0; i < shown; ++i) {
+                append_value(_out, deserialize_from_big_endian<T>(ptr));
+                _out += ' ';
+            }
+            if (shown < len)
+                append_elided(_out, len - shown);
+            _out += ']';
+        }
+
+        void uniform_vector(const uint8_t*& ptr, bool print) {
+            const uint8_t* dtype_at = ptr;
+            need(ptr, 1 + 4 + 1);
+            auto dtype = static_cast<legacy_uniform_type>(*ptr++);
+            size_t len = read_u32(ptr);
+            size_t npad = *ptr++;
+            need(ptr, npad);
+            ptr += npad;
+
+            size_t width = legacy_uniform_element_size(dtype);
+            if (width == 0)
+                throw malformed{dtype_at};
+            if (len > static_cast<size_t>(_end - ptr) / width)
+                throw malformed{ptr};
+
+            if (print) {
+                switch (dtype) {
+                    case legacy_uniform_type::U8:  uniform_elements<uint8_t>(ptr, len); break;
+                    case legacy_uniform_type::S8:  uniform_elements<int8_t>(ptr, len); break;
+                    case legacy_uniform_type::U16: uniform_elements<uint16_t>(ptr, len); break;
+                    case legacy_uniform_type::S16: uniform_elements<int16_t>(ptr, len); break;
+                    case legacy_uniform_type::U32: uniform_elements<uint32_t>(ptr, len); break;
+                    case legacy_uniform_type::S32: uniform_elements<int32_t>(ptr, len); break;
+                    case legacy_uniform_type::U64: uniform_elements<uint64_t>(ptr, len); break;
+                    case legacy_uniform_type::S64: uniform_elements<int64_t>(ptr, len); break;
+                    case legacy_uniform_type::F32: uniform_elements<float>(ptr, len); break;
+                    case legacy_uniform_type::F64: uniform_elements<double>(ptr, len); break;
+                    case legacy_uniform_type::C32: uniform_elements<std::complex<float>>(ptr, len); break;
+                    case legacy_uniform_type::C64: uniform_elements<std::complex<double>>(ptr, len); break;
+                    default: break;
+                }
+            }
+            ptr += len * width;
+        }
+
+        std::string& _out;
+        const uint8_t* _end;
+        const format_options& _opts;
+    };
+
+} // namespace
+
+void format_to(std::string& out, const std::shared_ptr<legacy::pmt_t>& obj, const format_options& opts) {
+    format_node(out, obj, opts, 0);
+}
+
+void format_to(std::string& out, const pmtv::pmt& obj, const format_options& opts) {
+    format_pmtv(out, obj, opts, 0);
+}
+
+bool format_legacy_to(std::string& out, const uint8_t* data, size_t size, const format_options& opts) {
+    bytes_formatter fmt(out, data + size, opts);
+    const uint8_t* ptr = data;
+    try {
+        fmt.node(ptr, 0, true);
+    } catch (const malformed& m) {
+        out += "<malformed at offset ";
+        append_number(out, static_cast<size_t>(m.at - data));
+        out += '>';
+        return false;
+    }
+    return true;
+}
+
+} // namespace legacy_pmt
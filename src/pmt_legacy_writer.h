@@ -0,0 +1,253 @@
+#pragma once
+
+#include <pmt_converter/legacy/pmt_legacy.h>
+#include <pmt_converter/pmt_legacy_format.h>
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <memory>
+#include <vector>
+
+namespace legacy_pmt::detail {
+
+/**
+ * Canonical legacy encoding of legacy::pmt_t trees, written through a sink so
+ * the same walk feeds both the byte encoder and the structural hash. Anything
+ * with put(const uint8_t*, size_t) is a sink.
+ */
+
+inline bool fits_int32(int64_t v) {
+    return v >= std::numeric_limits<int32_t>::min() && v <= std::numeric_limits<int32_t>::max();
+}
+
+/** Writes into a buffer the caller has already sized. */
+struct pointer_sink {
+    uint8_t* ptr;
+
+    void put(const uint8_t* data, size_t n) {
+        std::memcpy(ptr, data, n);
+        ptr += n;
+    }
+};
+
+/**
+ * Streaming 64-bit hash of a byte sequence (murmur3-style word mixing). The
+ * result depends only on the bytes, not on how they were split across put()
+ * calls, and is the same on every host.
+ */
+class hash_sink {
+public:
+    void put(const uint8_t* data, size_t n) {
+        _len += n;
+        if (_fill) {
+            size_t take = std::min(n, sizeof(_buf) - _fill);
+            std::memcpy(_buf + _fill, data, take);
+            _fill += take;
+            data += take;
+            n -= take;
+            if (_fill < sizeof(_buf))
+                return;
+            mix(load(_buf));
+            _fill = 0;
+        }
+        for (; n >= 8; data += 8, n -= 8)
+            mix(load(data));
+        std::memcpy(_buf, data, n);
+        _fill = n;
+    }
+
+    uint64_t finish() const {
+        uint64_t h = _h;
+        if (_fill) {
+            uint8_t tail[8]{};
+            std::memcpy(tail, _buf, _fill);
+            h ^= scramble(load(tail));
+        }
+        h ^= _len;
+        h ^= h >> 33;
+        h *= 0xff51afd7ed558ccdULL;
+        h ^= h >> 33;
+        h *= 0xc4ceb9fe1a85ec53ULL;
+        h ^= h >> 33;
+        return h;
+    }
+
+private:
+    static uint64_t load(const uint8_t* p) {
+        uint64_t w;
+        std::memcpy(&w, p, sizeof(w));
+        if constexpr (std::endian::native == std::endian::big)
+            w = __builtin_bswap64(w);
+        return w;
+    }
+
+    static uint64_t scramble(uint64_t w) {
+        w *= 0x87c37b91114253d5ULL;
+        w = std::rotl(w, 31);
+        return w * 0x4cf5ad432745937fULL;
+    }
+
+    void mix(uint64_t w) {
+        _h ^= scramble(w);
+        _h = std::rotl(_h, 27) * 5 + 0x52dce729;
+    }
+
+    uint64_t _h = 0x9e3779b97f4a7c15ULL;
+    uint64_t _len = 0;
+    uint8_t _buf[8];
+    size_t _fill = 0;
+};
+
+inline uint64_t hash_bytes(const uint8_t* data, size_t size) {
+    hash_sink h;
+    h.put(data, size);
+    return h.finish();
+}
+
+template <typename Sink>
+void write_node(const std::shared_ptr<legacy::pmt_t>& obj, Sink& sink);
+
+inline uint64_t hash_node(const std::shared_ptr<legacy::pmt_t>& obj) {
+    hash_sink h;
+    write_node(obj, h);
+    return h.finish();
+}
+
+/** Appends to a byte vector. */
+struct vector_sink {
+    std::vector<uint8_t>& out;
+
+    void put(const uint8_t* data, size_t n) { out.insert(out.end(), data, data + n); }
+};
+
+inline std::vector<uint8_t> encode_node(const std::shared_ptr<legacy::pmt_t>& obj) {
+    std::vector<uint8_t> out;
+    vector_sink sink{out};
+    write_node(obj, sink);
+    return out;
+}
+
+/**
+ * Dict entries in canonical order: symbol keys first, sorted by name, then any
+ * other keys sorted by the hash of their own encoding. Entries that still tie
+ * (equal names, equal or colliding key hashes) are ordered by their key and
+ * then value encodings, never by where the keys happen to live in memory.
+ * Dicts of up to inline_capacity entries are ordered without allocating.
+ */
+class ordered_entries {
+public:
+    using value_type = const legacy::pmt_dict::value_type*;
+
+    static constexpr size_t inline_capacity = 16;
+
+    explicit ordered_entries(const legacy::pmt_dict& d) : _size(d.size()) {
+        if (_size > inline_capacity)
+            _heap.resize(_size);
+        _entries = _size > inline_capacity ? _heap.data() : _inline.data();
+        entry* e = _entries;
+        for (const auto& kv : d) {
+            bool symbol = kv.first && kv.first->is_symbol();
+            *e++ = {&kv, symbol, symbol ? 0 : hash_node(kv.first)};
+        }
+        std::sort(_entries, _entries + _size, before);
+    }
+
+    // _entries may point into this object
+    ordered_entries(const ordered_entries&) = delete;
+    ordered_entries& operator=(const ordered_entries&) = delete;
+
+    size_t size() const { return _size; }
+    value_type operator[](size_t i) const { return _entries[i].kv; }
+
+private:
+    struct entry {
+        value_type kv;
+        bool symbol;
+        uint64_t key_hash;
+    };
+
+    static bool before(const entry& a, const entry& b) {
+        if (a.symbol != b.symbol)
+            return a.symbol;
+        if (a.symbol) {
+            int c = a.kv->first->to_symbol().compare(b.kv->first->to_symbol());
+            if (c != 0)
+                return c < 0;
+        } else if (a.key_hash != b.key_hash) {
+            return a.key_hash < b.key_hash;
+        } else {
+            auto ka = encode_node(a.kv->first);
+            auto kb = encode_node(b.kv->first);
+            if (ka != kb)
+                return ka < kb;
+        }
+        // Equal keys held by different objects
+        return encode_node(a.kv->second) < encode_node(b.kv->second);
+    }
+
+    size_t _size;
+    entry* _entries;
+    std::array<entry, inline_capacity> _inline;
+    std::vector<entry> _heap;
+};
+
+template <typename Sink>
+void write_tag(Sink& sink, legacy_tag tag) {
+    const uint8_t b = static_cast<uint8_t>(tag);
+    sink.put(&b, 1);
+}
+
+template <typename Sink>
+void write_node(const std::shared_ptr<legacy::pmt_t>& obj, Sink& sink) {
+    uint8_t buf[9]{};
+    uint8_t* p = buf;
+
+    if (!obj) {
+        write_tag(sink, legacy_tag::LEGACY_PMT_NULL);
+    } else if (obj->is_bool()) {
+        write_tag(sink, obj->to_bool() ? legacy_tag::LEGACY_PMT_TRUE : legacy_tag::LEGACY_PMT_FALSE);
+    } else if (obj->is_int()) {
+        int64_t v = obj->to_int();
+        if (fits_int32(v)) {
+            write_u8(p, static_cast<uint8_t>(legacy_tag::LEGACY_PMT_INT32));
+            write_u32(p, static_cast<uint32_t>(v));
+        } else {
+            write_u8(p, static_cast<uint8_t>(legacy_tag::LEGACY_PMT_INT64));
+            write_u64(p, static_cast<uint64_t>(v));
+        }
+        sink.put(buf, static_cast<size_t>(p - buf));
+    } else if (obj->is_symbol()) {
+        const std::string& sym = obj->to_symbol();
+        write_u8(p, static_cast<uint8_t>(legacy_tag::LEGACY_PMT_SYMBOL));
+        write_u16(p, static_cast<uint32_t>(sym.size()));
+        sink.put(buf, symbol_header_size);
+        sink.put(reinterpret_cast<const uint8_t*>(sym.data()), sym.size());
+    } else if (obj->is_pair()) {
+        write_tag(sink, legacy_tag::LEGACY_PMT_PAIR);
+        write_node(obj->car(), sink);
+        write_node(obj->cdr(), sink);
+    } else if (obj->is_vector()) {
+        const auto& vec = obj->to_vector();
+        write_u8(p, static_cast<uint8_t>(legacy_tag::LEGACY_PMT_VECTOR));
+        write_u32(p, static_cast<uint32_t>(vec.size()));
+        sink.put(buf, 5);
+        for (const auto& item : vec)
+            write_node(item, sink);
+    } else if (obj->is_dict()) {
+        const uint8_t link[2] = {static_cast<uint8_t>(legacy_tag::LEGACY_PMT_DICT),
+                                 static_cast<uint8_t>(legacy_tag::LEGACY_PMT_PAIR)};
+        ordered_entries entries(obj->to_dict());
+        for (size_t i = 0; i < entries.size(); ++i) {
+            sink.put(link, sizeof(link));
+            write_node(entries[i]->first, sink);
+            write_node(entries[i]->second, sink);
+        }
+        write_tag(sink, legacy_tag::LEGACY_PMT_NULL);
+    }
+}
+
+} // namespace legacy_pmt::detail
@@ -0,0 +1,277 @@
+#include <pmt_converter/pmt_message_ring.h>
+#include <pmt_converter/pmt_legacy_codec.h>
+#include "pmt_legacy_codec_detail.h"
+
+#include <atomic>
+#include <bit>
+#include <cerrno>
+#include <cstring>
+#include <new>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <utility>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace legacy_pmt {
+
+// Shared control block at the start of the mapping. head and tail are
+// monotonically increasing byte positions; only the producer writes head and
+// only the consumer writes tail, each on its own cache line.
+struct message_ring::header {
+    uint64_t magic;
+    uint32_t version;
+    uint32_t reserved;
+    uint64_t capacity;
+    alignas(64) std::atomic<uint64_t> head;
+    alignas(64) std::atomic<uint64_t> tail;
+};
+
+static_assert(std::atomic<uint64_t>::is_always_lock_free,
+              "message_ring requires lock-free 64-bit atomics to be shared between processes");
+
+static constexpr uint64_t ring_magic = 0x4c50'4d54'5249'4e47ULL; // "LPMTRING"
+static constexpr uint32_t ring_version = 1;
+
+// Every record is a native-endian u32 length followed by the encoded message,
+// padded to 8 bytes. A length of wrap_marker means "continue at offset 0".
+static constexpr uint32_t wrap_marker = 0xFFFFFFFF;
+static constexpr size_t record_align = 8;
+
+static size_t record_size(size_t payload) {
+    return (sizeof(uint32_t) + payload + record_align - 1) & ~(record_align - 1);
+}
+
+static std::system_error errno_error(const char* what) {
+    return std::system_error(errno, std::generic_category(), what);
+}
+
+message_ring message_ring::create(size_t capacity) {
+    int fd = ::memfd_create("pmt_message_ring", MFD_CLOEXEC);
+    if (fd < 0)
+        throw errno_error("memfd_create");
+    return message_ring(fd, true, capacity);
+}
+
+message_ring message_ring::create_shared(const std::string& name, size_t capacity) {
+    int fd = ::shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+    if (fd < 0)
+        throw errno_error("shm_open");
+    try {
+        return message_ring(fd, true, capacity);
+    } catch (...) {
+        ::shm_unlink(name.c_str());
+        throw;
+    }
+}
+
+message_ring message_ring::open_shared(const std::string& name) {
+    int fd = ::shm_open(name.c_str(), O_RDWR, 0);
+    if (fd < 0)
+        throw errno_error("shm_open");
+    return message_ring(fd, false, 0);
+}
+
+message_ring message_ring::from_fd(int fd) {
+    int own = ::fcntl(fd, F_DUPFD_CLOEXEC, 0);
+    if (own < 0)
+        throw errno_error("dup");
+    return message_ring(own, false, 0);
+}
+
+void message_ring::unlink_shared(const std::string& name) {
+    if (::shm_unlink(name.c_str()) != 0 && errno != ENOENT)
+        throw errno_error("shm_unlink");
+}
+
+message_ring::message_ring(int fd, bool initialize, size_t capacity) : _fd(fd) {
+    try {
+        if (initialize) {
+            if (capacity < 2 * record_align)
+                throw std::invalid_argument("message_ring capacity too small");
+            capacity = std::bit_ceil(capacity);
+            _map_size = sizeof(header) + capacity;
+            if (::ftruncate(_fd, static_cast<off_t>(_map_size)) != 0)
+                throw errno_error("ftruncate");
+        } else {
+            struct stat st;
+            if (::fstat(_fd, &st) != 0)
+                throw errno_error("fstat");
+            _map_size = static_cast<size_t>(st.st_size);
+            if (_map_size < sizeof(header))
+                throw std::runtime_error("Shared memory object is not a message_ring");
+        }
+
+        void* base = ::mmap(nullptr, _map_size, PROT_READ | PROT_WRITE, MAP_SHARED, _fd, 0);
+        if (base == MAP_FAILED)
+            throw errno_error("mmap");
+        _hdr = static_cast<header*>(base);
+        _data = static_cast<uint8_t*>(base) + sizeof(header);
+
+        if (initialize) {
+            new (&_hdr->head) std::atomic<uint64_t>(0);
+            new (&_hdr->tail) std::atomic<uint64_t>(0);
+            _hdr->capacity = capacity;
+            _hdr->version = ring_version;
+            _hdr->reserved = 0;
+            std::atomic_ref<uint64_t>(_hdr->magic).store(ring_magic, std::memory_order_release);
+        } else if (std::atomic_ref<uint64_t>(_hdr->magic).load(std::memory_order_acquire) != ring_magic ||
+                   _hdr->version != ring_version ||
+                   !std::has_single_bit(_hdr->capacity) ||
+                   _hdr->capacity + sizeof(header) != _map_size) {
+            throw std::runtime_error("Shared memory object is not a compatible message_ring");
+        }
+    } catch (...) {
+        if (_hdr)
+            ::munmap(_hdr, _map_size);
+        ::close(_fd);
+        throw;
+    }
+
+    _tail_cache = _hdr->tail.load(std::memory_order_acquire);
+    _head_cache = _hdr->head.load(std::memory_order_acquire);
+}
+
+message_ring::message_ring(message_ring&& other) noexcept
+    : _hdr(std::exchange(other._hdr, nullptr)),
+      _data(std::exchange(other._data, nullptr)),
+      _map_size(std::exchange(other._map_size, 0)),
+      _fd(std::exchange(other._fd, -1)),
+      _tail_cache(other._tail_cache),
+      _reserved_pos(other._reserved_pos),
+      _reserved_size(other._reserved_size),
+      _head_cache(other._head_cache),
+      _peek_next(other._peek_next) {}
+
+message_ring& message_ring::operator=(message_ring&& other) noexcept {
+    if (this != &other) {
+        this->~message_ring();
+        new (this) message_ring(std::move(other));
+    }
+    return *this;
+}
+
+message_ring::~message_ring() {
+    if (_hdr)
+        ::munmap(_hdr, _map_size);
+    if (_fd >= 0)
+        ::close(_fd);
+}
+
+size_t message_ring::capacity() const {
+    return _hdr->capacity;
+}
+
+uint8_t* message_ring::try_reserve(size_t size) {
+    const uint64_t cap = _hdr->capacity;
+    const size_t need = record_size(size);
+    // Anything up to half the ring is guaranteed to fit once the ring drains,
+    // regardless of where the write position sits.
+    if (size == 0 || size >= wrap_marker || need > cap / 2)
+        throw std::length_error("Message size not supported by message_ring");
+
+    uint64_t head = _hdr->head.load(std::memory_order_relaxed);
+    size_t off = head & (cap - 1);
+    size_t contiguous = cap - off;
+    size_t total = need <= contiguous ? need : contiguous + need;
+
+    if (total > cap - (head - _tail_cache)) {
+        _tail_cache = _hdr->tail.load(std::memory_order_acquire);
+        if (total > cap - (head - _tail_cache))
+            return nullptr;
+    }
+
+    if (need > contiguous) {
+        std::memcpy(_data + off, &wrap_marker, sizeof(uint32_t));
+        head += contiguous;
+        off = 0;
+    }
+
+    _reserved_pos = head;
+    _reserved_size = size;
+    return _data + off + sizeof(uint32_t);
+}
+
+void message_ring::commit() {
+    const uint64_t cap = _hdr->capacity;
+    uint32_t len = static_cast<uint32_t>(_reserved_size);
+    std::memcpy(_data + (_reserved_pos & (cap - 1)), &len, sizeof(uint32_t));
+    _hdr->head.store(_reserved_pos + record_size(_reserved_size), std::memory_order_release);
+}
+
+bool message_ring::try_push(const pmtv::pmt& obj) {
+    size_t size = legacy_serialized_size(obj);
+    uint8_t* out = try_reserve(size);
+    if (!out)
+        return false;
+    detail::serialize_legacy_sized(obj, out);
+    commit();
+    return true;
+}
+
+bool message_ring::try_push(const uint8_t* data, size_t size) {
+    uint8_t* out = try_reserve(size);
+    if (!out)
+        return false;
+    std::memcpy(out, data, size);
+    commit();
+    return true;
+}
+
+std::span<const uint8_t> message_ring::try_peek() {
+    const uint64_t cap = _hdr->capacity;
+    uint64_t tail = _hdr->tail.load(std::memory_order_relaxed);
+
+    while (true) {
+        if (tail == _head_cache) {
+            _head_cache = _hdr->head.load(std::memory_order_acquire);
+            if (tail == _head_cache)
+                return {};
+        }
+
+        size_t off = tail & (cap - 1);
+        uint32_t len;
+        std::memcpy(&len, _data + off, sizeof(uint32_t));
+        if (len == wrap_marker) {
+            tail += cap - off;
+            _hdr->tail.store(tail, std::memory_order_release);
+            continue;
+        }
+
+        // The length comes from the producer's side of the mapping; a record
+        // must lie within the published data and not run past the ring end
+        if (len == 0 || record_size(len) > cap - off || record_size(len) > _head_cache - tail)
+            throw std::runtime_error("Corrupt message_ring record of length " + std::to_string(len) +
+                                     " at position " + std::to_string(tail));
+
+        _peek_next = tail + record_size(len);
+        return {_data + off + sizeof(uint32_t), len};
+    }
+}
+
+void message_ring::release() {
+    _hdr->tail.store(_peek_next, std::memory_order_release);
+}
+
+std::optional<pmtv::pmt> message_ring::try_pop() {
+    auto msg = try_peek();
+    if (msg.empty())
+        return std::nullopt;
+
+    std::optional<pmtv::pmt> obj;
+    try {
+        obj = deserialize_from_legacy(msg.data(), msg.size());
+    } catch (...) {
+        // Drop the undecodable message so the ring does not stall on it
+        release();
+        throw;
+    }
+    release();
+    return obj;
+}
+
+} // namespace legacy_pmt
@@ -0,0 +1,115 @@
+#include "thread_pool.h"
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace legacy_pmt::detail {
+
+namespace {
+
+struct job {
+    const std::function<void(size_t)>* fn;
+    size_t num_chunks;
+    unsigned max_helpers;
+    std::atomic<size_t> next{0};
+    unsigned helpers = 0; // guarded by pool mutex
+    unsigned active = 0;  // guarded by pool mutex
+
+    void run_chunks() {
+        for (size_t i = next.fetch_add(1, std::memory_order_relaxed); i < num_chunks;
+             i = next.fetch_add(1, std::memory_order_relaxed)) {
+            (*fn)(i);
+        }
+    }
+};
+
+// Workers are started once and shared by every caller. Each job is run by the
+// calling thread plus up to max_helpers workers pulling chunk indices from a
+// shared counter, so concurrent callers never wait on each other's jobs.
+class thread_pool {
+public:
+    static thread_pool& instance() {
+        static thread_pool pool;
+        return pool;
+    }
+
+    unsigned size() const { return static_cast<unsigned>(_workers.size()) + 1; }
+
+    void run(job& j) {
+        if (j.max_helpers > 0) {
+            std::lock_guard lock(_mutex);
+            _jobs.push_back(&j);
+            _work_cv.notify_all();
+        }
+
+        j.run_chunks();
+
+        std::unique_lock lock(_mutex);
+        std::erase(_jobs, &j);
+        _done_cv.wait(lock, [&] { return j.active == 0; });
+    }
+
+private:
+    thread_pool() {
+        unsigned n = std::max(1u, std::thread::hardware_concurrency());
+        for (unsigned i = 1; i < n; ++i)
+            _workers.emplace_back([this](std::stop_token st) { worker(st); });
+    }
+
+    ~thread_pool() {
+        {
+            std::lock_guard lock(_mutex);
+            for (auto& w : _workers)
+                w.request_stop();
+        }
+        _work_cv.notify_all();
+    }
+
+    void worker(std::stop_token st) {
+        std::unique_lock lock(_mutex);
+        while (true) {
+            _work_cv.wait(lock, [&] { return st.stop_requested() || !_jobs.empty(); });
+            if (st.stop_requested())
+                return;
+
+            job* j = _jobs.front();
+            if (++j->helpers >= j->max_helpers)
+                _jobs.pop_front();
+            ++j->active;
+
+            lock.unlock();
+            j->run_chunks();
+            lock.lock();
+
+            if (--j->active == 0)
+                _done_cv.notify_all();
+        }
+    }
+
+    std::mutex _mutex;
+    std::condition_variable _work_cv;
+    std::condition_variable _done_cv;
+    std::deque<job*> _jobs;
+    std::vector<std::jthread> _workers;
+};
+
+} // namespace
+
+void parallel_for(size_t num_chunks, unsigned max_threads, const std::function<void(size_t)>& fn) {
+    auto& pool = thread_pool::instance();
+    unsigned threads = max_threads == 0 ? pool.size() : std::min(max_threads, pool.size());
+    threads = static_cast<unsigned>(std::min<size_t>(threads, num_chunks));
+
+    job j;
+    j.fn = &fn;
+    j.num_chunks = num_chunks;
+    j.max_helpers = threads > 0 ? threads - 1 : 0;
+    pool.run(j);
+}
+
+} // namespace legacy_pmt::detail
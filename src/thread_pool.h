@@ -0,0 +1,15 @@
+#pragma once
+
+#include <cstddef>
+#include <functional>
+
+namespace legacy_pmt::detail {
+
+/**
+ * Run fn(chunk) for every chunk in [0, num_chunks) on the shared codec thread
+ * pool, using at most max_threads threads including the caller (0 means all
+ * hardware threads). Returns once every chunk has completed. fn must not throw.
+ */
+void parallel_for(size_t num_chunks, unsigned max_threads, const std::function<void(size_t)>& fn);
+
+} // namespace legacy_pmt::detail
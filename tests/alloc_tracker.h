@@ -0,0 +1,91 @@
+#pragma once
+
+#include <cstddef>
+#include <memory_resource>
+
+// Allocation accounting for tests and benchmarks. Executables using it link
+// alloc_tracker.cpp, which replaces the global operator new/delete.
+
+namespace alloc_tracker {
+
+struct counts {
+    size_t allocations = 0;
+    size_t deallocations = 0;
+    size_t bytes = 0; // requested by allocations
+};
+
+/** Totals of the global operator new/delete since process start, all threads. */
+counts global_counts();
+
+/** Counts allocations passing through it to upstream. */
+class counting_resource : public std::pmr::memory_resource {
+public:
+    explicit counting_resource(std::pmr::memory_resource* upstream = std::pmr::get_default_resource())
+        : _upstream(upstream) {}
+
+    counts totals() const { return _counts; }
+
+private:
+    void* do_allocate(size_t bytes, size_t alignment) override {
+        ++_counts.allocations;
+        _counts.bytes += bytes;
+        return _upstream->allocate(bytes, alignment);
+    }
+
+    void do_deallocate(void* p, size_t bytes, size_t alignment) override {
+        ++_counts.deallocations;
+        _upstream->deallocate(p, bytes, alignment);
+    }
+
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override { return this == &other; }
+
+    std::pmr::memory_resource* _upstream;
+    counts _counts;
+};
+
+/**
+ * Allocations made while the scope is alive. heap() counts the global
+ * operator new/delete on every thread, so work handed to the thread pool is
+ * included. For the same lifetime the default std::pmr resource is wrapped
+ * in a counting_resource, reported by pmr(); with the usual
+ * new_delete_resource upstream those allocations show up in heap() too.
+ */
+class scope {
+public:
+    scope() : _start(global_counts()), _previous(std::pmr::set_default_resource(&_pmr)) {}
+    ~scope() { std::pmr::set_default_resource(_previous); }
+    scope(const scope&) = delete;
+    scope& operator=(const scope&) = delete;
+
+    counts heap() const {
+        counts now = global_counts();
+        return {now.allocations - _start.allocations, now.deallocations - _start.deallocations,
+                now.bytes - _start.bytes};
+    }
+
+    counts pmr() const { return _pmr.totals(); }
+
+private:
+    counts _start;
+    counting_resource _pmr;
+    std::pmr::memory_resource* _previous;
+};
+
+/**
+ * Heap activity of fn per call, averaged over iterations calls after one
+ * warm-up call that absorbs one-time setup (dispatch tables, thread pool).
+ * The average rounds up, so a single allocation in any call reports at least
+ * one and a zero budget means no allocation at all.
+ */
+template <typename Fn>
+counts per_call(Fn&& fn, size_t iterations = 16) {
+    fn();
+    scope s;
+    for (size_t i = 0; i < iterations; ++i)
+        fn();
+    counts c = s.heap();
+    auto average = [iterations](size_t total) { return (total + iterations - 1) / iterations; };
+    return {average(c.allocations), average(c.deallocations), average(c.bytes)};
+}
+
+} // namespace alloc_tracker
@@ -0,0 +1,181 @@
+#include <gtest/gtest.h>
+#include "alloc_tracker.h"
+#include <pmt_converter/pmt_converter.h>
+#include <pmt_converter/pmt_legacy_codec.h>
+#include <pmt_converter/pmt_legacy_editor.h>
+#include <pmt_converter/pmt_legacy_framed.h>
+#include <pmt_converter/pmt_legacy_pdu.h>
+#include <pmt_converter/pmt_legacy_schema.h>
+#include <pmt_converter/pmt_legacy_tensor.h>
+#include <pmt_converter/pmt_message_ring.h>
+#include <complex>
+#include <cstdio>
+#include <memory_resource>
+#include <string>
+#include <vector>
+
+// Allocation budgets of the hot paths. Encoding into a caller's buffer, sizing,
+// framing, schema encoding, ring transfer and in-place edits must not touch
+// the heap at all; decoding is limited to the storage of the decoded value.
+
+namespace {
+
+    using alloc_tracker::per_call;
+
+    struct rx_tag {
+        int64_t rx_time;
+        double rx_rate;
+        std::string label;
+    };
+    using rx_tag_schema = legacy_pmt::legacy_schema<rx_tag,
+                                                    legacy_pmt::field<"rx_time", &rx_tag::rx_time>,
+                                                    legacy_pmt::field<"rx_rate", &rx_tag::rx_rate>,
+                                                    legacy_pmt::field<"label", &rx_tag::label>>;
+
+    struct message_type {
+        const char* name;
+        pmtv::pmt value;
+    };
+
+    std::vector<message_type> message_types() {
+        return {{"int64", pmtv::pmt(static_cast<int64_t>(1) << 40)},
+                {"double", pmtv::pmt(2.4e9)},
+                {"symbol", pmtv::pmt("a_symbol_too_long_for_small_string_storage")},
+                {"tag_dict", pmtv::map_t({{"rx_time", static_cast<int64_t>(249387429783478)},
+                                          {"rx_rate", 2.4e6},
+                                          {"label", "burst_start"}})},
+                {"c32_burst", pmtv::Tensor<std::complex<float>>(4096, {0.5f, -0.5f})}};
+    }
+
+    TEST(AllocBudgetTest, TrackerCounts) {
+        alloc_tracker::scope s;
+        // Stored through a volatile pointer so the pair cannot be elided
+        int64_t* volatile p = new int64_t(1);
+        delete p;
+        std::pmr::vector<uint8_t> v(100);
+        EXPECT_GE(s.heap().allocations, 2u);
+        EXPECT_GE(s.heap().bytes, sizeof(int64_t) + 100);
+        EXPECT_EQ(s.pmr().allocations, 1u);
+        EXPECT_EQ(s.pmr().bytes, 100u);
+
+        // An allocation in only some of the calls still breaks a zero budget
+        size_t calls = 0;
+        auto occasional = [&] {
+            if (++calls == 8) {
+                int64_t* volatile q = new int64_t(1);
+                delete q;
+            }
+        };
+        EXPECT_EQ(per_call(occasional).allocations, 1u);
+    }
+
+    TEST(AllocBudgetTest, EncodeIntoBufferIsAllocationFree) {
+        for (const auto& [name, obj] : message_types()) {
+            SCOPED_TRACE(name);
+            std::vector<uint8_t> buf(legacy_pmt::framed_size(obj));
+            EXPECT_EQ(per_call([&] { legacy_pmt::legacy_serialized_size(obj); }).allocations, 0u);
+            EXPECT_EQ(per_call([&] { legacy_pmt::serialize_to_legacy(obj, buf.data(), buf.size()); }).allocations, 0u);
+            EXPECT_EQ(per_call([&] { legacy_pmt::serialize_framed(obj, buf.data(), buf.size()); }).allocations, 0u);
+        }
+    }
+
+    TEST(AllocBudgetTest, ByteLevelPathsAreAllocationFree) {
+        for (const auto& [name, obj] : message_types()) {
+            SCOPED_TRACE(name);
+            auto bytes = legacy_pmt::serialize_to_legacy(obj);
+            EXPECT_EQ(per_call([&] { legacy_pmt::legacy_encoded_size(bytes.data(), bytes.size()); }).allocations, 0u);
+        }
+
+        rx_tag tag{249387429783478, 2.4e6, "burst_start"};
+        std::vector<uint8_t> buf(rx_tag_schema::size(tag));
+        EXPECT_EQ(per_call([&] { rx_tag_schema::serialize(tag, buf.data(), buf.size()); }).allocations, 0u);
+
+        legacy_pmt::legacy_editor editor{std::span<uint8_t>(buf)};
+        int64_t t = 0;
+        EXPECT_EQ(per_call([&] { editor.set({"rx_time"}, ++t); }).allocations, 0u);
+
+        std::vector<std::complex<float>> capture(8 * 512);
+        std::vector<size_t> extents{8, 512};
+        std::vector<ptrdiff_t> strides{1, 8};
+        legacy_pmt::tensor_view<std::complex<float>> view{capture.data(), extents, strides};
+        std::vector<uint8_t> out(legacy_pmt::legacy_tensor_size(view));
+        EXPECT_EQ(per_call([&] { legacy_pmt::serialize_tensor_to_legacy(view, out.data(), out.size()); }).allocations,
+                  0u);
+
+        pmtv::map_t meta({{"packet_len", static_cast<int32_t>(1500)}, {"snr", 17.5}});
+        pmtv::Tensor<uint8_t> pdu(1500, 0x55);
+        std::vector<uint8_t> pdu_buf(legacy_pmt::legacy_pdu_size(meta, pdu));
+        EXPECT_EQ(per_call([&] { legacy_pmt::serialize_pdu(meta, pdu, pdu_buf.data(), pdu_buf.size()); }).allocations,
+                  0u);
+        legacy_pmt::pdu_encoder encoder;
+        EXPECT_EQ(per_call([&] { encoder.encode(meta, pdu); }).allocations, 0u);
+    }
+
+    TEST(AllocBudgetTest, RingTransferIsAllocationFree) {
+        auto ring = legacy_pmt::message_ring::create(1 << 20);
+        pmtv::pmt obj = message_types()[3].value;
+        auto bytes = legacy_pmt::serialize_to_legacy(obj);
+
+        EXPECT_EQ(per_call([&] {
+                      ring.try_push(obj);
+                      ring.try_peek();
+                      ring.release();
+                  }).allocations,
+                  0u);
+        EXPECT_EQ(per_call([&] {
+                      ring.try_push(bytes.data(), bytes.size());
+                      ring.try_peek();
+                      ring.release();
+                  }).allocations,
+                  0u);
+    }
+
+    TEST(AllocBudgetTest, LegacyTagComparisonIsAllocationFree) {
+        // legacy::pmt_t has no doubles, so a tag dict of ints and symbols
+        pmtv::pmt value = pmtv::map_t({{"rx_time", static_cast<int64_t>(249387429783478)},
+                                       {"packet_len", static_cast<int32_t>(1500)},
+                                       {"label", "burst_start"}});
+        auto tag = gr_compat::to_legacy_pmt(value);
+        auto copy = gr_compat::to_legacy_pmt(value);
+        EXPECT_EQ(per_call([&] { EXPECT_TRUE(legacy::deep_equal(tag, copy)); }).allocations, 0u);
+    }
+
+    TEST(AllocBudgetTest, DecodeOnlyAllocatesTheValue) {
+        auto decode_allocs = [](const pmtv::pmt& obj) {
+            auto bytes = legacy_pmt::serialize_to_legacy(obj);
+            return per_call([&] { legacy_pmt::deserialize_from_legacy(bytes.data(), bytes.size()); }).allocations;
+        };
+        auto types = message_types();
+        EXPECT_EQ(decode_allocs(types[0].value), 0u);
+        EXPECT_EQ(decode_allocs(types[1].value), 0u);
+        // The string itself; the symbol is too long for small string storage
+        EXPECT_EQ(decode_allocs(types[2].value), 1u);
+        // A map node and at most one string per entry
+        EXPECT_LE(decode_allocs(types[3].value), 2u * 3u);
+        // One buffer for the samples; a Tensor may keep its extents on the heap too
+        EXPECT_LE(decode_allocs(types[4].value), 2u);
+    }
+
+    // Not a budget: prints the per-call profile of every path and message
+    // type, so changes show up in test logs
+    TEST(AllocBudgetTest, Report) {
+        std::printf("%-10s %-24s %8s %10s\n", "type", "path", "allocs", "bytes");
+        auto row = [](const char* type, const char* path, alloc_tracker::counts c) {
+            std::printf("%-10s %-24s %8zu %10zu\n", type, path, c.allocations, c.bytes);
+        };
+        for (const auto& [name, obj] : message_types()) {
+            auto bytes = legacy_pmt::serialize_to_legacy(obj);
+            row(name, "serialize_to_legacy", per_call([&] { legacy_pmt::serialize_to_legacy(obj); }));
+            row(name, "deserialize_from_legacy",
+                per_call([&] { legacy_pmt::deserialize_from_legacy(bytes.data(), bytes.size()); }));
+            // The gr_compat converters cover a subset of the types
+            try {
+                auto legacy = gr_compat::to_legacy_pmt(obj);
+                row(name, "gr_compat::to_legacy", per_call([&] { gr_compat::to_legacy_pmt(obj); }));
+                row(name, "gr_compat::to_new", per_call([&] { gr_compat::to_new_pmt(legacy); }));
+            } catch (const std::runtime_error&) {
+            }
+        }
+    }
+
+} // namespace
@@ -0,0 +1,154 @@
+#include <gtest/gtest.h>
+#include <pmt_converter/legacy/pmt_legacy_hash.h>
+#include <pmt_converter/pmt_legacy_codec.h>
+#include <pmt_converter/pmt_legacy_corpus.h>
+#include <pmt_converter/pmt_legacy_format.h>
+#include <pmt_converter/pmt_legacy_text.h>
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+using legacy_pmt::corpus_kind;
+using legacy_pmt::corpus_options;
+
+namespace {
+
+    corpus_options only(corpus_kind kind, size_t messages = 50) {
+        corpus_options opts;
+        opts.messages = messages;
+        opts.weights = {};
+        opts.weights[static_cast<size_t>(kind)] = 1;
+        return opts;
+    }
+
+    bool is_pdu(corpus_kind kind) { return kind == corpus_kind::pdu_u8 || kind == corpus_kind::pdu_c32; }
+
+    TEST(LegacyCorpusTest, Deterministic) {
+        corpus_options opts;
+        opts.messages = 500;
+        auto a = legacy_pmt::generate_legacy_corpus(opts);
+        auto b = legacy_pmt::generate_legacy_corpus(opts);
+        ASSERT_EQ(a.size(), 500u);
+        for (size_t i = 0; i < a.size(); ++i) {
+            EXPECT_EQ(a[i].kind, b[i].kind);
+            EXPECT_EQ(a[i].bytes, b[i].bytes);
+        }
+
+        opts.seed = 2;
+        auto c = legacy_pmt::generate_legacy_corpus(opts);
+        size_t same = 0;
+        for (size_t i = 0; i < a.size(); ++i)
+            same += a[i].bytes == c[i].bytes;
+        EXPECT_LT(same, a.size() / 10);
+    }
+
+    // Pinned output, so a generator change or a host-dependent byte order shows
+    // up as a failure rather than as silently different benchmark inputs
+    TEST(LegacyCorpusTest, GoldenHash) {
+        corpus_options opts;
+        opts.messages = 200;
+        std::vector<uint8_t> all;
+        for (const auto& msg : legacy_pmt::generate_legacy_corpus(opts))
+            all.insert(all.end(), msg.bytes.begin(), msg.bytes.end());
+        EXPECT_EQ(legacy_pmt::legacy_bytes_hash(all.data(), all.size()), 0xa82067be2fe8b105ULL);
+    }
+
+    TEST(LegacyCorpusTest, EveryMessageIsWellFormed) {
+        corpus_options opts;
+        opts.messages = 2000;
+        for (const auto& msg : legacy_pmt::generate_legacy_corpus(opts)) {
+            SCOPED_TRACE(legacy_pmt::corpus_kind_name(msg.kind));
+            ASSERT_EQ(legacy_pmt::legacy_encoded_size(msg.bytes.data(), msg.bytes.size()), msg.bytes.size());
+            std::string text;
+            EXPECT_TRUE(legacy_pmt::format_legacy_to(text, msg.bytes.data(), msg.bytes.size()));
+
+            if (is_pdu(msg.kind)) {
+                EXPECT_EQ(msg.bytes[0], static_cast<uint8_t>(legacy_pmt::legacy_tag::LEGACY_PMT_PAIR));
+                continue;
+            }
+            // Dict keys are in map order, so the codec reproduces every byte
+            auto obj = legacy_pmt::deserialize_from_legacy(msg.bytes.data(), msg.bytes.size());
+            EXPECT_EQ(legacy_pmt::serialize_to_legacy(obj), msg.bytes);
+        }
+    }
+
+    TEST(LegacyCorpusTest, MixFollowsWeights) {
+        corpus_options opts;
+        opts.messages = 20000;
+        opts.pdu_samples = {8, 8};
+        opts.burst_samples = {8, 8};
+        std::array<size_t, legacy_pmt::corpus_kind_count> counts{};
+        for (const auto& msg : legacy_pmt::generate_legacy_corpus(opts))
+            ++counts[static_cast<size_t>(msg.kind)];
+
+        uint32_t total = 0;
+        for (uint32_t w : opts.weights)
+            total += w;
+        for (size_t k = 0; k < counts.size(); ++k) {
+            double expected = static_cast<double>(opts.messages) * opts.weights[k] / total;
+            EXPECT_NEAR(static_cast<double>(counts[k]), expected, expected * 0.1 + 20) << k;
+        }
+
+        for (const auto& msg : legacy_pmt::generate_legacy_corpus(only(corpus_kind::nested_dict)))
+            EXPECT_EQ(msg.kind, corpus_kind::nested_dict);
+    }
+
+    TEST(LegacyCorpusTest, SizeRanges) {
+        auto opts = only(corpus_kind::c32_burst);
+        opts.burst_samples = {500, 500};
+        for (const auto& msg : legacy_pmt::generate_legacy_corpus(opts))
+            EXPECT_EQ(msg.bytes.size(), legacy_pmt::uniform_vector_header_size + 500 * 8);
+
+        opts.burst_samples = {100, 5000};
+        size_t smallest = SIZE_MAX, largest = 0;
+        for (const auto& msg : legacy_pmt::generate_legacy_corpus(opts)) {
+            size_t n = (msg.bytes.size() - legacy_pmt::uniform_vector_header_size) / 8;
+            EXPECT_GE(n, 100u);
+            EXPECT_LE(n, 5000u);
+            smallest = std::min(smallest, n);
+            largest = std::max(largest, n);
+        }
+        EXPECT_LT(smallest, 400u);
+        EXPECT_GT(largest, 1000u);
+
+        opts = only(corpus_kind::pdu_u8);
+        opts.pdu_bytes = {1500, 1500};
+        for (const auto& msg : legacy_pmt::generate_legacy_corpus(opts)) {
+            size_t meta = legacy_pmt::legacy_encoded_size(msg.bytes.data() + 1, msg.bytes.size() - 1);
+            EXPECT_EQ(msg.bytes.size(), 1 + meta + legacy_pmt::uniform_vector_header_size + 1500);
+            EXPECT_EQ(msg.bytes[1 + meta + 1], static_cast<uint8_t>(legacy_pmt::legacy_uniform_type::U8));
+        }
+    }
+
+    TEST(LegacyCorpusTest, NestingDepth) {
+        auto opts = only(corpus_kind::nested_dict, 5);
+        opts.nesting_depth = {6, 6};
+        for (const auto& msg : legacy_pmt::generate_legacy_corpus(opts)) {
+            auto obj = legacy_pmt::deserialize_from_legacy(msg.bytes.data(), msg.bytes.size());
+            int depth = 1;
+            auto map = pmtv::cast<pmtv::map_t>(obj);
+            while (map.contains("inner")) {
+                ++depth;
+                map = pmtv::cast<pmtv::map_t>(map.at("inner"));
+            }
+            EXPECT_EQ(depth, 6);
+            EXPECT_TRUE(map.contains("leaf"));
+        }
+    }
+
+    TEST(LegacyCorpusTest, InvalidOptions) {
+        corpus_options opts;
+        opts.weights = {};
+        EXPECT_THROW(legacy_pmt::generate_legacy_corpus(opts), std::invalid_argument);
+        opts = {};
+        opts.pdu_bytes = {10, 5};
+        EXPECT_THROW(legacy_pmt::generate_legacy_corpus(opts), std::invalid_argument);
+        opts = {};
+        opts.tag_entries = {1, legacy_pmt::corpus_max_tag_entries + 1};
+        EXPECT_THROW(legacy_pmt::generate_legacy_corpus(opts), std::invalid_argument);
+    }
+
+} // namespace
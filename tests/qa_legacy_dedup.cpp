@@ -0,0 +1,118 @@
+#include <gtest/gtest.h>
+#include <pmt_converter/pmt_legacy_codec.h>
+#include <pmt_converter/pmt_legacy_dedup.h>
+#include <pmt_converter/pmt_legacy_format.h>
+#include <string>
+#include <vector>
+
+namespace {
+
+    pmtv::pmt make_calibration() {
+        return pmtv::map_t({{"gain_db", 31.5},
+                            {"dc_offset", pmtv::Tensor<float>(64, 0.125f)},
+                            {"label", "factory_calibration"}});
+    }
+
+    // The same calibration dict attached to every channel
+    pmtv::pmt make_channels(size_t n) {
+        pmtv::map_t m;
+        for (size_t i = 0; i < n; ++i)
+            m.insert_or_assign("ch" + std::to_string(i), pmtv::map_t({{"index", static_cast<int32_t>(i)},
+                                                                      {"calibration", make_calibration()}}));
+        return m;
+    }
+
+    TEST(LegacyDedupTest, RepeatedSubtreesShrink) {
+        pmtv::pmt obj = make_channels(16);
+        auto plain = legacy_pmt::serialize_to_legacy(obj);
+        auto dedup = legacy_pmt::serialize_deduplicated(obj);
+
+        EXPECT_TRUE(legacy_pmt::is_deduplicated(dedup.data(), dedup.size()));
+        EXPECT_LT(dedup.size() * 4, plain.size());
+        EXPECT_TRUE(legacy_pmt::deserialize_deduplicated(dedup.data(), dedup.size()) == obj);
+    }
+
+    TEST(LegacyDedupTest, ExpandMatchesPlain) {
+        for (const pmtv::pmt& obj : {pmtv::pmt(42), pmtv::pmt("example"), make_calibration(), make_channels(5)}) {
+            auto dedup = legacy_pmt::serialize_deduplicated(obj, {.min_subtree_bytes = 8});
+            EXPECT_EQ(legacy_pmt::expand_deduplicated(dedup.data(), dedup.size()), legacy_pmt::serialize_to_legacy(obj));
+            EXPECT_TRUE(legacy_pmt::deserialize_deduplicated(dedup.data(), dedup.size()) == obj);
+        }
+    }
+
+    TEST(LegacyDedupTest, StrictIsPlainLegacy) {
+        pmtv::pmt obj = make_channels(4);
+        auto strict = legacy_pmt::serialize_deduplicated(obj, {.strict = true});
+        EXPECT_EQ(strict, legacy_pmt::serialize_to_legacy(obj));
+        EXPECT_FALSE(legacy_pmt::is_deduplicated(strict.data(), strict.size()));
+
+        // Plain legacy passes through both readers
+        EXPECT_EQ(legacy_pmt::expand_deduplicated(strict.data(), strict.size()), strict);
+        EXPECT_TRUE(legacy_pmt::deserialize_deduplicated(strict.data(), strict.size()) == obj);
+    }
+
+    TEST(LegacyDedupTest, SmallSubtreesStayInline) {
+        // Every repeat is shorter than the threshold, so nothing is referenced
+        pmtv::pmt obj = pmtv::map_t({{"a", 1.0}, {"b", 1.0}, {"c", 1.0}});
+        auto dedup = legacy_pmt::serialize_deduplicated(obj, {.min_subtree_bytes = 64});
+        auto plain = legacy_pmt::serialize_to_legacy(obj);
+        EXPECT_EQ(dedup.size(), legacy_pmt::dedup_header_size + plain.size());
+    }
+
+    TEST(LegacyDedupTest, RejectsBadReferences) {
+        auto dedup = legacy_pmt::serialize_deduplicated(make_channels(3));
+        auto plain_like = std::vector<uint8_t>(dedup.begin() + legacy_pmt::dedup_header_size, dedup.end());
+
+        // Extension tags are not legacy
+        EXPECT_THROW(legacy_pmt::deserialize_from_legacy(plain_like.data(), plain_like.size()), std::runtime_error);
+
+        // Reference to a node that is never defined
+        std::vector<uint8_t> dangling = {'L', 'P', 'R', 1, static_cast<uint8_t>(legacy_pmt::legacy_tag::LEGACY_PMT_REF),
+                                         0, 0, 0, 7};
+        EXPECT_THROW(legacy_pmt::deserialize_deduplicated(dangling.data(), dangling.size()), std::runtime_error);
+        EXPECT_THROW(legacy_pmt::expand_deduplicated(dangling.data(), dangling.size()), std::runtime_error);
+
+        // Reference to the definition it is part of
+        std::vector<uint8_t> cyclic = {'L', 'P', 'R', 1,
+                                       static_cast<uint8_t>(legacy_pmt::legacy_tag::LEGACY_PMT_DEF),
+                                       static_cast<uint8_t>(legacy_pmt::legacy_tag::LEGACY_PMT_DICT),
+                                       static_cast<uint8_t>(legacy_pmt::legacy_tag::LEGACY_PMT_PAIR),
+                                       static_cast<uint8_t>(legacy_pmt::legacy_tag::LEGACY_PMT_SYMBOL), 0, 1, 'k',
+                                       static_cast<uint8_t>(legacy_pmt::legacy_tag::LEGACY_PMT_REF), 0, 0, 0, 0,
+                                       static_cast<uint8_t>(legacy_pmt::legacy_tag::LEGACY_PMT_NULL)};
+        EXPECT_THROW(legacy_pmt::deserialize_deduplicated(cyclic.data(), cyclic.size()), std::runtime_error);
+        EXPECT_THROW(legacy_pmt::expand_deduplicated(cyclic.data(), cyclic.size()), std::runtime_error);
+
+        // Every level is a dict of two references to the level below, doubling
+        // the decoded size: 40 levels of a few bytes each would expand to terabytes
+        using legacy_pmt::legacy_tag;
+        auto tag = [](legacy_tag t) { return static_cast<uint8_t>(t); };
+        auto entry = [&](char key) -> std::vector<uint8_t> {
+            return {tag(legacy_tag::LEGACY_PMT_DICT), tag(legacy_tag::LEGACY_PMT_PAIR), tag(legacy_tag::LEGACY_PMT_SYMBOL),
+                    0, 1, static_cast<uint8_t>(key)};
+        };
+        std::vector<uint8_t> bomb = {'L', 'P', 'R', 1};
+        auto append = [&](const std::vector<uint8_t>& bytes) { bomb.insert(bomb.end(), bytes.begin(), bytes.end()); };
+        append(entry('k'));
+        append({tag(legacy_tag::LEGACY_PMT_DEF), tag(legacy_tag::LEGACY_PMT_INT32), 0, 0, 0, 42});
+        for (uint8_t level = 0; level < 40; ++level) {
+            append(entry('k'));
+            bomb.push_back(tag(legacy_tag::LEGACY_PMT_DEF));
+            for (char key : {'a', 'b'}) {
+                append(entry(key));
+                append({tag(legacy_tag::LEGACY_PMT_REF), 0, 0, 0, level});
+            }
+            bomb.push_back(tag(legacy_tag::LEGACY_PMT_NULL));
+        }
+        bomb.push_back(tag(legacy_tag::LEGACY_PMT_NULL));
+        EXPECT_THROW(legacy_pmt::deserialize_deduplicated(bomb.data(), bomb.size()), std::runtime_error);
+        EXPECT_THROW(legacy_pmt::expand_deduplicated(bomb.data(), bomb.size()), std::runtime_error);
+
+        // A legitimate message past a tighter bound
+        auto channels = legacy_pmt::serialize_deduplicated(make_channels(16));
+        EXPECT_THROW(legacy_pmt::deserialize_deduplicated(channels.data(), channels.size(), 2), std::runtime_error);
+        EXPECT_THROW(legacy_pmt::expand_deduplicated(channels.data(), channels.size(), 2), std::runtime_error);
+        EXPECT_NO_THROW(legacy_pmt::expand_deduplicated(channels.data(), channels.size(), 8));
+    }
+
+} // namespace
@@ -0,0 +1,109 @@
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <pmt_converter/pmt_legacy_codec.h>
+#include <pmt_converter/pmt_legacy_editor.h>
+#include <string>
+#include <vector>
+
+namespace {
+
+    pmtv::map_t make_tag_dict() {
+        return pmtv::map_t({{"rx_time", static_cast<int64_t>(249387429783478)},
+                            {"seq", static_cast<int32_t>(7)},
+                            {"rx_freq", 2.4e9},
+                            {"valid", true},
+                            {"label", "example"},
+                            {"meta", pmtv::map_t({{"gain", 12.5}, {"antenna", "RX2"}})},
+                            {"burst", pmtv::Tensor<float>(16, -987.654321f)}});
+    }
+
+    TEST(LegacyEditorTest, FindAndGet) {
+        auto bytes = legacy_pmt::serialize_to_legacy(make_tag_dict());
+        legacy_pmt::legacy_editor editor(bytes);
+
+        auto ref = editor.find({"seq"});
+        ASSERT_TRUE(ref);
+        EXPECT_EQ(ref->tag, legacy_pmt::legacy_tag::LEGACY_PMT_INT32);
+        EXPECT_EQ(ref->size, 5u);
+
+        EXPECT_TRUE(*editor.get({"rx_freq"}) == pmtv::pmt(2.4e9));
+        EXPECT_TRUE(*editor.get({"meta", "antenna"}) == pmtv::pmt("RX2"));
+        EXPECT_TRUE(*editor.get({}) == pmtv::pmt(make_tag_dict()));
+
+        EXPECT_FALSE(editor.find({"missing"}));
+        EXPECT_FALSE(editor.find({"meta", "missing"}));
+        // Only dicts can be descended into
+        EXPECT_FALSE(editor.find({"label", "x"}));
+    }
+
+    TEST(LegacyEditorTest, SameSizeScalarsInPlace) {
+        auto expected = make_tag_dict();
+        auto bytes = legacy_pmt::serialize_to_legacy(expected);
+        std::span<uint8_t> view(bytes);
+        legacy_pmt::legacy_editor editor(view);
+
+        EXPECT_TRUE(editor.set({"seq"}, int32_t{8}));
+        EXPECT_TRUE(editor.set({"rx_time"}, int64_t{249387429800000}));
+        EXPECT_TRUE(editor.set({"valid"}, false));
+        EXPECT_TRUE(editor.set({"meta", "gain"}, 20.0));
+        EXPECT_FALSE(editor.set({"missing"}, int32_t{1}));
+        EXPECT_EQ(editor.bytes().data(), bytes.data());
+
+        expected.insert_or_assign("seq", static_cast<int32_t>(8));
+        expected.insert_or_assign("rx_time", static_cast<int64_t>(249387429800000));
+        expected.insert_or_assign("valid", false);
+        expected.insert_or_assign("meta", pmtv::map_t({{"gain", 20.0}, {"antenna", "RX2"}}));
+        EXPECT_EQ(bytes, legacy_pmt::serialize_to_legacy(expected));
+    }
+
+    TEST(LegacyEditorTest, SizeChangingEditsSplice) {
+        auto expected = make_tag_dict();
+        auto bytes = legacy_pmt::serialize_to_legacy(expected);
+        legacy_pmt::legacy_editor editor(bytes);
+
+        // Grow: INT32 to INT64, and a longer symbol
+        EXPECT_TRUE(editor.set({"seq"}, int64_t{1} << 40));
+        EXPECT_TRUE(editor.set({"meta", "antenna"}, pmtv::pmt("TX/RX")));
+        // Shrink: uniform vector to a scalar
+        EXPECT_TRUE(editor.set({"burst"}, int32_t{0}));
+
+        expected.insert_or_assign("seq", int64_t{1} << 40);
+        expected.insert_or_assign("meta", pmtv::map_t({{"gain", 12.5}, {"antenna", "TX/RX"}}));
+        expected.insert_or_assign("burst", static_cast<int32_t>(0));
+        EXPECT_EQ(bytes, legacy_pmt::serialize_to_legacy(expected));
+        EXPECT_EQ(editor.bytes().size(), bytes.size());
+    }
+
+    TEST(LegacyEditorTest, FixedBufferRejectsResize) {
+        auto bytes = legacy_pmt::serialize_to_legacy(make_tag_dict());
+        auto original = bytes;
+        legacy_pmt::legacy_editor editor{std::span<uint8_t>(bytes)};
+        EXPECT_THROW(editor.set({"seq"}, int64_t{1}), std::length_error);
+        EXPECT_EQ(bytes, original);
+    }
+
+    TEST(LegacyEditorTest, MalformedInput) {
+        auto bytes = legacy_pmt::serialize_to_legacy(make_tag_dict());
+        bytes.resize(bytes.size() / 2);
+        legacy_pmt::legacy_editor editor(bytes);
+        EXPECT_THROW(editor.find({"zzz"}), std::runtime_error);
+
+        // Cut right after a matched key, before its value
+        bytes = legacy_pmt::serialize_to_legacy(make_tag_dict());
+        const std::vector<uint8_t> meta_key = {static_cast<uint8_t>(legacy_pmt::legacy_tag::LEGACY_PMT_SYMBOL), 0, 4,
+                                               'm', 'e', 't', 'a'};
+        auto at = std::search(bytes.begin(), bytes.end(), meta_key.begin(), meta_key.end());
+        ASSERT_NE(at, bytes.end());
+        bytes.erase(at + static_cast<std::ptrdiff_t>(meta_key.size()), bytes.end());
+        legacy_pmt::legacy_editor cut(bytes);
+        EXPECT_THROW(cut.find({"meta", "gain"}), std::runtime_error);
+        EXPECT_THROW(cut.find({"meta"}), std::runtime_error);
+
+        // A value nested past the depth limit is skipped, not recursed through
+        std::vector<uint8_t> deep = {0x09, 0x07, 0x02, 0x00, 0x01, 'x'};
+        deep.insert(deep.end(), 2 << 20, 0x07);
+        legacy_pmt::legacy_editor deep_editor(deep);
+        EXPECT_THROW(deep_editor.find({"zzz"}), std::runtime_error);
+    }
+
+} // namespace
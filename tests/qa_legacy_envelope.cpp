@@ -0,0 +1,131 @@
+#include <gtest/gtest.h>
+#include <pmt_converter/pmt_legacy_envelope.h>
+#include <pmt_converter/pmt_legacy_codec.h>
+#include <pmt_converter/pmt_legacy_format.h>
+#include <complex>
+#include <cstdint>
+#include <stdexcept>
+#include <vector>
+
+namespace {
+
+    pmtv::pmt make_c32_burst(size_t n) {
+        std::vector<std::complex<float>> samples(n);
+        for (size_t i = 0; i < n; ++i)
+            samples[i] = {static_cast<float>(i % 100) * 0.01f, -static_cast<float>(i % 50) * 0.02f};
+        return pmtv::Tensor<std::complex<float>>(samples);
+    }
+
+    std::vector<legacy_pmt::envelope_codec> available_codecs() {
+        std::vector<legacy_pmt::envelope_codec> codecs;
+        for (auto c : {legacy_pmt::envelope_codec::none, legacy_pmt::envelope_codec::zstd})
+            if (legacy_pmt::envelope_codec_available(c))
+                codecs.push_back(c);
+        return codecs;
+    }
+
+    TEST(LegacyEnvelopeTest, RoundTrip) {
+        pmtv::pmt burst = make_c32_burst(4096);
+        auto legacy = legacy_pmt::serialize_to_legacy(burst);
+
+        for (auto codec : available_codecs()) {
+            for (bool shuffle : {false, true}) {
+                auto env = legacy_pmt::serialize_to_envelope(burst, {.codec = codec, .shuffle = shuffle});
+                EXPECT_TRUE(legacy_pmt::is_envelope(env.data(), env.size()));
+                EXPECT_EQ(legacy_pmt::unwrap_envelope(env.data(), env.size()), legacy);
+                EXPECT_TRUE(legacy_pmt::deserialize_from_envelope(env.data(), env.size()) == burst);
+            }
+        }
+    }
+
+    // Shuffled payload is one plane per big-endian byte of the elements; 100
+    // elements cover a full transpose block and a tail
+    template <typename T>
+    void expect_byte_planes() {
+        constexpr size_t n = 100;
+        std::vector<T> values(n);
+        for (size_t i = 0; i < n; ++i)
+            values[i] = static_cast<T>(0x0102030405060708ULL * (i + 1));
+        pmtv::pmt vec = pmtv::Tensor<T>(values);
+        auto env = legacy_pmt::serialize_to_envelope(vec, {.codec = legacy_pmt::envelope_codec::none, .shuffle = true});
+        const uint8_t* planes = env.data() + legacy_pmt::envelope_header_size + legacy_pmt::uniform_vector_header_size;
+        ASSERT_EQ(env.size(), planes - env.data() + n * sizeof(T));
+        for (size_t b = 0; b < sizeof(T); ++b)
+            for (size_t i = 0; i < n; ++i)
+                ASSERT_EQ(planes[b * n + i], static_cast<uint8_t>(values[i] >> (8 * (sizeof(T) - 1 - b))));
+        EXPECT_TRUE(legacy_pmt::deserialize_from_envelope(env.data(), env.size()) == vec);
+    }
+
+    TEST(LegacyEnvelopeTest, ShuffleLayout) {
+        expect_byte_planes<uint16_t>();
+        expect_byte_planes<uint32_t>();
+        expect_byte_planes<uint64_t>();
+    }
+
+    TEST(LegacyEnvelopeTest, NonVectorMessage) {
+        pmtv::map_t meta({{"spam", static_cast<int>(42)}, {"eggs", "example"}});
+        for (auto codec : available_codecs()) {
+            auto env = legacy_pmt::serialize_to_envelope(meta, {.codec = codec});
+            EXPECT_TRUE(legacy_pmt::deserialize_from_envelope(env.data(), env.size()) == pmtv::pmt(meta));
+        }
+    }
+
+    TEST(LegacyEnvelopeTest, StreamingDecode) {
+        pmtv::pmt burst = make_c32_burst(10000);
+        for (auto codec : available_codecs()) {
+            // Two envelopes back to back, fed in small uneven pieces
+            auto env = legacy_pmt::serialize_to_envelope(burst, {.codec = codec});
+            auto stream = env;
+            stream.insert(stream.end(), env.begin(), env.end());
+
+            legacy_pmt::envelope_decoder dec;
+            int decoded = 0;
+            size_t pos = 0;
+            while (pos < stream.size()) {
+                size_t piece = std::min<size_t>(97, stream.size() - pos);
+                size_t used = dec.feed(stream.data() + pos, piece);
+                pos += used;
+                if (dec.complete()) {
+                    EXPECT_TRUE(dec.take() == burst);
+                    ++decoded;
+                }
+            }
+            EXPECT_EQ(decoded, 2);
+        }
+    }
+
+    TEST(LegacyEnvelopeTest, RejectsCorruptHeader) {
+        auto env = legacy_pmt::serialize_to_envelope(pmtv::pmt(42), {.codec = legacy_pmt::envelope_codec::none});
+        env[0] = 'X';
+        EXPECT_THROW(legacy_pmt::deserialize_from_envelope(env.data(), env.size()), std::runtime_error);
+    }
+
+    // The declared size is not trusted: an oversized claim fails on the header
+    // instead of allocating, and a zstd frame must agree with it
+    TEST(LegacyEnvelopeTest, RejectsBadDeclaredSize) {
+        pmtv::pmt burst = make_c32_burst(1000);
+        size_t legacy_size = legacy_pmt::legacy_serialized_size(burst);
+        for (auto codec : available_codecs()) {
+            auto env = legacy_pmt::serialize_to_envelope(burst, {.codec = codec});
+            auto huge = env;
+            huge[8] = 0x00;
+            huge[9] = 0x00;
+            huge[10] = 0x01; // 2^40
+            std::fill(huge.begin() + 11, huge.begin() + 16, 0x00);
+            legacy_pmt::envelope_decoder dec;
+            EXPECT_THROW(dec.feed(huge.data(), legacy_pmt::envelope_header_size), std::runtime_error);
+            EXPECT_THROW(legacy_pmt::unwrap_envelope(huge.data(), huge.size()), std::runtime_error);
+
+            EXPECT_THROW(legacy_pmt::unwrap_envelope(env.data(), env.size(), legacy_size - 1), std::runtime_error);
+            EXPECT_NO_THROW(legacy_pmt::unwrap_envelope(env.data(), env.size(), legacy_size));
+
+            // Declared size one byte off either way
+            for (int delta : {-1, 1}) {
+                auto off = env;
+                off[15] = static_cast<uint8_t>(off[15] + delta);
+                EXPECT_THROW(legacy_pmt::unwrap_envelope(off.data(), off.size()), std::runtime_error);
+            }
+        }
+    }
+
+}
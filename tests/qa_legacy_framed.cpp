@@ -0,0 +1,74 @@
+#include <gtest/gtest.h>
+#include <pmt_converter/pmt_legacy_codec.h>
+#include <pmt_converter/pmt_legacy_framed.h>
+#include <complex>
+#include <string>
+#include <vector>
+
+namespace {
+
+    pmtv::pmt make_tag_dict() {
+        return pmtv::map_t({{"rx_time", static_cast<int64_t>(249387429783478)},
+                            {"rx_freq", 2.4e9},
+                            {"label", "example"},
+                            {"burst", pmtv::Tensor<float>(16, -987.654321f)}});
+    }
+
+    TEST(LegacyFramedTest, Crc32c) {
+        const std::string check = "123456789";
+        EXPECT_EQ(legacy_pmt::crc32c(reinterpret_cast<const uint8_t*>(check.data()), check.size()), 0xe3069283u);
+
+        auto a = legacy_pmt::crc32c(reinterpret_cast<const uint8_t*>(check.data()), 4);
+        auto b = legacy_pmt::crc32c(reinterpret_cast<const uint8_t*>(check.data()) + 4, 5);
+        EXPECT_EQ(legacy_pmt::crc32c_combine(a, b, 5), 0xe3069283u);
+    }
+
+    TEST(LegacyFramedTest, RoundTrip) {
+        for (const pmtv::pmt& obj : {pmtv::pmt(42), pmtv::pmt("example"), make_tag_dict()}) {
+            auto frame = legacy_pmt::serialize_framed(obj);
+            EXPECT_EQ(frame.size(), legacy_pmt::framed_size(obj));
+
+            // The payload is the plain legacy encoding
+            auto legacy = legacy_pmt::serialize_to_legacy(obj);
+            EXPECT_TRUE(std::equal(legacy.begin(), legacy.end(), frame.begin() + legacy_pmt::frame_header_size));
+            EXPECT_TRUE(legacy_pmt::deserialize_framed(frame.data(), frame.size()) == obj);
+        }
+    }
+
+    TEST(LegacyFramedTest, ParallelChunksMatchSerial) {
+        std::vector<std::complex<float>> samples(50000);
+        for (size_t i = 0; i < samples.size(); ++i)
+            samples[i] = {static_cast<float>(i), 1.0f / static_cast<float>(i + 1)};
+        pmtv::pmt obj = pmtv::Tensor<std::complex<float>>(samples);
+
+        auto saved = legacy_pmt::get_parallel_options();
+        legacy_pmt::set_parallel_options({.threshold_bytes = 0, .chunk_bytes = 1000, .max_threads = 1});
+        auto serial = legacy_pmt::serialize_framed(obj);
+        legacy_pmt::set_parallel_options({.threshold_bytes = 0, .chunk_bytes = 1000, .max_threads = 0});
+        auto parallel = legacy_pmt::serialize_framed(obj);
+        EXPECT_EQ(parallel, serial);
+        EXPECT_TRUE(legacy_pmt::deserialize_framed(parallel.data(), parallel.size()) == obj);
+
+        parallel[parallel.size() / 2] ^= 0x10;
+        EXPECT_THROW(legacy_pmt::deserialize_framed(parallel.data(), parallel.size()), legacy_pmt::legacy_integrity_error);
+        legacy_pmt::set_parallel_options(saved);
+    }
+
+    TEST(LegacyFramedTest, DetectsCorruption) {
+        auto frame = legacy_pmt::serialize_framed(make_tag_dict());
+
+        // Payload bit flip inside a value
+        auto flipped = frame;
+        flipped[flipped.size() - 10] ^= 0x01;
+        EXPECT_THROW(legacy_pmt::deserialize_framed(flipped.data(), flipped.size()), legacy_pmt::legacy_integrity_error);
+
+        // Corrupted tag byte is reported as corruption, not as an unknown tag
+        auto bad_tag = frame;
+        bad_tag[legacy_pmt::frame_header_size] = 0x7f;
+        EXPECT_THROW(legacy_pmt::deserialize_framed(bad_tag.data(), bad_tag.size()), legacy_pmt::legacy_integrity_error);
+
+        // Truncation
+        EXPECT_THROW(legacy_pmt::deserialize_framed(frame.data(), frame.size() - 1), legacy_pmt::legacy_integrity_error);
+    }
+
+}
@@ -0,0 +1,177 @@
+#include <gtest/gtest.h>
+#include <pmt_converter/pmt_legacy_codec.h>
+#include <pmt_converter/pmt_legacy_corpus.h>
+#include <pmt_converter/pmt_legacy_pdu.h>
+#include <complex>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace {
+
+    pmtv::map_t make_meta() {
+        return pmtv::map_t({{"packet_len", static_cast<int32_t>(1500)},
+                            {"rx_time", static_cast<int64_t>(249387429783478)},
+                            {"snr", 17.5},
+                            {"label", "header_ok"}});
+    }
+
+    std::vector<uint8_t> make_bytes(size_t n) {
+        std::vector<uint8_t> v(n);
+        for (size_t i = 0; i < n; ++i)
+            v[i] = static_cast<uint8_t>(i * 31);
+        return v;
+    }
+
+    // The PDU is the pair tag followed by what the generic codec writes for each half
+    std::vector<uint8_t> expected_bytes(const pmtv::map_t& meta, const pmtv::pmt& data) {
+        std::vector<uint8_t> out{static_cast<uint8_t>(legacy_pmt::legacy_tag::LEGACY_PMT_PAIR)};
+        auto car = meta.empty() ? std::vector<uint8_t>{static_cast<uint8_t>(legacy_pmt::legacy_tag::LEGACY_PMT_NULL)}
+                                : legacy_pmt::serialize_to_legacy(meta);
+        auto cdr = legacy_pmt::serialize_to_legacy(data);
+        out.insert(out.end(), car.begin(), car.end());
+        out.insert(out.end(), cdr.begin(), cdr.end());
+        return out;
+    }
+
+    TEST(LegacyPduTest, BytePdu) {
+        auto meta = make_meta();
+        pmtv::Tensor<uint8_t> data(make_bytes(1500));
+        auto bytes = legacy_pmt::serialize_pdu(meta, data);
+        EXPECT_EQ(bytes, expected_bytes(meta, data));
+        EXPECT_EQ(bytes.size(), legacy_pmt::legacy_pdu_size(meta, data));
+        EXPECT_EQ(legacy_pmt::legacy_encoded_size(bytes.data(), bytes.size()), bytes.size());
+        EXPECT_TRUE(legacy_pmt::is_legacy_pdu(bytes.data(), bytes.size()));
+
+        auto [meta2, data2] = legacy_pmt::deserialize_pdu<uint8_t>(bytes.data(), bytes.size());
+        EXPECT_TRUE(meta2 == meta);
+        EXPECT_TRUE(data2 == data);
+
+        std::vector<uint8_t> buf(bytes.size());
+        EXPECT_EQ(legacy_pmt::serialize_pdu(meta, data, buf.data(), buf.size()), bytes.size());
+        EXPECT_EQ(buf, bytes);
+        EXPECT_THROW(legacy_pmt::serialize_pdu(meta, data, buf.data(), buf.size() - 1), std::length_error);
+    }
+
+    TEST(LegacyPduTest, SamplePdu) {
+        auto meta = make_meta();
+        std::vector<std::complex<float>> samples(2048);
+        for (size_t i = 0; i < samples.size(); ++i)
+            samples[i] = {static_cast<float>(i) / 64.0f, -static_cast<float>(i) / 32.0f};
+        pmtv::Tensor<std::complex<float>> data(samples);
+        auto bytes = legacy_pmt::serialize_pdu(meta, data);
+        EXPECT_EQ(bytes, expected_bytes(meta, data));
+
+        auto [meta2, data2] = legacy_pmt::deserialize_pdu<std::complex<float>>(bytes.data(), bytes.size());
+        EXPECT_TRUE(meta2 == meta);
+        EXPECT_TRUE(data2 == data);
+
+        // Untyped decode and re-encode through a pmt payload
+        auto [meta3, payload] = legacy_pmt::deserialize_pdu(bytes.data(), bytes.size());
+        EXPECT_TRUE(payload == pmtv::pmt(data));
+        EXPECT_EQ(legacy_pmt::serialize_pdu(meta3, payload), bytes);
+        EXPECT_THROW(legacy_pmt::serialize_pdu(meta3, pmtv::pmt(1.0)), std::runtime_error);
+    }
+
+    TEST(LegacyPduTest, EmptyMetadataIsNull) {
+        pmtv::Tensor<uint8_t> data(make_bytes(64));
+        auto bytes = legacy_pmt::serialize_pdu(pmtv::map_t{}, data);
+        EXPECT_EQ(bytes[1], static_cast<uint8_t>(legacy_pmt::legacy_tag::LEGACY_PMT_NULL));
+        EXPECT_EQ(bytes, expected_bytes({}, data));
+        EXPECT_TRUE(legacy_pmt::is_legacy_pdu(bytes.data(), bytes.size()));
+
+        auto [meta, data2] = legacy_pmt::deserialize_pdu<uint8_t>(bytes.data(), bytes.size());
+        EXPECT_TRUE(meta.empty());
+        EXPECT_TRUE(data2 == data);
+    }
+
+    TEST(LegacyPduTest, TensorShape) {
+        pmtv::Tensor<float> data(std::vector<float>(4 * 8, 0.25f));
+        data.reshape(std::vector<size_t>{4, 8});
+        auto bytes = legacy_pmt::serialize_pdu(make_meta(), data);
+        EXPECT_EQ(bytes, expected_bytes(make_meta(), data));
+        auto [meta, data2] = legacy_pmt::deserialize_pdu<float>(bytes.data(), bytes.size());
+        EXPECT_TRUE(data2 == data);
+        EXPECT_EQ(data2.extents().size(), 2u);
+    }
+
+    TEST(LegacyPduTest, Rejects) {
+        auto meta = make_meta();
+        auto bytes = legacy_pmt::serialize_pdu(meta, pmtv::Tensor<uint8_t>(make_bytes(100)));
+        EXPECT_THROW(legacy_pmt::deserialize_pdu<std::complex<float>>(bytes.data(), bytes.size()), std::runtime_error);
+        EXPECT_THROW(legacy_pmt::deserialize_pdu<uint8_t>(bytes.data(), bytes.size() - 1), std::runtime_error);
+        // Cut inside the metadata, and right after it
+        EXPECT_FALSE(legacy_pmt::is_legacy_pdu(bytes.data(), bytes.size() - 109));
+        EXPECT_FALSE(legacy_pmt::is_legacy_pdu(bytes.data(), bytes.size() - 108));
+
+        auto dict = legacy_pmt::serialize_to_legacy(meta);
+        EXPECT_FALSE(legacy_pmt::is_legacy_pdu(dict.data(), dict.size()));
+        EXPECT_THROW(legacy_pmt::deserialize_pdu(dict.data(), dict.size()), std::runtime_error);
+
+        // A pair of two dicts is not a PDU
+        std::vector<uint8_t> pair{static_cast<uint8_t>(legacy_pmt::legacy_tag::LEGACY_PMT_PAIR)};
+        pair.insert(pair.end(), dict.begin(), dict.end());
+        pair.insert(pair.end(), dict.begin(), dict.end());
+        EXPECT_FALSE(legacy_pmt::is_legacy_pdu(pair.data(), pair.size()));
+        EXPECT_THROW(legacy_pmt::deserialize_pdu(pair.data(), pair.size()), std::runtime_error);
+
+        // Metadata nested past the depth limit
+        std::vector<uint8_t> deep{static_cast<uint8_t>(legacy_pmt::legacy_tag::LEGACY_PMT_PAIR)};
+        for (int i = 0; i < 200000; ++i)
+            deep.insert(deep.end(), {0x09, 0x07, 0x02, 0x00, 0x01, 'a'});
+        EXPECT_FALSE(legacy_pmt::is_legacy_pdu(deep.data(), deep.size()));
+        EXPECT_THROW(legacy_pmt::deserialize_pdu(deep.data(), deep.size()), std::runtime_error);
+
+        // Too many elements for the u32 length; rejected while sizing, before
+        // the payload is read
+        legacy_pmt::detail::pdu_payload huge{nullptr, legacy_pmt::legacy_uniform_type::U8, size_t{1} << 32, {}};
+        EXPECT_THROW(legacy_pmt::detail::pdu_size(meta, huge), std::runtime_error);
+        std::vector<uint8_t> out(64);
+        EXPECT_THROW(legacy_pmt::detail::serialize_pdu(meta, huge, out.data(), out.size()), std::runtime_error);
+
+        // Extents that each fit a u32 but whose product wraps around to the count
+        std::vector<size_t> wrapping{65536, 65536, 65536, 65536};
+        legacy_pmt::detail::pdu_payload wrapped{nullptr, legacy_pmt::legacy_uniform_type::U8, 0, wrapping};
+        EXPECT_THROW(legacy_pmt::detail::pdu_size(meta, wrapped), std::runtime_error);
+    }
+
+    TEST(LegacyPduTest, EncoderCachesKeys) {
+        legacy_pmt::pdu_encoder encoder;
+        auto meta = make_meta();
+        pmtv::Tensor<uint8_t> data(make_bytes(1500));
+        for (int32_t len = 1; len <= 3; ++len) {
+            meta.insert_or_assign("packet_len", len);
+            auto bytes = encoder.encode(meta, data);
+            EXPECT_EQ(std::vector<uint8_t>(bytes.begin(), bytes.end()), legacy_pmt::serialize_pdu(meta, data));
+        }
+        EXPECT_EQ(encoder.key_cache_misses(), 1u);
+
+        // Same key count, different key
+        meta.erase("snr");
+        meta.insert_or_assign("snb", 1.0);
+        auto bytes = encoder.encode(meta, data);
+        EXPECT_EQ(std::vector<uint8_t>(bytes.begin(), bytes.end()), legacy_pmt::serialize_pdu(meta, data));
+        EXPECT_EQ(encoder.key_cache_misses(), 2u);
+
+        bytes = encoder.encode(pmtv::map_t{}, pmtv::Tensor<uint8_t>(make_bytes(10)));
+        EXPECT_EQ(std::vector<uint8_t>(bytes.begin(), bytes.end()),
+                  legacy_pmt::serialize_pdu(pmtv::map_t{}, pmtv::Tensor<uint8_t>(make_bytes(10))));
+        EXPECT_EQ(encoder.key_cache_misses(), 3u);
+    }
+
+    TEST(LegacyPduTest, CorpusPdus) {
+        legacy_pmt::corpus_options opts;
+        opts.messages = 200;
+        opts.weights = {0, 1, 1, 0, 0};
+        legacy_pmt::pdu_encoder encoder;
+        for (const auto& msg : legacy_pmt::generate_legacy_corpus(opts)) {
+            ASSERT_TRUE(legacy_pmt::is_legacy_pdu(msg.bytes.data(), msg.bytes.size()));
+            auto [meta, payload] = legacy_pmt::deserialize_pdu(msg.bytes.data(), msg.bytes.size());
+            EXPECT_EQ(legacy_pmt::serialize_pdu(meta, payload), msg.bytes);
+            auto bytes = encoder.encode(meta, payload);
+            EXPECT_EQ(std::vector<uint8_t>(bytes.begin(), bytes.end()), msg.bytes);
+        }
+    }
+
+} // namespace
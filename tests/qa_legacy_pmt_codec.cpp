@@ -1,5 +1,7 @@
 #include <gtest/gtest.h>
 #include <pmt_converter/pmt_legacy_codec.h>
+#include <pmt_converter/pmt_legacy_dedup.h>
+#include <pmt_converter/pmt_legacy_format.h>
 #include <vector>
 
 namespace {
@@ -143,5 +145,122 @@ namespace {
         EXPECT_EQ(pmtv::cast<std::vector<std::complex<float>>>(obj), expected_c32_vector);        
     }
 
-}
+    TEST(PmtLegacyCodecTest, DeserializeDict) {
+        pmtv::pmt obj = legacy_pmt::deserialize_from_legacy(legacy_dict_data.data(), legacy_dict_data.size());
+        auto m = pmtv::cast<pmtv::map_t>(obj);
+        EXPECT_EQ(m.size(), 2);
+        EXPECT_EQ(pmtv::cast<int32_t>(m["spam"]), 42);
+        EXPECT_EQ(pmtv::cast<int32_t>(m["eggs"]), 43);
+    }
+
+    TEST(PmtLegacyCodecTest, DeserializeTruncated) {
+        EXPECT_THROW(legacy_pmt::deserialize_from_legacy(legacy_int64_data.data(), legacy_int64_data.size() - 1), std::runtime_error);
+        EXPECT_THROW(legacy_pmt::deserialize_from_legacy(legacy_dict_data.data(), legacy_dict_data.size() - 1), std::runtime_error);
+        EXPECT_THROW(legacy_pmt::deserialize_from_legacy(legacy_c32vector_data.data(), legacy_c32vector_data.size() - 4), std::runtime_error);
+    }
+
+    // Dicts nested `levels` deep under the key "a", well formed
+    std::vector<uint8_t> nested_dicts(size_t levels) {
+        const uint8_t link[] = {0x09, 0x07, 0x02, 0x00, 0x01, 'a'};
+        std::vector<uint8_t> out;
+        out.reserve(levels * (sizeof(link) + 1) + 1);
+        for (size_t i = 0; i < levels; ++i)
+            out.insert(out.end(), link, link + sizeof(link));
+        out.insert(out.end(), levels + 1, 0x06);
+        return out;
+    }
+
+    TEST(PmtLegacyCodecTest, DeserializeDeepNesting) {
+        auto ok = nested_dicts(legacy_pmt::legacy_max_depth);
+        EXPECT_NO_THROW(legacy_pmt::deserialize_from_legacy(ok.data(), ok.size()));
+
+        // Recursing once per level would overflow the stack long before the end
+        auto deep = nested_dicts(500000);
+        EXPECT_THROW(legacy_pmt::deserialize_from_legacy(deep.data(), deep.size()), std::runtime_error);
+        deep.insert(deep.begin(), {'L', 'P', 'R', 1});
+        EXPECT_THROW(legacy_pmt::deserialize_deduplicated(deep.data(), deep.size()), std::runtime_error);
+    }
+
+    TEST(PmtLegacyCodecTest, ParallelUniformVector) {
+        std::vector<std::complex<float>> samples(100003);
+        for (size_t i = 0; i < samples.size(); ++i)
+            samples[i] = {static_cast<float>(i), -static_cast<float>(i) * 0.5f};
+        pmtv::pmt obj = pmtv::Tensor<std::complex<float>>(samples);
+
+        auto saved = legacy_pmt::get_parallel_options();
+        legacy_pmt::set_parallel_options({.threshold_bytes = 0, .chunk_bytes = 4096, .max_threads = 1});
+        auto serial = legacy_pmt::serialize_to_legacy(obj);
+
+        legacy_pmt::set_parallel_options({.threshold_bytes = 0, .chunk_bytes = 4096, .max_threads = 0});
+        auto parallel = legacy_pmt::serialize_to_legacy(obj);
+        EXPECT_EQ(parallel, serial);
+
+        pmtv::pmt decoded = legacy_pmt::deserialize_from_legacy(parallel.data(), parallel.size());
+        EXPECT_EQ(pmtv::cast<std::vector<std::complex<float>>>(decoded), samples);
+        legacy_pmt::set_parallel_options(saved);
+    }
 
+    TEST(PmtLegacyCodecTest, EncodedSize) {
+        // A capture of back-to-back messages splits at the encoded sizes
+        std::vector<uint8_t> capture;
+        std::vector<size_t> sizes;
+        for (const auto* msg : {&legacy_int64_data, &legacy_dict_data, &legacy_c32vector_data, &legacy_int64_data}) {
+            capture.insert(capture.end(), msg->begin(), msg->end());
+            sizes.push_back(msg->size());
+        }
+
+        size_t offset = 0;
+        for (size_t expected : sizes) {
+            size_t n = legacy_pmt::legacy_encoded_size(capture.data() + offset, capture.size() - offset);
+            EXPECT_EQ(n, expected);
+            offset += n;
+        }
+        EXPECT_EQ(offset, capture.size());
+
+        EXPECT_THROW(legacy_pmt::legacy_encoded_size(legacy_dict_data.data(), legacy_dict_data.size() - 1), std::runtime_error);
+        EXPECT_THROW(legacy_pmt::legacy_encoded_size(legacy_c32vector_data.data(), legacy_c32vector_data.size() - 4), std::runtime_error);
+    }
+
+    TEST(PmtLegacyCodecTest, EncodedSizeDeepNesting) {
+        // A corrupt capture of nothing but PAIR tags nests one level per byte
+        std::vector<uint8_t> pairs(2 << 20, 0x07);
+        EXPECT_THROW(legacy_pmt::legacy_encoded_size(pairs.data(), pairs.size()), std::runtime_error);
+        auto dicts = nested_dicts(500000);
+        EXPECT_THROW(legacy_pmt::legacy_encoded_size(dicts.data(), dicts.size()), std::runtime_error);
+
+        // A long GR3 list is a chain of pairs in the cdr, which does not nest
+        std::vector<uint8_t> list;
+        for (int i = 0; i < 500000; ++i)
+            list.insert(list.end(), {0x07, 0x03, 0x00, 0x00, 0x00, 0x2a});
+        list.push_back(0x06);
+        EXPECT_EQ(legacy_pmt::legacy_encoded_size(list.data(), list.size()), list.size());
+    }
+
+    template <typename T>
+    void check_uniform_lengths() {
+        // Every length up to a few SIMD blocks, so each kernel tail path runs
+        for (size_t n = 0; n < 300; n += (n < 70 ? 1 : 37)) {
+            std::vector<T> v(n);
+            for (size_t i = 0; i < n; ++i)
+                v[i] = static_cast<T>(static_cast<int64_t>(i * 2654435761u) % 30011 - 15000);
+
+            auto bytes = legacy_pmt::serialize_to_legacy(pmtv::Tensor<T>(v));
+            const uint8_t* payload = bytes.data() + legacy_pmt::uniform_vector_header_size;
+            for (size_t i = 0; i < n; ++i) {
+                const uint8_t* p = payload + i * sizeof(T);
+                EXPECT_EQ(legacy_pmt::deserialize_from_big_endian<T>(p), v[i]);
+            }
+            pmtv::pmt decoded = legacy_pmt::deserialize_from_legacy(bytes.data(), bytes.size());
+            EXPECT_EQ(pmtv::cast<std::vector<T>>(decoded), v);
+        }
+    }
+
+    TEST(PmtLegacyCodecTest, UniformVectorLengths) {
+        check_uniform_lengths<int16_t>();
+        check_uniform_lengths<uint32_t>();
+        check_uniform_lengths<int64_t>();
+        check_uniform_lengths<float>();
+        check_uniform_lengths<double>();
+    }
+
+}
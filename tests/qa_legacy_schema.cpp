@@ -0,0 +1,92 @@
+#include <gtest/gtest.h>
+#include <pmt_converter/pmt_legacy_schema.h>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace {
+
+    struct spam_eggs {
+        int32_t spam;
+        int32_t eggs;
+    };
+
+    using spam_eggs_schema = legacy_pmt::legacy_schema<spam_eggs,
+                                                       legacy_pmt::field<"spam", &spam_eggs::spam>,
+                                                       legacy_pmt::field<"eggs", &spam_eggs::eggs>>;
+
+    struct rx_tag {
+        int64_t rx_time;
+        double freq;
+        float gain;
+        bool burst;
+        std::string label;
+    };
+
+    using rx_tag_schema = legacy_pmt::legacy_schema<rx_tag,
+                                                    legacy_pmt::field<"rx_time", &rx_tag::rx_time>,
+                                                    legacy_pmt::field<"rx_freq", &rx_tag::freq>,
+                                                    legacy_pmt::field<"gain", &rx_tag::gain>,
+                                                    legacy_pmt::field<"burst", &rx_tag::burst>,
+                                                    legacy_pmt::field<"label", &rx_tag::label>>;
+
+    // Same dict as legacy_dict_data in qa_legacy_pmt_codec
+    const std::vector<uint8_t> legacy_dict_data = {0x09,0x07,0x02,0x00,0x04,0x65,0x67,0x67,0x73,0x03,0x00,0x00,0x00,0x2b,0x09,0x07,0x02,0x00,0x04,0x73,0x70,0x61,0x6d,0x03,0x00,0x00,0x00,0x2a,0x06};
+
+    TEST(LegacySchemaTest, SerializeMatchesLegacy) {
+        spam_eggs s{42, 43};
+        EXPECT_EQ(spam_eggs_schema::serialize(s), legacy_dict_data);
+    }
+
+    TEST(LegacySchemaTest, DeserializeFastPath) {
+        spam_eggs s{};
+        ASSERT_TRUE(spam_eggs_schema::try_deserialize(legacy_dict_data.data(), legacy_dict_data.size(), s));
+        EXPECT_EQ(s.spam, 42);
+        EXPECT_EQ(s.eggs, 43);
+    }
+
+    TEST(LegacySchemaTest, MatchesGenericPath) {
+        rx_tag t{249387429783478, 2.4e9, 10.5f, true, "burst0"};
+        auto bytes = rx_tag_schema::serialize(t);
+        EXPECT_EQ(bytes, legacy_pmt::serialize_to_legacy(rx_tag_schema::to_map(t)));
+
+        auto back = rx_tag_schema::deserialize(bytes.data(), bytes.size());
+        EXPECT_EQ(back.rx_time, t.rx_time);
+        EXPECT_EQ(back.freq, t.freq);
+        EXPECT_EQ(back.gain, t.gain);
+        EXPECT_EQ(back.burst, t.burst);
+        EXPECT_EQ(back.label, t.label);
+    }
+
+    TEST(LegacySchemaTest, FallbackOnMismatch) {
+        // An extra key defeats the template but the generic path still finds the fields
+        rx_tag t{1234, 1e6, 0.5f, false, "x"};
+        pmtv::map_t m = rx_tag_schema::to_map(t);
+        m["zzz_extra"] = static_cast<int32_t>(7);
+        m["rx_time"] = static_cast<int32_t>(1234); // GR3 writes small longs as INT32
+        auto bytes = legacy_pmt::serialize_to_legacy(m);
+
+        rx_tag fast{};
+        EXPECT_FALSE(rx_tag_schema::try_deserialize(bytes.data(), bytes.size(), fast));
+        auto back = rx_tag_schema::deserialize(bytes.data(), bytes.size());
+        EXPECT_EQ(back.rx_time, 1234);
+        EXPECT_EQ(back.label, "x");
+
+        m.erase("label");
+        bytes = legacy_pmt::serialize_to_legacy(m);
+        EXPECT_THROW(rx_tag_schema::deserialize(bytes.data(), bytes.size()), std::runtime_error);
+    }
+
+    TEST(LegacySchemaTest, RejectsLongSymbol) {
+        rx_tag t{1, 1.0, 1.0f, true, std::string(0x10000, 'x')};
+        EXPECT_THROW(rx_tag_schema::size(t), std::runtime_error);
+        EXPECT_THROW(rx_tag_schema::serialize(t), std::runtime_error);
+        std::vector<uint8_t> buf(0x20000);
+        EXPECT_THROW(rx_tag_schema::serialize(t, buf.data(), buf.size()), std::runtime_error);
+
+        t.label.resize(0xFFFF);
+        auto bytes = rx_tag_schema::serialize(t);
+        EXPECT_EQ(rx_tag_schema::deserialize(bytes.data(), bytes.size()).label, t.label);
+    }
+
+}
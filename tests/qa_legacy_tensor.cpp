@@ -0,0 +1,134 @@
+#include <gtest/gtest.h>
+#include <pmt_converter/pmt_legacy_codec.h>
+#include <pmt_converter/pmt_legacy_format.h>
+#include <pmt_converter/pmt_legacy_tensor.h>
+#include <pmt_converter/pmt_legacy_text.h>
+#include <complex>
+#include <numeric>
+#include <string>
+#include <vector>
+
+namespace {
+
+    template <typename T>
+    pmtv::Tensor<T> make_tensor(std::vector<size_t> extents) {
+        size_t n = std::accumulate(extents.begin(), extents.end(), size_t{1}, std::multiplies<>());
+        std::vector<T> v(n);
+        for (size_t i = 0; i < n; ++i)
+            v[i] = static_cast<T>(static_cast<float>(i) * 1.5f);
+        pmtv::Tensor<T> t(std::move(v));
+        t.reshape(extents);
+        return t;
+    }
+
+    TEST(LegacyTensorTest, ShapeRoundTrip) {
+        auto t = make_tensor<float>({4, 3});
+        auto bytes = legacy_pmt::serialize_to_legacy(t);
+        EXPECT_EQ(bytes.size(), legacy_pmt::legacy_serialized_size(t));
+        EXPECT_EQ(bytes[6], legacy_pmt::uniform_shape_pad_size(2));
+
+        pmtv::pmt decoded = legacy_pmt::deserialize_from_legacy(bytes.data(), bytes.size());
+        auto& out = std::get<pmtv::Tensor<float>>(decoded);
+        EXPECT_EQ(out.extents(), (std::vector<size_t>{4, 3}));
+        EXPECT_TRUE(decoded == pmtv::pmt(t));
+
+        auto c = make_tensor<std::complex<double>>({2, 2, 5});
+        auto cbytes = legacy_pmt::serialize_to_legacy(c);
+        EXPECT_TRUE(legacy_pmt::deserialize_from_legacy(cbytes.data(), cbytes.size()) == pmtv::pmt(c));
+    }
+
+    TEST(LegacyTensorTest, FlatForGr3) {
+        // Rank 1 keeps the classic single zero pad byte
+        auto flat = make_tensor<int16_t>({12});
+        auto flat_bytes = legacy_pmt::serialize_to_legacy(flat);
+        EXPECT_EQ(flat_bytes.size(), legacy_pmt::uniform_vector_header_size + 12 * sizeof(int16_t));
+        EXPECT_EQ(flat_bytes[6], 1);
+        EXPECT_EQ(flat_bytes[7], 0);
+
+        // A reader that skips the padding sees the same flat vector
+        auto shaped_bytes = legacy_pmt::serialize_to_legacy(make_tensor<int16_t>({3, 4}));
+        EXPECT_EQ(legacy_pmt::legacy_encoded_size(shaped_bytes.data(), shaped_bytes.size()), shaped_bytes.size());
+        std::string shaped_text, flat_text;
+        EXPECT_TRUE(legacy_pmt::format_legacy_to(shaped_text, shaped_bytes.data(), shaped_bytes.size()));
+        EXPECT_TRUE(legacy_pmt::format_legacy_to(flat_text, flat_bytes.data(), flat_bytes.size()));
+        EXPECT_EQ(shaped_text, flat_text);
+    }
+
+    TEST(LegacyTensorTest, MalformedShape) {
+        auto bytes = legacy_pmt::serialize_to_legacy(make_tensor<float>({4, 3}));
+        bytes[8 + 4 + 3] = 5; // second extent: 4 x 5 != 12
+        EXPECT_THROW(legacy_pmt::deserialize_from_legacy(bytes.data(), bytes.size()), std::runtime_error);
+    }
+
+    TEST(LegacyTensorTest, ContiguousViewMatchesTensor) {
+        auto t = make_tensor<float>({4, 3});
+        std::vector<size_t> extents{4, 3};
+        std::vector<ptrdiff_t> strides{3, 1};
+        legacy_pmt::tensor_view<float> view{t.data(), extents, strides};
+        EXPECT_EQ(legacy_pmt::legacy_tensor_size(view), legacy_pmt::legacy_serialized_size(t));
+        EXPECT_EQ(legacy_pmt::serialize_tensor_to_legacy(view), legacy_pmt::serialize_to_legacy(t));
+    }
+
+    TEST(LegacyTensorTest, StridedViews) {
+        // 4 channels interleaved over 6 samples: samples[s * 4 + ch]
+        std::vector<std::complex<float>> samples(24);
+        for (size_t i = 0; i < samples.size(); ++i)
+            samples[i] = {static_cast<float>(i), -static_cast<float>(i)};
+
+        // Channel-major (transposed) view: [ch][s]
+        std::vector<size_t> extents{4, 6};
+        std::vector<ptrdiff_t> strides{1, 4};
+        std::vector<std::complex<float>> transposed;
+        for (size_t ch = 0; ch < 4; ++ch)
+            for (size_t s = 0; s < 6; ++s)
+                transposed.push_back(samples[s * 4 + ch]);
+        pmtv::Tensor<std::complex<float>> expected(transposed);
+        expected.reshape(extents);
+        EXPECT_EQ(legacy_pmt::serialize_tensor_to_legacy(
+                      legacy_pmt::tensor_view<std::complex<float>>{samples.data(), extents, strides}),
+                  legacy_pmt::serialize_to_legacy(expected));
+
+        // One channel, samples reversed
+        std::vector<size_t> one{6};
+        std::vector<ptrdiff_t> reversed{-4};
+        std::vector<std::complex<float>> channel;
+        for (size_t s = 6; s-- > 0;)
+            channel.push_back(samples[s * 4 + 2]);
+        EXPECT_EQ(legacy_pmt::serialize_tensor_to_legacy(
+                      legacy_pmt::tensor_view<std::complex<float>>{samples.data() + 5 * 4 + 2, one, reversed}),
+                  legacy_pmt::serialize_to_legacy(pmtv::Tensor<std::complex<float>>(channel)));
+
+        // Sub-block with contiguous rows: samples 1..4 of channels 0..1
+        std::vector<size_t> block{4, 2};
+        std::vector<ptrdiff_t> block_strides{4, 1};
+        std::vector<std::complex<float>> sub;
+        for (size_t s = 1; s < 5; ++s)
+            for (size_t ch = 0; ch < 2; ++ch)
+                sub.push_back(samples[s * 4 + ch]);
+        pmtv::Tensor<std::complex<float>> sub_tensor(sub);
+        sub_tensor.reshape(block);
+        auto bytes = legacy_pmt::serialize_tensor_to_legacy(
+            legacy_pmt::tensor_view<std::complex<float>>{samples.data() + 4, block, block_strides});
+        EXPECT_EQ(bytes, legacy_pmt::serialize_to_legacy(sub_tensor));
+        EXPECT_TRUE(legacy_pmt::deserialize_from_legacy(bytes.data(), bytes.size()) == pmtv::pmt(sub_tensor));
+    }
+
+    TEST(LegacyTensorTest, ViewErrors) {
+        std::vector<float> data(6);
+        std::vector<size_t> extents{2, 3};
+        std::vector<ptrdiff_t> strides{3};
+        EXPECT_THROW(legacy_pmt::serialize_tensor_to_legacy(legacy_pmt::tensor_view<float>{data.data(), extents, strides}),
+                     std::runtime_error);
+
+        std::vector<ptrdiff_t> good{3, 1};
+        legacy_pmt::tensor_view<float> view{data.data(), extents, good};
+        std::vector<uint8_t> small(legacy_pmt::legacy_tensor_size(view) - 1);
+        EXPECT_THROW(legacy_pmt::serialize_tensor_to_legacy(view, small.data(), small.size()), std::length_error);
+
+        // Empty tensors are just a header
+        std::vector<size_t> empty{0, 3};
+        auto bytes = legacy_pmt::serialize_tensor_to_legacy(legacy_pmt::tensor_view<float>{data.data(), empty, good});
+        EXPECT_EQ(bytes.size(), legacy_pmt::uniform_vector_header_size_for(2));
+    }
+
+} // namespace
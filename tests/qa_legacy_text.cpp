@@ -0,0 +1,94 @@
+#include <gtest/gtest.h>
+#include <pmt_converter/legacy/pmt_legacy_serialize.h>
+#include <pmt_converter/pmt_legacy_codec.h>
+#include <pmt_converter/pmt_legacy_text.h>
+#include <complex>
+#include <string>
+#include <vector>
+
+using legacy::pmt_t;
+
+namespace {
+
+    std::string dump(const std::vector<uint8_t>& bytes, const legacy_pmt::format_options& opts = {}) {
+        std::string out;
+        EXPECT_TRUE(legacy_pmt::format_legacy_to(out, bytes.data(), bytes.size(), opts));
+        return out;
+    }
+
+    TEST(LegacyTextTest, LegacyTree) {
+        legacy::pmt_dict d;
+        d[pmt_t::make_symbol("key2")] = pmt_t::make_int(1234);
+        d[pmt_t::make_symbol("key1")] = pmt_t::make_vector({pmt_t::make_int(42), pmt_t::make_bool(true), nullptr});
+        d[pmt_t::make_symbol("span")] = pmt_t::make_pair(pmt_t::make_int(-1), pmt_t::make_symbol("end"));
+        auto obj = pmt_t::make_dict(d);
+
+        std::string out;
+        legacy_pmt::format_to(out, obj);
+        EXPECT_EQ(out, R"({"key1": [42 true <null> ], "key2": 1234, "span": (-1 . "end"), })");
+
+        // Same text straight from the encoding
+        EXPECT_EQ(dump(legacy_pmt::serialize_legacy_pmt(obj)), out);
+    }
+
+    TEST(LegacyTextTest, Pmtv) {
+        pmtv::pmt obj = pmtv::map_t({{"freq", 2.4e9},
+                                     {"label", "example"},
+                                     {"iq", pmtv::Tensor<std::complex<float>>({{0.5f, -1.0f}, {2.0f, 0.25f}})},
+                                     {"rx_time", static_cast<int64_t>(249387429783478)}});
+        std::string out;
+        legacy_pmt::format_to(out, obj);
+        EXPECT_EQ(out, R"({"freq": 2.4e+09, "iq": [0.5-1j 2+0.25j ], "label": "example", "rx_time": 249387429783478, })");
+        EXPECT_EQ(dump(legacy_pmt::serialize_to_legacy(obj)), out);
+    }
+
+    TEST(LegacyTextTest, Truncation) {
+        legacy_pmt::format_options opts;
+        opts.max_elements = 4;
+
+        pmtv::pmt samples = pmtv::Tensor<float>(std::vector<float>(100000, 1.5f));
+        std::string out;
+        legacy_pmt::format_to(out, samples, opts);
+        EXPECT_EQ(out, "[1.5 1.5 1.5 1.5 ... (+99996) ]");
+        EXPECT_EQ(dump(legacy_pmt::serialize_to_legacy(samples), opts), out);
+
+        opts.max_depth = 2;
+        auto nested = pmt_t::make_vector({pmt_t::make_vector({pmt_t::make_vector({pmt_t::make_int(1)})}),
+                                          pmt_t::make_int(2)});
+        out.clear();
+        legacy_pmt::format_to(out, nested, opts);
+        EXPECT_EQ(out, "[[[...] ] 2 ]");
+        EXPECT_EQ(dump(legacy_pmt::serialize_legacy_pmt(nested), opts), out);
+    }
+
+    TEST(LegacyTextTest, Malformed) {
+        auto bytes = legacy_pmt::serialize_legacy_pmt(pmt_t::make_vector({pmt_t::make_int(1), pmt_t::make_int(2)}));
+        std::string out;
+        EXPECT_FALSE(legacy_pmt::format_legacy_to(out, bytes.data(), bytes.size() - 2, {}));
+        EXPECT_EQ(out, "[1 <malformed at offset 11>");
+
+        const uint8_t unknown = 0x42;
+        out.clear();
+        EXPECT_FALSE(legacy_pmt::format_legacy_to(out, &unknown, 1, {}));
+        EXPECT_EQ(out, "<malformed at offset 0>");
+
+        // Nesting below max_depth is only skipped, but is still bounded
+        std::vector<uint8_t> deep;
+        for (int i = 0; i < 1000000; ++i)
+            deep.insert(deep.end(), {0x07, 0x07});
+        deep.push_back(0x06);
+        out.clear();
+        EXPECT_FALSE(legacy_pmt::format_legacy_to(out, deep.data(), deep.size(), {}));
+        EXPECT_EQ(out, "((((((((" "(...)<malformed at offset 1025>");
+
+        // A long list skips along its cdrs without a depth limit
+        std::vector<uint8_t> list;
+        for (int i = 0; i < 1000000; ++i)
+            list.insert(list.end(), {0x07, 0x00});
+        list.push_back(0x06);
+        legacy_pmt::format_options shallow;
+        shallow.max_depth = 2;
+        EXPECT_EQ(dump(list, shallow), "(true . (true . (...)))");
+    }
+
+}
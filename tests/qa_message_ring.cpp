@@ -0,0 +1,105 @@
+#include <gtest/gtest.h>
+#include <pmt_converter/pmt_message_ring.h>
+#include <pmt_converter/pmt_legacy_codec.h>
+#include <cstring>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+#include <unistd.h>
+
+namespace {
+
+    TEST(MessageRingTest, PushPop) {
+        auto ring = legacy_pmt::message_ring::create(4096);
+        EXPECT_FALSE(ring.try_pop().has_value());
+
+        EXPECT_TRUE(ring.try_push(pmtv::pmt(42)));
+        EXPECT_TRUE(ring.try_push(pmtv::pmt("example")));
+        EXPECT_TRUE(ring.try_push(pmtv::pmt(pmtv::Tensor<float>(4, -987.654321))));
+
+        EXPECT_EQ(pmtv::cast<int32_t>(*ring.try_pop()), 42);
+        EXPECT_EQ(pmtv::cast<std::string>(*ring.try_pop()), "example");
+        std::vector<float> expected_f32_vector(4, -987.654321);
+        EXPECT_EQ(pmtv::cast<std::vector<float>>(*ring.try_pop()), expected_f32_vector);
+        EXPECT_FALSE(ring.try_pop().has_value());
+    }
+
+    TEST(MessageRingTest, PeekInPlace) {
+        auto ring = legacy_pmt::message_ring::create(4096);
+        pmtv::pmt obj = pmtv::Tensor<uint8_t>(4, 222);
+        ASSERT_TRUE(ring.try_push(obj));
+
+        auto view = ring.try_peek();
+        std::vector<uint8_t> bytes(view.begin(), view.end());
+        EXPECT_EQ(bytes, legacy_pmt::serialize_to_legacy(obj));
+        ring.release();
+        EXPECT_TRUE(ring.try_peek().empty());
+    }
+
+    TEST(MessageRingTest, FullAndWrapAround) {
+        auto ring = legacy_pmt::message_ring::create(256);
+        std::vector<uint8_t> msg(40, 0x06);
+
+        int pushed = 0;
+        while (ring.try_push(msg.data(), msg.size()))
+            ++pushed;
+        EXPECT_GT(pushed, 0);
+
+        // Drain and refill repeatedly so records straddle the end of the ring
+        for (int round = 0; round < 20; ++round) {
+            auto view = ring.try_peek();
+            ASSERT_EQ(view.size(), msg.size());
+            ring.release();
+            EXPECT_TRUE(ring.try_push(msg.data(), msg.size()));
+        }
+        EXPECT_THROW(ring.try_push(std::vector<uint8_t>(200).data(), 200), std::length_error);
+    }
+
+    TEST(MessageRingTest, ProducerConsumerThreads) {
+        auto ring = legacy_pmt::message_ring::create(1 << 12);
+        constexpr int32_t count = 100000;
+
+        std::thread producer([&] {
+            for (int32_t i = 0; i < count; ++i) {
+                while (!ring.try_push(pmtv::pmt(i)))
+                    std::this_thread::yield();
+            }
+        });
+
+        for (int32_t i = 0; i < count; ++i) {
+            std::optional<pmtv::pmt> obj;
+            while (!(obj = ring.try_pop()))
+                std::this_thread::yield();
+            ASSERT_EQ(pmtv::cast<int32_t>(*obj), i);
+        }
+        producer.join();
+    }
+
+    // A producer that scribbles over a record length must not make the
+    // consumer read outside the mapping
+    TEST(MessageRingTest, RejectsCorruptRecord) {
+        for (uint32_t len : {0x7FFFFFFFu, 64u, 0u}) {
+            auto ring = legacy_pmt::message_ring::create(256);
+            uint8_t* out = ring.try_reserve(8);
+            ASSERT_NE(out, nullptr);
+            std::memset(out, 0x06, 8);
+            ring.commit();
+            std::memcpy(out - sizeof(uint32_t), &len, sizeof(uint32_t));
+            EXPECT_THROW(ring.try_peek(), std::runtime_error) << len;
+        }
+    }
+
+    TEST(MessageRingTest, SharedMapping) {
+        const std::string name = "/qa_message_ring_" + std::to_string(::getpid());
+        auto producer = legacy_pmt::message_ring::create_shared(name, 4096);
+        auto consumer = legacy_pmt::message_ring::open_shared(name);
+        legacy_pmt::message_ring::unlink_shared(name);
+
+        auto via_fd = legacy_pmt::message_ring::from_fd(producer.fd());
+        EXPECT_EQ(via_fd.capacity(), producer.capacity());
+
+        ASSERT_TRUE(producer.try_push(pmtv::pmt(249387429783478)));
+        EXPECT_EQ(pmtv::cast<int64_t>(*consumer.try_pop()), 249387429783478);
+    }
+
+}
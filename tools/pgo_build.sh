@@ -0,0 +1,28 @@
+#!/bin/sh
+# Profile-guided release build of pmt_converter.
+#
+#   tools/pgo_build.sh [builddir] [capture files...]
+#
+# Configures an instrumented LTO build, runs pmt_pgo_train on its built-in
+# message corpus (plus any legacy capture files given), then rebuilds
+# everything with the collected profile.
+set -e
+
+src=$(cd "$(dirname "$0")/.." && pwd)
+build=${1:-build-pgo}
+[ $# -gt 0 ] && shift
+
+if [ -d "$build" ]; then
+    meson configure "$build" -Db_pgo=generate
+else
+    meson setup "$build" "$src" --native-file "$src/tools/release.ini" -Db_pgo=generate
+fi
+
+# Stale profiles from an earlier run would be merged into this one
+find "$build" -name '*.gcda' -delete
+
+meson compile -C "$build" pmt_pgo_train
+"$build/pmt_pgo_train" "$@"
+
+meson configure "$build" -Db_pgo=use
+meson compile -C "$build"
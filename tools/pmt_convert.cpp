@@ -0,0 +1,363 @@
+#include <pmt_converter/pmt_legacy_codec.h>
+#include <pmtv/pmt.hpp>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <future>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <thread>
+#include <vector>
+
+// Bulk converter between legacy PMT captures (back-to-back serialize_to_legacy
+// messages, as written by GR3 message file sinks) and pmtv::serialize streams.
+//
+//   pmt_convert [--to-pmtv | --to-legacy] [-j threads] [--batch-mb N] <input> <output>
+//
+// The input is memory mapped and converted in batches: message boundaries of a
+// batch are found first, then its messages are converted by all threads in
+// parallel while the previous batch is being written out.
+
+namespace {
+
+    enum class direction { to_pmtv, to_legacy };
+
+    struct options {
+        direction dir = direction::to_pmtv;
+        unsigned threads = std::max(1u, std::thread::hardware_concurrency());
+        size_t batch_bytes = size_t{64} << 20;
+        std::string input;
+        std::string output;
+    };
+
+    [[noreturn]] void usage(const char* argv0) {
+        std::fprintf(stderr,
+                     "usage: %s [--to-pmtv | --to-legacy] [-j threads] [--batch-mb N] <input> <output>\n"
+                     "  --to-pmtv    legacy capture to pmtv::serialize stream (default)\n"
+                     "  --to-legacy  pmtv::serialize stream to legacy capture\n"
+                     "  -j           worker threads (default: all hardware threads)\n"
+                     "  --batch-mb   input consumed per batch in MiB (default: 64)\n",
+                     argv0);
+        std::exit(2);
+    }
+
+    options parse_args(int argc, char** argv) {
+        options opts;
+        std::vector<std::string> positional;
+        for (int i = 1; i < argc; ++i) {
+            std::string arg = argv[i];
+            if (arg == "--to-pmtv") {
+                opts.dir = direction::to_pmtv;
+            } else if (arg == "--to-legacy") {
+                opts.dir = direction::to_legacy;
+            } else if (arg == "-j" && i + 1 < argc) {
+                opts.threads = std::max(1, std::atoi(argv[++i]));
+            } else if (arg == "--batch-mb" && i + 1 < argc) {
+                opts.batch_bytes = static_cast<size_t>(std::max(1, std::atoi(argv[++i]))) << 20;
+            } else if (arg.starts_with("-")) {
+                usage(argv[0]);
+            } else {
+                positional.push_back(arg);
+            }
+        }
+        if (positional.size() != 2)
+            usage(argv[0]);
+        opts.input = positional[0];
+        opts.output = positional[1];
+        return opts;
+    }
+
+    class mapped_file {
+    public:
+        explicit mapped_file(const std::string& path) {
+            _fd = ::open(path.c_str(), O_RDONLY);
+            if (_fd < 0)
+                throw std::system_error(errno, std::generic_category(), "open " + path);
+            struct stat st;
+            if (::fstat(_fd, &st) < 0)
+                throw std::system_error(errno, std::generic_category(), "stat " + path);
+            _size = static_cast<size_t>(st.st_size);
+            if (_size == 0)
+                return;
+            void* p = ::mmap(nullptr, _size, PROT_READ, MAP_PRIVATE, _fd, 0);
+            if (p == MAP_FAILED)
+                throw std::system_error(errno, std::generic_category(), "mmap " + path);
+            _data = static_cast<const uint8_t*>(p);
+            ::madvise(p, _size, MADV_SEQUENTIAL);
+        }
+
+        ~mapped_file() {
+            if (_data)
+                ::munmap(const_cast<uint8_t*>(_data), _size);
+            if (_fd >= 0)
+                ::close(_fd);
+        }
+
+        mapped_file(const mapped_file&) = delete;
+        mapped_file& operator=(const mapped_file&) = delete;
+
+        const uint8_t* data() const { return _data; }
+        size_t size() const { return _size; }
+
+        // Drop pages of an already converted prefix, so RSS stays at about
+        // one batch however large the capture is
+        void release_prefix(size_t end) {
+            size_t page = static_cast<size_t>(::sysconf(_SC_PAGESIZE));
+            size_t len = end / page * page;
+            if (_data && len > _released) {
+                ::madvise(const_cast<uint8_t*>(_data) + _released, len - _released, MADV_DONTNEED);
+                _released = len;
+            }
+        }
+
+    private:
+        int _fd = -1;
+        const uint8_t* _data = nullptr;
+        size_t _size = 0;
+        size_t _released = 0;
+    };
+
+    class output_file {
+    public:
+        explicit output_file(const std::string& path) {
+            _fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+            if (_fd < 0)
+                throw std::system_error(errno, std::generic_category(), "open " + path);
+        }
+
+        ~output_file() {
+            if (_fd >= 0)
+                ::close(_fd);
+        }
+
+        output_file(const output_file&) = delete;
+        output_file& operator=(const output_file&) = delete;
+
+        void write(const char* data, size_t size) {
+            while (size > 0) {
+                ssize_t n = ::write(_fd, data, size);
+                if (n < 0) {
+                    if (errno == EINTR)
+                        continue;
+                    throw std::system_error(errno, std::generic_category(), "write");
+                }
+                data += n;
+                size -= static_cast<size_t>(n);
+                _written += static_cast<size_t>(n);
+            }
+        }
+
+        size_t written() const { return _written; }
+
+    private:
+        int _fd = -1;
+        size_t _written = 0;
+    };
+
+    // Reads a pmtv stream straight out of the mapping
+    class memory_buf : public std::streambuf {
+    public:
+        memory_buf(const uint8_t* data, size_t size) {
+            char* p = reinterpret_cast<char*>(const_cast<uint8_t*>(data));
+            setg(p, p, p + size);
+        }
+
+        size_t position() const { return static_cast<size_t>(gptr() - eback()); }
+    };
+
+    // Output of one chunk of a batch; chunks are written in order
+    struct chunk_result {
+        std::string bytes;
+        std::string error;
+    };
+
+    using batch_results = std::vector<chunk_result>;
+
+    // Run fn(chunk) for every chunk on up to `threads` threads, the caller included
+    template <typename Fn>
+    void run_chunks(size_t num_chunks, unsigned threads, const Fn& fn) {
+        std::atomic<size_t> next{0};
+        auto worker = [&] {
+            for (size_t c; (c = next.fetch_add(1, std::memory_order_relaxed)) < num_chunks;)
+                fn(c);
+        };
+        std::vector<std::jthread> pool;
+        for (size_t t = 1; t < std::min<size_t>(threads, num_chunks); ++t)
+            pool.emplace_back(worker);
+        worker();
+    }
+
+    // Writes batches on a background thread, overlapping with the next batch's conversion
+    class batch_writer {
+    public:
+        explicit batch_writer(output_file& out) : _out(out) {}
+        ~batch_writer() {
+            if (_pending.valid())
+                _pending.wait();
+        }
+
+        void write(std::shared_ptr<batch_results> results) {
+            flush();
+            _pending = std::async(std::launch::async, [this, results = std::move(results)] {
+                for (const auto& r : *results)
+                    _out.write(r.bytes.data(), r.bytes.size());
+            });
+        }
+
+        void flush() {
+            if (_pending.valid())
+                _pending.get();
+        }
+
+    private:
+        output_file& _out;
+        std::future<void> _pending;
+    };
+
+    void check_errors(const batch_results& results) {
+        for (const auto& r : results) {
+            if (!r.error.empty())
+                throw std::runtime_error(r.error);
+        }
+    }
+
+    std::string message_error(size_t index, size_t offset, const char* what) {
+        return "message " + std::to_string(index) + " at input offset " + std::to_string(offset) + ": " + what;
+    }
+
+    size_t legacy_to_pmtv(mapped_file& in, output_file& out, const options& opts) {
+        const uint8_t* data = in.data();
+        size_t pos = 0;
+        size_t total = 0;
+        batch_writer writer(out);
+
+        while (pos < in.size()) {
+            // Message boundaries of this batch
+            struct span {
+                size_t offset;
+                size_t size;
+            };
+            std::vector<span> msgs;
+            size_t batch_end = std::min(in.size(), pos + opts.batch_bytes);
+            while (pos < batch_end) {
+                try {
+                    size_t n = legacy_pmt::legacy_encoded_size(data + pos, in.size() - pos);
+                    msgs.push_back({pos, n});
+                    pos += n;
+                } catch (const std::exception& e) {
+                    throw std::runtime_error(message_error(total + msgs.size(), pos, e.what()));
+                }
+            }
+
+            size_t num_chunks = std::min<size_t>(msgs.size(), size_t{opts.threads} * 4);
+            auto results = std::make_shared<batch_results>(num_chunks);
+            run_chunks(num_chunks, opts.threads, [&](size_t c) {
+                size_t first = c * msgs.size() / num_chunks;
+                size_t last = (c + 1) * msgs.size() / num_chunks;
+                std::stringbuf sb;
+                for (size_t i = first; i < last; ++i) {
+                    try {
+                        pmtv::serialize(sb, legacy_pmt::deserialize_from_legacy(data + msgs[i].offset, msgs[i].size));
+                    } catch (const std::exception& e) {
+                        (*results)[c].error = message_error(total + i, msgs[i].offset, e.what());
+                        return;
+                    }
+                }
+                (*results)[c].bytes = std::move(sb).str();
+            });
+            check_errors(*results);
+
+            writer.write(std::move(results));
+            in.release_prefix(pos);
+            total += msgs.size();
+        }
+        writer.flush();
+        return total;
+    }
+
+    size_t pmtv_to_legacy(mapped_file& in, output_file& out, const options& opts) {
+        memory_buf buf(in.data(), in.size());
+        size_t total = 0;
+        batch_writer writer(out);
+
+        // pmtv streams carry no outer framing, so the batch is decoded on this
+        // thread and only the legacy encoding is spread across workers
+        while (buf.position() < in.size()) {
+            std::vector<pmtv::pmt> objs;
+            size_t batch_end = std::min(in.size(), buf.position() + opts.batch_bytes);
+            while (buf.position() < batch_end) {
+                size_t offset = buf.position();
+                try {
+                    objs.push_back(pmtv::deserialize(buf));
+                } catch (const std::exception& e) {
+                    throw std::runtime_error(message_error(total + objs.size(), offset, e.what()));
+                }
+                if (buf.position() == offset)
+                    throw std::runtime_error(message_error(total + objs.size(), offset, "no progress decoding pmtv stream"));
+            }
+
+            size_t num_chunks = std::min<size_t>(objs.size(), size_t{opts.threads} * 4);
+            auto results = std::make_shared<batch_results>(num_chunks);
+            run_chunks(num_chunks, opts.threads, [&](size_t c) {
+                size_t first = c * objs.size() / num_chunks;
+                size_t last = (c + 1) * objs.size() / num_chunks;
+                auto& r = (*results)[c];
+                try {
+                    size_t bytes = 0;
+                    for (size_t i = first; i < last; ++i)
+                        bytes += legacy_pmt::legacy_serialized_size(objs[i]);
+                    r.bytes.resize(bytes);
+                    auto* ptr = reinterpret_cast<uint8_t*>(r.bytes.data());
+                    for (size_t i = first; i < last; ++i)
+                        ptr += legacy_pmt::serialize_to_legacy(objs[i], ptr, bytes - (ptr - reinterpret_cast<uint8_t*>(r.bytes.data())));
+                } catch (const std::exception& e) {
+                    r.error = "message in batch starting at " + std::to_string(total + first) + ": " + e.what();
+                }
+            });
+            check_errors(*results);
+
+            writer.write(std::move(results));
+            in.release_prefix(buf.position());
+            total += objs.size();
+        }
+        writer.flush();
+        return total;
+    }
+
+} // namespace
+
+int main(int argc, char** argv) {
+    options opts = parse_args(argc, argv);
+
+    try {
+        mapped_file in(opts.input);
+        output_file out(opts.output);
+
+        auto start = std::chrono::steady_clock::now();
+        size_t messages = opts.dir == direction::to_pmtv ? legacy_to_pmtv(in, out, opts) : pmtv_to_legacy(in, out, opts);
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        seconds = std::max(seconds, 1e-9);
+
+        double in_mb = static_cast<double>(in.size()) / 1e6;
+        std::fprintf(stderr, "%zu messages, %.1f MB in, %.1f MB out in %.3f s: %.0f msgs/s, %.1f MB/s\n", messages,
+                     in_mb, static_cast<double>(out.written()) / 1e6, seconds, static_cast<double>(messages) / seconds,
+                     in_mb / seconds);
+    } catch (const std::exception& e) {
+        std::fprintf(stderr, "pmt_convert: %s\n", e.what());
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,142 @@
+#include <pmt_converter/legacy/pmt_legacy_serialize.h>
+#include <pmt_converter/pmt_legacy_codec.h>
+#include <pmt_converter/pmt_legacy_framed.h>
+#include <pmt_converter/pmt_legacy_text.h>
+
+#include <complex>
+#include <cstdint>
+#include <cstdio>
+#include <exception>
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+// Training workload for profile-guided builds (see tools/pgo_build.sh).
+//
+//   pmt_pgo_train [capture files...]
+//
+// Encodes and decodes a fixed corpus shaped like typical flowgraph message
+// traffic: mostly small stream-tag dicts and scalars, with a share of sample
+// bursts of the common dtypes. Legacy capture files given on the command
+// line are split and replayed as well, to bias the profile to real traffic.
+
+namespace {
+
+    // Fixed-seed generator so every training run sees the same corpus
+    struct lcg {
+        uint64_t state = 0x2545F4914F6CDD1DULL;
+        uint32_t next() {
+            state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+            return static_cast<uint32_t>(state >> 33);
+        }
+    };
+
+    template <typename T>
+    pmtv::pmt make_burst(lcg& rng, size_t n) {
+        std::vector<T> v(n);
+        for (auto& x : v) {
+            if constexpr (std::is_same_v<T, std::complex<float>>)
+                x = {static_cast<float>(rng.next() % 2000) - 1000.0f, static_cast<float>(rng.next() % 2000) - 1000.0f};
+            else
+                x = static_cast<T>(rng.next());
+        }
+        return pmtv::Tensor<T>(std::move(v));
+    }
+
+    pmtv::pmt make_message(lcg& rng, uint64_t seq) {
+        switch (rng.next() % 10) {
+            case 0:
+            case 1:
+            case 2:
+            case 3:
+                return pmtv::map_t({{"rx_time", static_cast<int64_t>(seq * 1000003)},
+                                    {"rx_rate", 2.4e6},
+                                    {"rx_freq", 915e6 + static_cast<double>(rng.next() % 1000)}});
+            case 4:
+                return pmtv::map_t({{"packet_len", static_cast<int32_t>(rng.next() % 1500)},
+                                    {"snr", static_cast<double>(rng.next() % 400) / 10.0},
+                                    {"label", "burst_start"},
+                                    {"valid", rng.next() % 2 == 0}});
+            case 5:
+                return static_cast<int64_t>(seq);
+            case 6:
+                return "key_" + std::to_string(rng.next() % 64);
+            case 7:
+                return make_burst<std::complex<float>>(rng, 256 << (rng.next() % 6));
+            case 8:
+                return make_burst<float>(rng, 512 << (rng.next() % 4));
+            default:
+                return rng.next() % 2 ? make_burst<int16_t>(rng, 1024) : make_burst<uint8_t>(rng, 1500);
+        }
+    }
+
+    std::vector<std::vector<uint8_t>> build_corpus(size_t count) {
+        lcg rng;
+        std::vector<std::vector<uint8_t>> corpus;
+        corpus.reserve(count);
+        for (size_t i = 0; i < count; ++i)
+            corpus.push_back(legacy_pmt::serialize_to_legacy(make_message(rng, i)));
+        return corpus;
+    }
+
+    std::vector<std::vector<uint8_t>> load_capture(const char* path) {
+        std::ifstream in(path, std::ios::binary);
+        if (!in)
+            throw std::runtime_error(std::string("cannot open ") + path);
+        std::vector<uint8_t> bytes((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+
+        std::vector<std::vector<uint8_t>> msgs;
+        for (size_t pos = 0; pos < bytes.size();) {
+            size_t n = legacy_pmt::legacy_encoded_size(bytes.data() + pos, bytes.size() - pos);
+            msgs.emplace_back(bytes.begin() + pos, bytes.begin() + pos + n);
+            pos += n;
+        }
+        return msgs;
+    }
+
+    void train(const std::vector<std::vector<uint8_t>>& corpus, int rounds) {
+        std::vector<uint8_t> out;
+        std::string text;
+        size_t checksum = 0;
+
+        for (int round = 0; round < rounds; ++round) {
+            for (const auto& msg : corpus) {
+                checksum += legacy_pmt::legacy_encoded_size(msg.data(), msg.size());
+                pmtv::pmt obj = legacy_pmt::deserialize_from_legacy(msg.data(), msg.size());
+
+                out.resize(legacy_pmt::legacy_serialized_size(obj));
+                checksum += legacy_pmt::serialize_to_legacy(obj, out.data(), out.size());
+
+                auto frame = legacy_pmt::serialize_framed(obj);
+                legacy_pmt::deserialize_framed(frame.data(), frame.size());
+
+                // Native legacy::pmt_t path only covers what that model can hold
+                try {
+                    auto native = legacy_pmt::deserialize_legacy_pmt(msg.data(), msg.size());
+                    checksum += legacy_pmt::serialize_legacy_pmt(native).size();
+                } catch (const std::runtime_error&) {
+                }
+
+                text.clear();
+                legacy_pmt::format_legacy_to(text, msg.data(), msg.size());
+                checksum += text.size();
+            }
+        }
+        std::printf("trained on %zu messages x %d rounds (checksum %zu)\n", corpus.size(), rounds, checksum);
+    }
+
+} // namespace
+
+int main(int argc, char** argv) {
+    try {
+        train(build_corpus(20000), 5);
+        for (int i = 1; i < argc; ++i)
+            train(load_capture(argv[i]), 1);
+    } catch (const std::exception& e) {
+        std::fprintf(stderr, "pmt_pgo_train: %s\n", e.what());
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,233 @@
+#include <pmt_converter/pmt_legacy_codec.h>
+#include <pmt_converter/pmt_legacy_corpus.h>
+#include <pmt_converter/pmt_legacy_pdu.h>
+#include <pmtv/pmt.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <exception>
+#include <fstream>
+#include <iterator>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Throughput replay harness for the legacy codec.
+//
+//   pmt_replay [--seed N] [--messages N] [--mix W,W,W,W,W] [--rate msgs/s]
+//              [--rounds N] [--write <capture>] [capture files...]
+//
+// Replays a deterministic corpus (see pmt_legacy_corpus.h) or the given legacy
+// captures through decode and re-encode, and reports per-message latency
+// percentiles and sustained throughput per message kind. PDUs take the PDU
+// codec (pmt_legacy_pdu.h), everything else the generic one. With --rate the
+// messages are released on a fixed schedule and latency is measured from the
+// scheduled release, so a stall shows up in the tail of every message queued
+// behind it instead of being hidden. --write stores the generated corpus as a
+// capture for pmt_convert, pmt_pgo_train or another host, then exits.
+
+namespace {
+
+    using clock_type = std::chrono::steady_clock;
+
+    struct options {
+        legacy_pmt::corpus_options corpus;
+        double rate = 0; // messages per second, 0 for back-to-back
+        int rounds = 1;
+        std::string write_path;
+        std::vector<std::string> captures;
+    };
+
+    [[noreturn]] void usage(const char* argv0) {
+        std::fprintf(stderr,
+                     "usage: %s [--seed N] [--messages N] [--mix W,W,W,W,W] [--rate msgs/s] [--rounds N]\n"
+                     "          [--write <capture>] [capture files...]\n"
+                     "  --seed      corpus seed (default: 1)\n"
+                     "  --messages  corpus size (default: 10000)\n"
+                     "  --mix       weights of tag_dict,pdu_u8,pdu_c32,c32_burst,nested_dict (default: 60,15,10,10,5)\n"
+                     "  --rate      target rate in messages/s (default: 0, back-to-back)\n"
+                     "  --rounds    passes over the corpus (default: 1)\n"
+                     "  --write     store the generated corpus as a legacy capture and exit\n",
+                     argv0);
+        std::exit(2);
+    }
+
+    options parse_args(int argc, char** argv) {
+        options opts;
+        for (int i = 1; i < argc; ++i) {
+            std::string arg = argv[i];
+            bool has_value = i + 1 < argc;
+            if (arg == "--seed" && has_value) {
+                opts.corpus.seed = std::strtoull(argv[++i], nullptr, 0);
+            } else if (arg == "--messages" && has_value) {
+                opts.corpus.messages = std::strtoull(argv[++i], nullptr, 0);
+            } else if (arg == "--mix" && has_value) {
+                std::istringstream in(argv[++i]);
+                std::string w;
+                for (auto& weight : opts.corpus.weights) {
+                    if (!std::getline(in, w, ','))
+                        usage(argv[0]);
+                    weight = static_cast<uint32_t>(std::strtoul(w.c_str(), nullptr, 10));
+                }
+            } else if (arg == "--rate" && has_value) {
+                opts.rate = std::max(0.0, std::atof(argv[++i]));
+            } else if (arg == "--rounds" && has_value) {
+                opts.rounds = std::max(1, std::atoi(argv[++i]));
+            } else if (arg == "--write" && has_value) {
+                opts.write_path = argv[++i];
+            } else if (arg.starts_with("-")) {
+                usage(argv[0]);
+            } else {
+                opts.captures.push_back(arg);
+            }
+        }
+        return opts;
+    }
+
+    struct message {
+        size_t row;
+        std::vector<uint8_t> bytes;
+    };
+
+    struct row_stats {
+        std::string name;
+        size_t bytes = 0;
+        size_t unsupported = 0;
+        std::vector<uint64_t> latency_ns;
+    };
+
+    void load_capture(const std::string& path, size_t row, std::vector<message>& msgs) {
+        std::ifstream in(path, std::ios::binary);
+        if (!in)
+            throw std::runtime_error("cannot open " + path);
+        std::vector<uint8_t> bytes((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+        for (size_t pos = 0; pos < bytes.size();) {
+            size_t n = legacy_pmt::legacy_encoded_size(bytes.data() + pos, bytes.size() - pos);
+            msgs.push_back({row, {bytes.begin() + pos, bytes.begin() + pos + n}});
+            pos += n;
+        }
+    }
+
+    // Nearest-rank percentile of sorted samples
+    double percentile_us(const std::vector<uint64_t>& sorted, double p) {
+        if (sorted.empty())
+            return 0;
+        size_t rank = static_cast<size_t>(p * static_cast<double>(sorted.size()) + 0.999999);
+        return static_cast<double>(sorted[std::clamp<size_t>(rank, 1, sorted.size()) - 1]) / 1e3;
+    }
+
+    void replay(const std::vector<message>& msgs, std::vector<row_stats>& rows, const options& opts) {
+        // One sample per round for each message of the row
+        std::vector<size_t> per_row(rows.size());
+        for (const auto& msg : msgs)
+            ++per_row[msg.row];
+        for (size_t r = 0; r < rows.size(); ++r)
+            rows[r].latency_ns.reserve(static_cast<size_t>(opts.rounds) * per_row[r]);
+
+        std::vector<uint8_t> out;
+        legacy_pmt::pdu_encoder pdus;
+        const auto period = opts.rate > 0 ? std::chrono::duration<double>(1.0 / opts.rate)
+                                          : std::chrono::duration<double>(0);
+        constexpr auto spin_window = std::chrono::microseconds(200);
+        const auto start = clock_type::now();
+        size_t sent = 0;
+
+        for (int round = 0; round < opts.rounds; ++round) {
+            for (const auto& msg : msgs) {
+                auto release = clock_type::now();
+                if (opts.rate > 0) {
+                    release = start + std::chrono::duration_cast<clock_type::duration>(period * sent);
+                    // Sleeping overshoots by tens of microseconds; spin the last stretch
+                    if (release - clock_type::now() > spin_window)
+                        std::this_thread::sleep_until(release - spin_window);
+                    while (clock_type::now() < release) {
+                    }
+                }
+                ++sent;
+
+                row_stats& row = rows[msg.row];
+                try {
+                    if (legacy_pmt::is_legacy_pdu(msg.bytes.data(), msg.bytes.size())) {
+                        auto [meta, payload] = legacy_pmt::deserialize_pdu(msg.bytes.data(), msg.bytes.size());
+                        pdus.encode(meta, payload);
+                    } else {
+                        pmtv::pmt obj = legacy_pmt::deserialize_from_legacy(msg.bytes.data(), msg.bytes.size());
+                        out.resize(legacy_pmt::legacy_serialized_size(obj));
+                        legacy_pmt::serialize_to_legacy(obj, out.data(), out.size());
+                    }
+                } catch (const std::runtime_error&) {
+                    ++row.unsupported;
+                    continue;
+                }
+                auto done = clock_type::now();
+                row.latency_ns.push_back(
+                    static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(done - release).count()));
+                row.bytes += msg.bytes.size();
+            }
+        }
+        const double elapsed = std::chrono::duration<double>(clock_type::now() - start).count();
+
+        std::printf("%-12s %9s %11s %9s %9s %9s %10s\n", "kind", "messages", "unsupported", "p50 us", "p99 us",
+                    "p999 us", "MB");
+        row_stats total{"total"};
+        for (auto& row : rows) {
+            std::sort(row.latency_ns.begin(), row.latency_ns.end());
+            std::printf("%-12s %9zu %11zu %9.2f %9.2f %9.2f %10.2f\n", row.name.c_str(), row.latency_ns.size(),
+                        row.unsupported, percentile_us(row.latency_ns, 0.5), percentile_us(row.latency_ns, 0.99),
+                        percentile_us(row.latency_ns, 0.999), static_cast<double>(row.bytes) / 1e6);
+            total.latency_ns.insert(total.latency_ns.end(), row.latency_ns.begin(), row.latency_ns.end());
+            total.unsupported += row.unsupported;
+            total.bytes += row.bytes;
+        }
+        std::sort(total.latency_ns.begin(), total.latency_ns.end());
+        std::printf("%-12s %9zu %11zu %9.2f %9.2f %9.2f %10.2f\n", total.name.c_str(), total.latency_ns.size(),
+                    total.unsupported, percentile_us(total.latency_ns, 0.5), percentile_us(total.latency_ns, 0.99),
+                    percentile_us(total.latency_ns, 0.999), static_cast<double>(total.bytes) / 1e6);
+
+        std::printf("sustained %.0f msgs/s, %.1f MB/s over %.3f s", static_cast<double>(total.latency_ns.size()) / elapsed,
+                    static_cast<double>(total.bytes) / 1e6 / elapsed, elapsed);
+        if (opts.rate > 0)
+            std::printf(" (target %.0f msgs/s)", opts.rate);
+        std::printf("\n");
+    }
+
+} // namespace
+
+int main(int argc, char** argv) {
+    options opts = parse_args(argc, argv);
+    try {
+        std::vector<message> msgs;
+        std::vector<row_stats> rows;
+        if (opts.captures.empty()) {
+            for (size_t k = 0; k < legacy_pmt::corpus_kind_count; ++k)
+                rows.push_back({legacy_pmt::corpus_kind_name(static_cast<legacy_pmt::corpus_kind>(k))});
+            for (auto& m : legacy_pmt::generate_legacy_corpus(opts.corpus))
+                msgs.push_back({static_cast<size_t>(m.kind), std::move(m.bytes)});
+        } else {
+            rows.push_back({"capture"});
+            for (const auto& path : opts.captures)
+                load_capture(path, 0, msgs);
+        }
+
+        if (!opts.write_path.empty()) {
+            std::ofstream out(opts.write_path, std::ios::binary);
+            for (const auto& msg : msgs)
+                out.write(reinterpret_cast<const char*>(msg.bytes.data()), static_cast<std::streamsize>(msg.bytes.size()));
+            if (!out)
+                throw std::runtime_error("cannot write " + opts.write_path);
+            std::printf("wrote %zu messages to %s\n", msgs.size(), opts.write_path.c_str());
+            return 0;
+        }
+
+        replay(msgs, rows, opts);
+    } catch (const std::exception& e) {
+        std::fprintf(stderr, "pmt_replay: %s\n", e.what());
+        return 1;
+    }
+    return 0;
+}